@@ -1,12 +1,19 @@
 #include "application.hpp"
 
-Application::Application()
-    : keep_running(true),
-      window{std::make_unique<Window>(1920, 1080, "Fairy Forest")},
-      context{std::make_shared<Context>(window->get_handle())},
+Application::Application(ApplicationInfo const & info)
+    : info{info},
+      keep_running(true),
+      window{info.headless ? nullptr : std::make_unique<Window>(1920, 1080, "Fairy Forest")},
+      context{info.headless ? std::make_shared<Context>(info.headless_extent) : std::make_shared<Context>(window->get_handle())},
       renderer{std::make_unique<ff::Renderer>(context)},
       scene{std::make_unique<Scene>(context->device)},
-      asset_processor{std::make_unique<AssetProcessor>(context->device)}
+      asset_processor{std::make_unique<AssetProcessor>(context->device)},
+      texture_streamer{info.texture_streaming
+                           ? std::make_unique<TextureStreamer>(context->device, TextureStreamerInfo{
+                                 .vram_budget = static_cast<usize>(info.texture_budget_mib) * 1024ull * 1024ull,
+                                 .mip_bias = renderer->get_material_lod_bias(),
+                             })
+                           : nullptr}
 
 {
     std::vector<AnimationKeyframe> keyframes = {
@@ -195,7 +202,7 @@ Application::Application()
             .end_position = {-10.737522, 6.5435715, 3.3999836},
             .transition_time = 5.0f},
     };
-    camera = CinematicCamera(keyframes, *window);
+    camera = CinematicCamera(keyframes);
     std::filesystem::path const DEFAULT_ROOT_PATH = ".\\assets";
     // std::filesystem::path const DEFAULT_SCENE_PATH = "forest\\forest.gltf";
     // std::filesystem::path const DEFAULT_SCENE_PATH = "forest_leaves_twofaced\\forest_leaves_twofaced.gltf";
@@ -205,28 +212,59 @@ Application::Application()
     // std::filesystem::path const DEFAULT_SCENE_PATH = "new_sponza\\new_sponza.gltf";
     // std::filesystem::path const DEFAULT_SCENE_PATH = "cube_on_plane\\cube.gltf";
 
-    auto const result = scene->load_manifest_from_gltf(DEFAULT_ROOT_PATH, DEFAULT_SCENE_PATH);
-    if (Scene::LoadManifestErrorCode const * err = std::get_if<Scene::LoadManifestErrorCode>(&result))
+    asset_processor->set_texture_streamer(texture_streamer.get());
+    /// NOTE: Try the cooked scene cache first, fall back to parsing the gltf and cook a new cache from the loaded data.
+    ff::PreciseStopwatch scene_load_stopwatch = {};
+    ff::UploadStatistics upload_statistics = {};
+    std::filesystem::path const scene_path = DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH;
+    std::filesystem::path cache_path = scene_path;
+    cache_path += ".ffcache";
+    auto cache_result = SceneCache::open(cache_path, scene_path);
+    bool const warm_load = std::holds_alternative<SceneCache>(cache_result);
+    if (warm_load)
     {
-        APP_LOG(fmt::format("[WARN][Application::Application()] Loading \"{}\" Error: {}",
-                            (DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH).string(),
-                            Scene::to_string(*err)));
-    }
-    auto const load_result = asset_processor->load_all(*scene);
-    if (load_result != AssetProcessor::AssetLoadResultCode::SUCCESS)
-    {
-        APP_LOG(fmt::format("[INFO]Application::Application()] Loading Scene Assets \"{}\" Error: {}",
-                            (DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH).string(),
-                            AssetProcessor::to_string(load_result)));
+        scene_cache = std::move(std::get<SceneCache>(cache_result));
+        scene_cache.load_manifest(*scene);
+        asset_processor->load_all_from_cache(*scene, scene_cache);
+        upload_statistics = asset_processor->record_gpu_load_processing_commands(
+            *scene, info.compressed_vertices ? VERTEX_FORMAT_COMPRESSED : VERTEX_FORMAT_FULL);
     }
     else
     {
-        auto const r_id = std::get<RenderEntityId>(result);
-        RenderEntity & r_ent = *scene->_render_entities.slot(r_id);
-        APP_LOG(fmt::format("[INFO]Application::Application()] Loading Scene Assets \"{}\" Success",
-                            (DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH).string()));
+        APP_LOG(fmt::format("[INFO][Application::Application()] Scene cache \"{}\" not used: {}",
+                            cache_path.string(), SceneCache::to_string(std::get<SceneCache::ErrorCode>(cache_result))));
+        auto const result = scene->load_manifest_from_gltf(DEFAULT_ROOT_PATH, DEFAULT_SCENE_PATH);
+        if (Scene::LoadManifestErrorCode const * err = std::get_if<Scene::LoadManifestErrorCode>(&result))
+        {
+            APP_LOG(fmt::format("[WARN][Application::Application()] Loading \"{}\" Error: {}",
+                                (DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH).string(),
+                                Scene::to_string(*err)));
+        }
+        auto const load_result = asset_processor->load_all(*scene);
+        if (load_result != AssetProcessor::AssetLoadResultCode::SUCCESS)
+        {
+            APP_LOG(fmt::format("[INFO]Application::Application()] Loading Scene Assets \"{}\" Error: {}",
+                                (DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH).string(),
+                                AssetProcessor::to_string(load_result)));
+        }
+        else
+        {
+            APP_LOG(fmt::format("[INFO]Application::Application()] Loading Scene Assets \"{}\" Success",
+                                (DEFAULT_ROOT_PATH / DEFAULT_SCENE_PATH).string()));
+            auto const cook_result = asset_processor->cook_scene_cache(*scene, cache_path);
+            if (cook_result.has_value())
+            {
+                APP_LOG(fmt::format("[WARN][Application::Application()] Could not cook scene cache \"{}\": {}",
+                                    cache_path.string(), SceneCache::to_string(cook_result.value())));
+            }
+        }
+        upload_statistics = asset_processor->record_gpu_load_processing_commands(
+            *scene, info.compressed_vertices ? VERTEX_FORMAT_COMPRESSED : VERTEX_FORMAT_FULL);
     }
-    asset_processor->record_gpu_load_processing_commands(*scene);
+    APP_LOG(fmt::format("[INFO][Application::Application()] {} scene load took {}ms",
+                        warm_load ? "Warm (cached)" : "Cold (gltf)", scene_load_stopwatch.elapsed_time<f32, std::chrono::milliseconds>()));
+    APP_LOG(fmt::format("[INFO][Application::Application()] Uploaded {:.2f}MiB to the GPU in {} submits, upload took {}ms",
+                        static_cast<f64>(upload_statistics.uploaded_bytes) / (1024.0 * 1024.0), upload_statistics.submit_count, upload_statistics.elapsed_time_ms));
     commands = scene->record_scene_draw_commands();
     last_time_point = std::chrono::steady_clock::now();
 }
@@ -234,6 +272,10 @@ Application::Application()
 using FpMilliseconds = std::chrono::duration<float, std::chrono::milliseconds::period>;
 auto Application::run() -> i32
 {
+    if (info.headless)
+    {
+        return run_benchmark();
+    }
     while (keep_running)
     {
         auto new_time_point = std::chrono::steady_clock::now();
@@ -247,13 +289,14 @@ auto Application::run() -> i32
         update();
         if (!use_manual_camera)
         {
-            camera.update_position(*window, delta_time);
+            camera.update_position(f32(window->get_width()) / f32(window->get_height()), delta_time);
         }
         commands.no_ao = no_ao;
         commands.no_albedo = no_albedo;
         commands.no_shadows = no_shadows;
         commands.force_ao = force_ao;
         commands.no_normal_maps = no_normal_maps;
+        commands.virtual_shadows = virtual_shadows;
         commands.reset_fsr = reset_fsr;
         commands.no_fog = no_fog;
         commands.no_fsr = no_fsr;
@@ -266,11 +309,83 @@ auto Application::run() -> i32
         {
             renderer->draw_frame(commands, camera.info, delta_time);
         }
+        if (texture_streamer)
+        {
+            texture_streamer->update(*scene, renderer->get_texture_feedback());
+        }
         keep_running &= !static_cast<bool>(glfwWindowShouldClose(window->glfw_handle));
     }
     return 0;
 }
 
+auto Application::run_benchmark() -> i32
+{
+    f32 const aspect_ratio = f32(info.headless_extent.width) / f32(info.headless_extent.height);
+    std::vector<BenchmarkFrame> frames(info.benchmark_frame_count);
+    /// NOTE: The GPU zones of a frame are read back once its profiler slot is reused, FRAMES_IN_FLIGHT + 1 frames
+    //        later. That many frames are rendered after the benchmarked ones so that every benchmarked frame has
+    //        its GPU timings, they are not recorded themselves.
+    u32 const drain_frame_count = ff::FRAMES_IN_FLIGHT + 1;
+    context->device->reset_queue_overlap_statistics();
+    context->device->set_queue_overlap_timing(true);
+    for (u32 frame_index = 0; frame_index < info.benchmark_frame_count + drain_frame_count; frame_index++)
+    {
+        ff::PreciseStopwatch cpu_stopwatch = {};
+        camera.update_position(aspect_ratio, info.benchmark_timestep);
+        renderer->draw_frame(commands, camera.info, info.benchmark_timestep);
+        if (texture_streamer)
+        {
+            texture_streamer->update(*scene, renderer->get_texture_feedback());
+        }
+        f32 const cpu_ms = cpu_stopwatch.elapsed_time<f32, std::chrono::duration<f32, std::milli>>();
+        if (frame_index < info.benchmark_frame_count)
+        {
+            frames.at(frame_index).frame_index = frame_index;
+            frames.at(frame_index).time_s = static_cast<f32>(frame_index + 1) * info.benchmark_timestep;
+            frames.at(frame_index).cpu_ms = cpu_ms;
+        }
+        if (frame_index >= drain_frame_count)
+        {
+            auto const resolved_zones = context->device->get_resolved_gpu_zones();
+            frames.at(frame_index - drain_frame_count).gpu_zones.assign(resolved_zones.begin(), resolved_zones.end());
+        }
+    }
+    context->device->wait_idle();
+    // Resolves the submit timestamps of the last frames
+    context->device->cleanup_resources();
+    context->device->set_queue_overlap_timing(false);
+
+    BenchmarkInfo const benchmark_info = {
+        .device_name = context->device->physical_device_properties.properties.deviceName,
+        .extent = info.headless_extent,
+        .timestep = info.benchmark_timestep,
+    };
+    if (!write_benchmark_results(info.benchmark_output, benchmark_info, frames))
+    {
+        fmt::println("[ERROR][Application::run_benchmark()] Could not write benchmark results to \"{}\"", info.benchmark_output.string());
+        return 1;
+    }
+    fmt::println("[INFO][Application::run_benchmark()] Rendered {} frames at {}x{} on {}, results written to \"{}\"",
+                 info.benchmark_frame_count, info.headless_extent.width, info.headless_extent.height,
+                 benchmark_info.device_name, info.benchmark_output.string());
+    if (texture_streamer)
+    {
+        TextureStreamingStatistics const streaming_statistics = texture_streamer->get_statistics();
+        fmt::println("[INFO][Application::run_benchmark()] Streamed {} textures, {} mips loaded, {} evicted, {:.2f} / {:.2f} MiB resident",
+                     streaming_statistics.streamed_texture_count, streaming_statistics.loaded_mip_count, streaming_statistics.evicted_mip_count,
+                     static_cast<f32>(streaming_statistics.resident_bytes) / (1024.0f * 1024.0f),
+                     static_cast<f32>(streaming_statistics.vram_budget) / (1024.0f * 1024.0f));
+    }
+    ff::QueueOverlapStatistics const overlap_statistics = context->device->reset_queue_overlap_statistics();
+    if (overlap_statistics.transfer_submit_count > 0)
+    {
+        fmt::println("[INFO][Application::run_benchmark()] {} transfer queue submits took {:.2f}ms, {:.2f}ms ({:.1f}%) of it overlapped with the main queue",
+                     overlap_statistics.transfer_submit_count, overlap_statistics.transfer_busy_ms, overlap_statistics.transfer_overlapped_ms,
+                     overlap_statistics.transfer_busy_ms > 0.0f ? 100.0f * overlap_statistics.transfer_overlapped_ms / overlap_statistics.transfer_busy_ms : 0.0f);
+    }
+    return 0;
+}
+
 void Application::update()
 {
     if (window->size.x == 0 || window->size.y == 0)
@@ -304,34 +419,38 @@ void Application::update()
     }
     if (window->key_just_pressed(GLFW_KEY_5))
     {
-        renderer->change_fsr_scaling(1.0f);
+        change_fsr_scaling(1.0f);
         reset_fsr = true;
     }
     if (window->key_just_pressed(GLFW_KEY_6))
     {
-        renderer->change_fsr_scaling(1.5f);
+        change_fsr_scaling(1.5f);
         reset_fsr = true;
     }
     if (window->key_just_pressed(GLFW_KEY_7))
     {
-        renderer->change_fsr_scaling(1.75f);
+        change_fsr_scaling(1.75f);
         reset_fsr = true;
     }
     if (window->key_just_pressed(GLFW_KEY_8))
     {
-        renderer->change_fsr_scaling(2.0f);
+        change_fsr_scaling(2.0f);
         reset_fsr = true;
     }
     if (window->key_just_pressed(GLFW_KEY_9))
     {
-        renderer->change_fsr_scaling(3.0f);
+        change_fsr_scaling(3.0f);
         reset_fsr = true;
     }
     if (window->key_just_pressed(GLFW_KEY_MINUS))
     {
-        renderer->change_fsr_scaling(1.0f);
+        change_fsr_scaling(1.0f);
         no_fsr = !no_fsr;
     }
+    if (window->key_just_pressed(GLFW_KEY_V))
+    {
+        virtual_shadows = 1 - virtual_shadows;
+    }
     if (window->key_just_pressed(GLFW_KEY_M))
     {
         use_manual_camera = !use_manual_camera;
@@ -344,6 +463,15 @@ void Application::update()
     camera_controller.update_matrices(*window);
 }
 
+void Application::change_fsr_scaling(f32 new_scaling)
+{
+    renderer->change_fsr_scaling(new_scaling);
+    if (texture_streamer)
+    {
+        texture_streamer->set_mip_bias(renderer->get_material_lod_bias());
+    }
+}
+
 Application::~Application()
 {
 }
\ No newline at end of file
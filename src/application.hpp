@@ -7,18 +7,40 @@
 #include "scene/asset_processor.hpp"
 #include "rendering/renderer.hpp"
 #include "camera.hpp"
+#include "benchmark.hpp"
 using namespace ff::types;
 
+struct ApplicationInfo
+{
+    /// NOTE: Headless runs render offscreen without a window, step the cinematic camera by benchmark_timestep for
+    //        benchmark_frame_count frames and write the frame timings into benchmark_output. Needs no surface
+    //        support so it also runs on software implementations such as lavapipe.
+    bool headless = {};
+    VkExtent2D headless_extent = {1920, 1080};
+    u32 benchmark_frame_count = 1000;
+    f32 benchmark_timestep = 1.0f / 60.0f;
+    std::filesystem::path benchmark_output = "benchmark.csv";
+    // Uploads the vertex streams as VERTEX_FORMAT_COMPRESSED, otherwise as full precision floats
+    bool compressed_vertices = false;
+    // Uploads only the texture mip tails and streams the rest in by the prepass feedback, otherwise uploads every mip
+    bool texture_streaming = true;
+    u32 texture_budget_mib = 512;
+};
+
 struct Application
 {
   public:
-    Application();
+    Application(ApplicationInfo const & info = {});
     ~Application();
 
     auto run() -> i32;
 
   private:
     void update();
+    auto run_benchmark() -> i32;
+    // Keeps the texture streamer requesting the mips the material sampler reads at the new scaling
+    void change_fsr_scaling(f32 new_scaling);
+    ApplicationInfo info = {};
     f32 delta_time = 0.016666f;
     std::chrono::time_point<std::chrono::steady_clock> last_time_point = {};
 
@@ -28,6 +50,7 @@ struct Application
     u32 no_albedo = {};
     u32 no_shadows = {};
     u32 no_normal_maps = {};
+    u32 virtual_shadows = {};
     bool no_fog = {};
     bool reset_fsr = {};
     bool no_fsr = {};
@@ -37,6 +60,9 @@ struct Application
     std::unique_ptr<ff::Renderer> renderer = {};
     std::unique_ptr<Scene> scene = {};
     std::unique_ptr<AssetProcessor> asset_processor = {};
+    // Streamed textures may point into the mapped cache, so it has to outlive the streamer
+    SceneCache scene_cache = {};
+    std::unique_ptr<TextureStreamer> texture_streamer = {};
     CameraController camera_controller = {};
     CinematicCamera camera = {};
     SceneDrawCommands commands = {};
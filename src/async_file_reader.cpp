@@ -0,0 +1,499 @@
+#include "async_file_reader.hpp"
+
+#include <fstream>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ff
+{
+    // Reads are mostly waiting on the storage, more threads than cores keep more of them in flight
+    static constexpr u32 DEFAULT_FALLBACK_THREAD_COUNT = 16;
+
+#if defined(__linux__)
+    // Opens, size queries and reads in flight at once
+    static constexpr u32 IO_URING_QUEUE_DEPTH = 64;
+    // Bounds a single read, larger ranges are read in multiple steps
+    static constexpr usize IO_URING_MAX_READ_SIZE = usize(1) << 30;
+
+    struct AsyncFileReader::IoUring
+    {
+        i32 ring_fd = -1;
+        void * sq_ring = MAP_FAILED;
+        usize sq_ring_size = {};
+        void * cq_ring = MAP_FAILED;
+        usize cq_ring_size = {};
+        io_uring_sqe * sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+        usize sqes_size = {};
+        u32 sq_entries = {};
+        u32 * sq_head = {};
+        u32 * sq_tail = {};
+        u32 * sq_mask = {};
+        u32 * sq_array = {};
+        u32 * cq_head = {};
+        u32 * cq_tail = {};
+        u32 * cq_mask = {};
+        io_uring_cqe * cqes = {};
+
+        ~IoUring()
+        {
+            if (sqes != MAP_FAILED)
+            {
+                munmap(sqes, sqes_size);
+            }
+            if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+            {
+                munmap(cq_ring, cq_ring_size);
+            }
+            if (sq_ring != MAP_FAILED)
+            {
+                munmap(sq_ring, sq_ring_size);
+            }
+            if (ring_fd >= 0)
+            {
+                close(ring_fd);
+            }
+        }
+
+        auto supports_required_operations() -> bool
+        {
+            usize const probe_size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+            std::vector<std::byte> probe_memory(probe_size);
+            auto * probe = reinterpret_cast<io_uring_probe *>(probe_memory.data());
+            if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+            {
+                return false;
+            }
+            for (u32 const opcode : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ})
+            {
+                if (opcode > probe->last_op || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Returns nullptr when the kernel does not provide io_uring or blocks it for this process
+        static auto create() -> std::unique_ptr<IoUring>
+        {
+            auto ring = std::make_unique<IoUring>();
+            io_uring_params params = {};
+            ring->ring_fd = static_cast<i32>(syscall(__NR_io_uring_setup, IO_URING_QUEUE_DEPTH, &params));
+            if (ring->ring_fd < 0 || !ring->supports_required_operations())
+            {
+                return nullptr;
+            }
+            ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+            ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool const single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap)
+            {
+                ring->sq_ring_size = std::max(ring->sq_ring_size, ring->cq_ring_size);
+            }
+            ring->sq_ring = mmap(nullptr, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+            if (ring->sq_ring == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            ring->cq_ring = single_mmap ? ring->sq_ring : mmap(nullptr, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_CQ_RING);
+            if (ring->cq_ring == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            ring->sqes = static_cast<io_uring_sqe *>(mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES));
+            if (ring->sqes == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            auto * const sq_bytes = static_cast<std::byte *>(ring->sq_ring);
+            auto * const cq_bytes = static_cast<std::byte *>(ring->cq_ring);
+            ring->sq_entries = params.sq_entries;
+            ring->sq_head = reinterpret_cast<u32 *>(sq_bytes + params.sq_off.head);
+            ring->sq_tail = reinterpret_cast<u32 *>(sq_bytes + params.sq_off.tail);
+            ring->sq_mask = reinterpret_cast<u32 *>(sq_bytes + params.sq_off.ring_mask);
+            ring->sq_array = reinterpret_cast<u32 *>(sq_bytes + params.sq_off.array);
+            ring->cq_head = reinterpret_cast<u32 *>(cq_bytes + params.cq_off.head);
+            ring->cq_tail = reinterpret_cast<u32 *>(cq_bytes + params.cq_off.tail);
+            ring->cq_mask = reinterpret_cast<u32 *>(cq_bytes + params.cq_off.ring_mask);
+            ring->cqes = reinterpret_cast<io_uring_cqe *>(cq_bytes + params.cq_off.cqes);
+            return ring;
+        }
+
+        /// NOTE: Only the reader thread touches the ring and every submitted entry is consumed by the next enter(),
+        //        so the submission queue can not overflow as long as no more than sq_entries operations are in flight.
+        auto get_sqe() -> io_uring_sqe *
+        {
+            u32 const tail = *sq_tail;
+            u32 const index = tail & *sq_mask;
+            io_uring_sqe * sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(io_uring_sqe));
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+            return sqe;
+        }
+
+        /// NOTE: Returns the number of consumed entries or the negated errno on failure. -EBUSY means the completion
+        //        queue is full, the caller has to reap completions before entering again.
+        auto enter(u32 to_submit, u32 min_complete) -> i32
+        {
+            while (true)
+            {
+                long const result = syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (result >= 0)
+                {
+                    return static_cast<i32>(result);
+                }
+                if (errno != EINTR && errno != EAGAIN)
+                {
+                    return -errno;
+                }
+            }
+        }
+    };
+#endif
+
+    AsyncFileReader::AsyncFileReader(u32 fallback_thread_count)
+        : fallback_thread_count{fallback_thread_count == 0 ? DEFAULT_FALLBACK_THREAD_COUNT : fallback_thread_count}
+    {
+#if defined(__linux__)
+        io_uring = IoUring::create();
+#endif
+    }
+
+    AsyncFileReader::~AsyncFileReader()
+    {
+        join();
+    }
+
+    auto AsyncFileReader::get_backend_name() const -> std::string_view
+    {
+#if defined(__linux__)
+        if (io_uring)
+        {
+            return "io_uring";
+        }
+#endif
+        return "thread pool";
+    }
+
+    void AsyncFileReader::submit(std::span<FileReadRequest const> requests)
+    {
+        join();
+        reads.clear();
+        reads.resize(requests.size());
+        for (u32 read_index = 0; read_index < requests.size(); read_index++)
+        {
+            reads.at(read_index).path = requests[read_index].path.native();
+            reads.at(read_index).offset = requests[read_index].offset;
+            reads.at(read_index).size = requests[read_index].size;
+        }
+        next_read_index.store(0, std::memory_order_relaxed);
+        if (reads.empty())
+        {
+            return;
+        }
+#if defined(__linux__)
+        if (io_uring)
+        {
+            threads.emplace_back([this]()
+                                 { io_uring_main(); });
+            return;
+        }
+#endif
+        u32 const thread_count = std::min(fallback_thread_count, static_cast<u32>(reads.size()));
+        for (u32 thread_index = 0; thread_index < thread_count; thread_index++)
+        {
+            threads.emplace_back([this]()
+                                 { fallback_main(); });
+        }
+    }
+
+    auto AsyncFileReader::wait(u32 request_index) -> FileReadResult
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        PendingRead & read = reads.at(request_index);
+        read_done.wait(lock, [&]
+                       { return read.done; });
+        return std::move(read.result);
+    }
+
+    void AsyncFileReader::finish_read(PendingRead & read, bool success)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            read.result.success = success;
+            if (!success)
+            {
+                read.result.data.clear();
+            }
+            read.done = true;
+        }
+        read_done.notify_all();
+    }
+
+    void AsyncFileReader::join()
+    {
+        for (std::thread & thread : threads)
+        {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    void AsyncFileReader::fallback_main()
+    {
+        while (true)
+        {
+            u32 const read_index = next_read_index.fetch_add(1, std::memory_order_relaxed);
+            if (read_index >= reads.size())
+            {
+                return;
+            }
+            read_blocking(reads.at(read_index));
+        }
+    }
+
+    void AsyncFileReader::read_blocking(PendingRead & read)
+    {
+        std::ifstream ifs{std::filesystem::path(read.path), std::ios::binary};
+        if (!ifs)
+        {
+            finish_read(read, false);
+            return;
+        }
+        ifs.seekg(0, ifs.end);
+        usize const file_size = static_cast<usize>(ifs.tellg());
+        if (read.offset > file_size || (read.size.has_value() && read.offset + read.size.value() > file_size))
+        {
+            finish_read(read, false);
+            return;
+        }
+        read.result.data.resize(read.size.value_or(file_size - read.offset));
+        ifs.seekg(static_cast<std::streamoff>(read.offset), ifs.beg);
+        bool const success = static_cast<bool>(ifs.read(reinterpret_cast<char *>(read.result.data.data()), static_cast<std::streamsize>(read.result.data.size())));
+        finish_read(read, success);
+    }
+
+#if defined(__linux__)
+    void AsyncFileReader::io_uring_main()
+    {
+        /// NOTE: Every read walks through open, an optional size query when no size was requested, and as many
+        //        reads as the kernel needs to fill the buffer. The next operation of a read is queued from the
+        //        completion of the previous one, the user data of each operation is the index of its read.
+        enum struct Stage
+        {
+            OPEN,
+            STATX,
+            READ,
+        };
+        struct UringRead
+        {
+            Stage stage = Stage::OPEN;
+            i32 fd = -1;
+            struct statx statx_buffer = {};
+            usize bytes_read = {};
+        };
+        std::vector<UringRead> uring_reads(reads.size());
+        u32 in_flight_count = 0;
+        u32 queued_count = 0;
+        // Operations the kernel consumed and did not complete yet, they still write into their reads
+        u32 submitted_count = 0;
+
+        auto queue_open = [&](u32 read_index)
+        {
+            io_uring_sqe * sqe = io_uring->get_sqe();
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<u64>(reads.at(read_index).path.c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            sqe->user_data = read_index;
+            uring_reads.at(read_index).stage = Stage::OPEN;
+            queued_count += 1;
+        };
+        auto queue_statx = [&](u32 read_index)
+        {
+            io_uring_sqe * sqe = io_uring->get_sqe();
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = uring_reads.at(read_index).fd;
+            sqe->addr = reinterpret_cast<u64>("");
+            sqe->len = STATX_SIZE;
+            sqe->statx_flags = AT_EMPTY_PATH;
+            sqe->off = reinterpret_cast<u64>(&uring_reads.at(read_index).statx_buffer);
+            sqe->user_data = read_index;
+            uring_reads.at(read_index).stage = Stage::STATX;
+            queued_count += 1;
+        };
+        auto queue_read = [&](u32 read_index)
+        {
+            PendingRead & read = reads.at(read_index);
+            UringRead & uring_read = uring_reads.at(read_index);
+            io_uring_sqe * sqe = io_uring->get_sqe();
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = uring_read.fd;
+            sqe->addr = reinterpret_cast<u64>(read.result.data.data() + uring_read.bytes_read);
+            sqe->len = static_cast<u32>(std::min(read.result.data.size() - uring_read.bytes_read, IO_URING_MAX_READ_SIZE));
+            sqe->off = read.offset + uring_read.bytes_read;
+            sqe->user_data = read_index;
+            uring_read.stage = Stage::READ;
+            queued_count += 1;
+        };
+        auto complete = [&](u32 read_index, bool success)
+        {
+            UringRead & uring_read = uring_reads.at(read_index);
+            if (uring_read.fd >= 0)
+            {
+                close(uring_read.fd);
+                uring_read.fd = -1;
+            }
+            in_flight_count -= 1;
+            finish_read(reads.at(read_index), success);
+        };
+        auto start_reading = [&](u32 read_index, usize byte_size)
+        {
+            reads.at(read_index).result.data.resize(byte_size);
+            if (byte_size == 0)
+            {
+                complete(read_index, true);
+                return;
+            }
+            queue_read(read_index);
+        };
+
+        u32 next_open_index = 0;
+        while (next_open_index < reads.size() || in_flight_count > 0)
+        {
+            while (in_flight_count < io_uring->sq_entries && next_open_index < reads.size())
+            {
+                queue_open(next_open_index);
+                next_open_index += 1;
+                in_flight_count += 1;
+            }
+            i32 const enter_result = io_uring->enter(queued_count, 1);
+            if (enter_result < 0 && enter_result != -EBUSY)
+            {
+                /// NOTE: The ring is unusable, no further operations are submitted. Operations the kernel already
+                //        consumed still write into the buffers and statx results of their reads, their completions
+                //        are waited for before the reads are released. Completions are posted without entering.
+                while (submitted_count > 0)
+                {
+                    u32 cq_head = *io_uring->cq_head;
+                    u32 const cq_tail = __atomic_load_n(io_uring->cq_tail, __ATOMIC_ACQUIRE);
+                    for (; cq_head != cq_tail; cq_head++)
+                    {
+                        io_uring_cqe const & cqe = io_uring->cqes[cq_head & *io_uring->cq_mask];
+                        if (uring_reads.at(static_cast<u32>(cqe.user_data)).stage == Stage::OPEN && cqe.res >= 0)
+                        {
+                            close(cqe.res);
+                        }
+                        submitted_count -= 1;
+                    }
+                    __atomic_store_n(io_uring->cq_head, cq_head, __ATOMIC_RELEASE);
+                    if (submitted_count > 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                for (u32 read_index = 0; read_index < reads.size(); read_index++)
+                {
+                    if (uring_reads.at(read_index).fd >= 0)
+                    {
+                        close(uring_reads.at(read_index).fd);
+                    }
+                    if (!reads.at(read_index).done)
+                    {
+                        finish_read(reads.at(read_index), false);
+                    }
+                }
+                return;
+            }
+            // The kernel may consume fewer entries than were queued, the rest is submitted by the next enter()
+            queued_count -= static_cast<u32>(std::max(enter_result, 0));
+            submitted_count += static_cast<u32>(std::max(enter_result, 0));
+
+            u32 cq_head = *io_uring->cq_head;
+            u32 const cq_tail = __atomic_load_n(io_uring->cq_tail, __ATOMIC_ACQUIRE);
+            for (; cq_head != cq_tail; cq_head++)
+            {
+                io_uring_cqe const & cqe = io_uring->cqes[cq_head & *io_uring->cq_mask];
+                u32 const read_index = static_cast<u32>(cqe.user_data);
+                i32 const result = cqe.res;
+                submitted_count -= 1;
+                PendingRead & read = reads.at(read_index);
+                UringRead & uring_read = uring_reads.at(read_index);
+                if (result == -EINTR || result == -EAGAIN)
+                {
+                    switch (uring_read.stage)
+                    {
+                        case Stage::OPEN:  queue_open(read_index); break;
+                        case Stage::STATX: queue_statx(read_index); break;
+                        case Stage::READ:  queue_read(read_index); break;
+                    }
+                    continue;
+                }
+                if (result < 0)
+                {
+                    complete(read_index, false);
+                    continue;
+                }
+                switch (uring_read.stage)
+                {
+                    case Stage::OPEN:
+                    {
+                        uring_read.fd = result;
+                        if (read.size.has_value())
+                        {
+                            start_reading(read_index, read.size.value());
+                        }
+                        else
+                        {
+                            queue_statx(read_index);
+                        }
+                        break;
+                    }
+                    case Stage::STATX:
+                    {
+                        usize const file_size = static_cast<usize>(uring_read.statx_buffer.stx_size);
+                        if (read.offset > file_size)
+                        {
+                            complete(read_index, false);
+                            break;
+                        }
+                        start_reading(read_index, file_size - read.offset);
+                        break;
+                    }
+                    case Stage::READ:
+                    {
+                        // Zero bytes means the file ended before the requested range did
+                        if (result == 0)
+                        {
+                            complete(read_index, false);
+                            break;
+                        }
+                        uring_read.bytes_read += static_cast<usize>(result);
+                        if (uring_read.bytes_read < read.result.data.size())
+                        {
+                            queue_read(read_index);
+                        }
+                        else
+                        {
+                            complete(read_index, true);
+                        }
+                        break;
+                    }
+                }
+            }
+            __atomic_store_n(io_uring->cq_head, cq_head, __ATOMIC_RELEASE);
+        }
+    }
+#endif
+} // namespace ff
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string_view>
+
+#include "fairy_forest.hpp"
+
+namespace ff
+{
+    struct FileReadRequest
+    {
+        std::filesystem::path path = {};
+        usize offset = {};
+        // Reads from offset to the end of the file when not set
+        std::optional<usize> size = {};
+    };
+
+    struct FileReadResult
+    {
+        std::vector<std::byte> data = {};
+        // False when the file could not be opened or the requested range could not be read completely
+        bool success = {};
+    };
+
+    /// NOTE: Reads a batch of files in the background so that the latency of the individual reads overlaps. On Linux
+    //        the whole batch is driven through a single io_uring by one thread, opens and size queries included.
+    //        Elsewhere, or when the kernel does not support the required io_uring operations, a small pool of
+    //        threads issues blocking reads instead. Each destination buffer is allocated once the size of its file
+    //        is known and handed out by wait(), which can be called from any thread while the batch is in flight.
+    struct AsyncFileReader
+    {
+      public:
+        // fallback_thread_count == 0 picks a default suited for high latency storage
+        AsyncFileReader(u32 fallback_thread_count = 0);
+        AsyncFileReader(AsyncFileReader const &) = delete;
+        AsyncFileReader & operator=(AsyncFileReader const &) = delete;
+        ~AsyncFileReader();
+
+        auto get_backend_name() const -> std::string_view;
+        // Starts reading all requests, waits for the previous batch to finish first
+        void submit(std::span<FileReadRequest const> requests);
+        // Blocks until the request of the current batch finished and moves its result out, at most once per request
+        auto wait(u32 request_index) -> FileReadResult;
+
+      private:
+        struct PendingRead
+        {
+            // Kept as the native string so the kernel can read the path while the open is in flight
+            std::filesystem::path::string_type path = {};
+            usize offset = {};
+            std::optional<usize> size = {};
+            FileReadResult result = {};
+            bool done = {};
+        };
+
+        u32 fallback_thread_count = {};
+        std::vector<PendingRead> reads = {};
+        std::vector<std::thread> threads = {};
+        std::atomic<u32> next_read_index = {};
+        std::mutex mutex = {};
+        std::condition_variable read_done = {};
+#if defined(__linux__)
+        struct IoUring;
+        std::unique_ptr<IoUring> io_uring;
+
+        void io_uring_main();
+#endif
+        void fallback_main();
+        void read_blocking(PendingRead & read);
+        void finish_read(PendingRead & read, bool success);
+        void join();
+    };
+} // namespace ff
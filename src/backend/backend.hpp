@@ -5,6 +5,7 @@
 #include "features.hpp"
 #include "swapchain.hpp"
 #include "command_buffer.hpp"
+#include "upload_batcher.hpp"
 #include "pipeline.hpp"
 #include "gpu_resource_table.hpp"
 #include "fsr.hpp"
\ No newline at end of file
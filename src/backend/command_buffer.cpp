@@ -1,28 +1,15 @@
 #include "command_buffer.hpp"
 namespace ff
 {
-    CommandBuffer::CommandBuffer(std::shared_ptr<Device> device)
+    CommandBuffer::CommandBuffer(std::shared_ptr<Device> device, QueueType queue)
         : device{device},
+          queue{queue},
           was_recorded{false},
           in_renderpass{false}
     {
-        VkCommandPoolCreateInfo const command_pool_create_info = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-            .queueFamilyIndex = static_cast<u32>(device->main_queue_family_index),
-        };
-
-        CHECK_VK_RESULT(vkCreateCommandPool(device->vulkan_device, &command_pool_create_info, nullptr, &pool));
-
-        VkCommandBufferAllocateInfo const command_buffer_allocate_info = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-            .pNext = nullptr,
-            .commandPool = pool,
-            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-            .commandBufferCount = 1,
-        };
-        CHECK_VK_RESULT(vkAllocateCommandBuffers(device->vulkan_device, &command_buffer_allocate_info, &buffer));
+        auto const [acquired_pool_index, acquired_buffer] = device->acquire_command_buffer(queue);
+        pool_index = acquired_pool_index;
+        buffer = acquired_buffer;
     }
 
     void CommandBuffer::begin()
@@ -55,6 +42,11 @@ namespace ff
             BACKEND_LOG("[ERROR][CommandBuffer::end()] Did not call begin()");
             throw std::runtime_error("[ERROR][CommandBuffer::end()] Did not call begin()");
         }
+        if (!open_zones.empty())
+        {
+            BACKEND_LOG(fmt::format("[ERROR][CommandBuffer::end()] {} zones were not ended", open_zones.size()));
+            throw std::runtime_error("[ERROR][CommandBuffer::end()] Zones were not ended");
+        }
         CHECK_VK_RESULT(vkEndCommandBuffer(buffer));
         recording = false;
         was_recorded = true;
@@ -85,6 +77,53 @@ namespace ff
         vkCmdPipelineBarrier2(buffer, &dependency_info);
     }
 
+    void CommandBuffer::begin_zone(std::string_view name)
+    {
+        if (recording != true)
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::begin_zone()] Did not call begin()");
+            throw std::runtime_error("[ERROR][CommandBuffer::begin_zone()] Did not call begin()");
+        }
+        std::string const label_name = std::string(name);
+        VkDebugUtilsLabelEXT const label = {
+            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+            .pNext = nullptr,
+            .pLabelName = label_name.c_str(),
+            .color = {},
+        };
+        if (device->vkCmdBeginDebugUtilsLabelEXT != nullptr)
+        {
+            device->vkCmdBeginDebugUtilsLabelEXT(buffer, &label);
+        }
+        // The profiler query pool is reset and read back in the main queue frame slots
+        bool const main_queue = device->resolve_queue_type(queue) == QueueType::MAIN;
+        std::optional<u32> const begin_query = main_queue ? device->allocate_gpu_zone(name) : std::nullopt;
+        if (begin_query.has_value())
+        {
+            vkCmdWriteTimestamp2(buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, device->timestamp_query_pool, begin_query.value());
+        }
+        open_zones.push_back(begin_query);
+    }
+
+    void CommandBuffer::end_zone()
+    {
+        if (open_zones.empty())
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::end_zone()] No zone to end");
+            throw std::runtime_error("[ERROR][CommandBuffer::end_zone()] No zone to end");
+        }
+        std::optional<u32> const begin_query = open_zones.back();
+        open_zones.pop_back();
+        if (begin_query.has_value())
+        {
+            vkCmdWriteTimestamp2(buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, device->timestamp_query_pool, begin_query.value() + 1);
+        }
+        if (device->vkCmdEndDebugUtilsLabelEXT != nullptr)
+        {
+            device->vkCmdEndDebugUtilsLabelEXT(buffer);
+        }
+    }
+
     void CommandBuffer::cmd_set_push_constant_internal(void const * data, u32 size)
     {
         u32 const layout_index = (size + sizeof(u32) - 1) / sizeof(u32);
@@ -99,17 +138,31 @@ namespace ff
             throw std::runtime_error("[ERROR][CommandBuffer::cmd_image_memory_transition_barrier()] Received invalid image ID");
         }
         auto const & image = device->resource_table->images.slot(info.image_id);
+        bool const queue_transfer = info.src_queue != info.dst_queue;
+        if (queue_transfer && queue != info.src_queue && queue != info.dst_queue)
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::cmd_image_memory_transition_barrier()] Queue transfer recorded on a queue that is neither its source nor its destination");
+            throw std::runtime_error("[ERROR][CommandBuffer::cmd_image_memory_transition_barrier()] Queue transfer recorded on a queue that is neither its source nor its destination");
+        }
+        u32 const src_family_index = device->get_queue_family_index(info.src_queue);
+        u32 const dst_family_index = device->get_queue_family_index(info.dst_queue);
+        bool const ownership_transfer = queue_transfer && src_family_index != dst_family_index;
+        bool const release = ownership_transfer && queue == info.src_queue;
+        bool const acquire = ownership_transfer && queue == info.dst_queue;
+        /// NOTE: When the queue types alias each other the release and acquire are plain barriers on the same queue.
+        //        The release already transitioned the layout, the acquire then only has to make the writes visible.
+        bool const aliased_acquire = queue_transfer && !ownership_transfer && queue == info.dst_queue;
         VkImageMemoryBarrier2 barrier = {
             .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
             .pNext = nullptr,
-            .srcStageMask = info.src_stages,
-            .srcAccessMask = info.src_access,
-            .dstStageMask = info.dst_stages,
-            .dstAccessMask = info.dst_access,
-            .oldLayout = info.src_layout,
+            .srcStageMask = acquire ? VK_PIPELINE_STAGE_2_NONE : info.src_stages,
+            .srcAccessMask = acquire ? VK_ACCESS_2_NONE : info.src_access,
+            .dstStageMask = release ? VK_PIPELINE_STAGE_2_NONE : info.dst_stages,
+            .dstAccessMask = release ? VK_ACCESS_2_NONE : info.dst_access,
+            .oldLayout = aliased_acquire ? info.dst_layout : info.src_layout,
             .newLayout = info.dst_layout,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .srcQueueFamilyIndex = ownership_transfer ? src_family_index : VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = ownership_transfer ? dst_family_index : VK_QUEUE_FAMILY_IGNORED,
             .image = image->image,
             .subresourceRange = {
                 .aspectMask = info.aspect_mask,
@@ -216,6 +269,40 @@ namespace ff
         vkCmdBlitImage(buffer, src_image->image, info.src_layout, dst_image->image, info.dst_layout, 1, &blit, VkFilter::VK_FILTER_LINEAR);
     }
 
+    void CommandBuffer::cmd_copy_image_to_image(CopyImageToImageInfo const & info)
+    {
+        if (!device->resource_table->images.is_id_valid(info.src_image))
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::cmd_copy_image_to_image()] Received invalid src image ID");
+            throw std::runtime_error("[ERROR][CommandBuffer::cmd_copy_image_to_image()] Received invalid src image ID");
+        }
+        if (!device->resource_table->images.is_id_valid(info.dst_image))
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::cmd_copy_image_to_image()] Received invalid dst image ID");
+            throw std::runtime_error("[ERROR][CommandBuffer::cmd_copy_image_to_image()] Received invalid dst image ID");
+        }
+        auto const & src_image = device->resource_table->images.slot(info.src_image);
+        auto const & dst_image = device->resource_table->images.slot(info.dst_image);
+        VkImageCopy const image_copy = {
+            .srcSubresource = VkImageSubresourceLayers{
+                .aspectMask = info.aspect_mask,
+                .mipLevel = info.src_mip_level,
+                .baseArrayLayer = info.src_base_array_layer,
+                .layerCount = info.layer_count,
+            },
+            .srcOffset = info.src_offset,
+            .dstSubresource = VkImageSubresourceLayers{
+                .aspectMask = info.aspect_mask,
+                .mipLevel = info.dst_mip_level,
+                .baseArrayLayer = info.dst_base_array_layer,
+                .layerCount = info.layer_count,
+            },
+            .dstOffset = info.dst_offset,
+            .extent = info.extent,
+        };
+        vkCmdCopyImage(buffer, src_image->image, info.src_layout, dst_image->image, info.dst_layout, 1, &image_copy);
+    }
+
     void CommandBuffer::cmd_image_clear(ImageClearInfo const & info)
     {
         if (!device->resource_table->images.is_id_valid(info.image_id))
@@ -263,6 +350,17 @@ namespace ff
         vkCmdDispatch(buffer, info.x, info.y, info.z);
     }
 
+    void CommandBuffer::cmd_dispatch_indirect(DispatchIndirectInfo const & info)
+    {
+        if (!device->resource_table->buffers.is_id_valid(info.dispatch_buffer))
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::cmd_dispatch_indirect()] Received invalid buffer ID");
+            throw std::runtime_error("[ERROR][CommandBuffer::cmd_dispatch_indirect()] Received invalid buffer ID");
+        }
+        VkBuffer dispatch_buffer = device->resource_table->buffers.slot(info.dispatch_buffer)->buffer;
+        vkCmdDispatchIndirect(buffer, dispatch_buffer, info.offset);
+    }
+
     void CommandBuffer::cmd_draw(DrawInfo const & info)
     {
         vkCmdDraw(buffer, info.vertex_count, info.instance_count, info.first_vertex, info.first_instance);
@@ -273,6 +371,34 @@ namespace ff
         vkCmdDrawIndexed(buffer, info.index_count, info.instance_count, info.first_index, info.vertex_offset, info.first_instance);
     }
 
+    void CommandBuffer::cmd_draw_indexed_indirect_count(DrawIndexedIndirectCountInfo const & info)
+    {
+        if (!device->resource_table->buffers.is_id_valid(info.draw_buffer) ||
+            !device->resource_table->buffers.is_id_valid(info.count_buffer))
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::cmd_draw_indexed_indirect_count()] Received invalid buffer ID");
+            throw std::runtime_error("[ERROR][CommandBuffer::cmd_draw_indexed_indirect_count()] Received invalid buffer ID");
+        }
+        VkBuffer draw_buffer = device->resource_table->buffers.slot(info.draw_buffer)->buffer;
+        VkBuffer count_buffer = device->resource_table->buffers.slot(info.count_buffer)->buffer;
+        vkCmdDrawIndexedIndirectCount(
+            buffer,
+            draw_buffer, info.draw_buffer_offset,
+            count_buffer, info.count_buffer_offset,
+            info.max_draw_count, info.stride);
+    }
+
+    void CommandBuffer::cmd_fill_buffer(FillBufferInfo const & info)
+    {
+        if (!device->resource_table->buffers.is_id_valid(info.buffer_id))
+        {
+            BACKEND_LOG("[ERROR][CommandBuffer::cmd_fill_buffer()] Received invalid buffer ID");
+            throw std::runtime_error("[ERROR][CommandBuffer::cmd_fill_buffer()] Received invalid buffer ID");
+        }
+        VkBuffer dst_buffer = device->resource_table->buffers.slot(info.buffer_id)->buffer;
+        vkCmdFillBuffer(buffer, dst_buffer, info.offset, info.size, info.data);
+    }
+
     void CommandBuffer::cmd_begin_renderpass(BeginRenderpassInfo const & info)
     {
         auto fill_rendering_attachment_info = [&](RenderingAttachmentInfo const & in) -> VkRenderingAttachmentInfo
@@ -377,10 +503,6 @@ namespace ff
 
     CommandBuffer::~CommandBuffer()
     {
-        device->command_buffer_zombies.push({
-            .pool = pool,
-            .buffer = buffer,
-            .cpu_timeline_value = device->main_cpu_timeline_value,
-        });
+        device->release_command_buffer(pool_index);
     }
 } // namespace ff
\ No newline at end of file
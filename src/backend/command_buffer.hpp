@@ -49,6 +49,22 @@ namespace ff
         VkOffset3D dst_start_offset = {};
         VkOffset3D dst_end_offset = {};
     };
+    struct CopyImageToImageInfo
+    {
+        ImageId src_image = {};
+        ImageId dst_image = {};
+        VkImageLayout src_layout = {};
+        VkImageLayout dst_layout = {};
+        VkImageAspectFlags aspect_mask = {};
+        u32 src_mip_level = 0;
+        u32 dst_mip_level = 0;
+        u32 src_base_array_layer = 0;
+        u32 dst_base_array_layer = 0;
+        u32 layer_count = 1;
+        VkOffset3D src_offset = {};
+        VkOffset3D dst_offset = {};
+        VkExtent3D extent = {};
+    };
 
     struct ImageMemoryBarrierTransitionInfo
     {
@@ -64,6 +80,12 @@ namespace ff
         u32 layer_count = 1;
         VkImageAspectFlags aspect_mask = {};
         ImageId image_id = {};
+        /// NOTE: A different src_queue and dst_queue make the barrier a queue family ownership transfer. The same
+        //        info has to be recorded as the release on the src_queue and as the acquire on the dst_queue, the
+        //        command buffer drops the half of the barrier that does not apply to its queue. The layout transition
+        //        happens only once.
+        QueueType src_queue = QueueType::MAIN;
+        QueueType dst_queue = QueueType::MAIN;
     };
 
     struct ImageClearInfo
@@ -121,6 +143,24 @@ namespace ff
         u32 first_instance = {};
     };
 
+    struct DrawIndexedIndirectCountInfo
+    {
+        BufferId draw_buffer = {};
+        usize draw_buffer_offset = {};
+        BufferId count_buffer = {};
+        usize count_buffer_offset = {};
+        u32 max_draw_count = {};
+        u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+    };
+
+    struct FillBufferInfo
+    {
+        BufferId buffer_id = {};
+        usize offset = {};
+        usize size = {};
+        u32 data = {};
+    };
+
     struct DispatchInfo
     {
         u32 x = 0;
@@ -128,6 +168,13 @@ namespace ff
         u32 z = 0;
     };
 
+    struct DispatchIndirectInfo
+    {
+        // Holds a VkDispatchIndirectCommand at offset
+        BufferId dispatch_buffer = {};
+        usize offset = {};
+    };
+
     struct SetIndexBufferInfo
     {
         BufferId buffer_id = {};
@@ -139,7 +186,8 @@ namespace ff
     {
       public:
         CommandBuffer() = default;
-        CommandBuffer(std::shared_ptr<Device> device);
+        // The buffer may only be submitted to the queue it was created for
+        CommandBuffer(std::shared_ptr<Device> device, QueueType queue = QueueType::MAIN);
         ~CommandBuffer();
 
         void begin();
@@ -147,6 +195,7 @@ namespace ff
         void cmd_copy_buffer_to_buffer(CopyBufferToBufferInfo const & info);
         void cmd_copy_buffer_to_image(CopyBufferToImageInfo const & info);
         void cmd_blit_image(BlitImageInfo const & info);
+        void cmd_copy_image_to_image(CopyImageToImageInfo const & info);
         void cmd_image_memory_transition_barrier(ImageMemoryBarrierTransitionInfo const & info);
         void cmd_memory_barrier(MemoryBarrierInfo const & info);
         template <typename T>
@@ -156,11 +205,19 @@ namespace ff
         void cmd_set_compute_pipeline(ComputePipeline const & pipeline);
         void cmd_draw(DrawInfo const & info);
         void cmd_draw_indexed(DrawIndexedInfo const & info);
+        void cmd_draw_indexed_indirect_count(DrawIndexedIndirectCountInfo const & info);
+        void cmd_fill_buffer(FillBufferInfo const & info);
         void cmd_dispatch(DispatchInfo const & info);
+        void cmd_dispatch_indirect(DispatchIndirectInfo const & info);
         void cmd_begin_renderpass(BeginRenderpassInfo const & info);
         void cmd_end_renderpass();
         void cmd_set_viewport(VkViewport const & info);
         void cmd_set_index_buffer(SetIndexBufferInfo const & info);
+        /// NOTE: Zones can be nested and must be closed in the same command buffer. Each zone is a debug label and,
+        //        when the device has an active profiler frame slot, a pair of timestamps, see Device::begin_gpu_profiler_frame().
+        //        Zones of command buffers submitted to a dedicated transfer or compute queue are only labeled.
+        void begin_zone(std::string_view name);
+        void end_zone();
         auto get_recorded_command_buffer() -> VkCommandBuffer;
 
       private:
@@ -170,8 +227,11 @@ namespace ff
         bool was_recorded = {};
         bool in_renderpass = {};
         std::shared_ptr<Device> device = {};
-        VkCommandPool pool = {};
+        QueueType queue = {};
+        u32 pool_index = {};
         VkCommandBuffer buffer = {};
+        // Begin queries of the open zones
+        std::vector<std::optional<u32>> open_zones = {};
 
         void cmd_set_push_constant_internal(void const * data, u32 size);
     };
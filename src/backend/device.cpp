@@ -1,13 +1,17 @@
 #include "device.hpp"
 #include "features.hpp"
 
+#include <algorithm>
+#include <fstream>
+
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
 
 namespace ff
 {
-    Device::Device(std::shared_ptr<Instance> instance)
+    Device::Device(std::shared_ptr<Instance> instance, std::filesystem::path pipeline_cache_path)
         : instance{instance},
+          pipeline_cache_path{pipeline_cache_path},
           main_queue_family_index{-1},
           vulkan_physical_device{get_physical_device()},
           physical_device_properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2}
@@ -35,21 +39,55 @@ namespace ff
         {
             throw std::runtime_error(fmt::format("[Device::Device()] Found no suitable queue family - ERROR"));
         }
+        /// NOTE: Transfer only families map to the copy engines, compute families without graphics to the async
+        //        compute queues. Families that can do more are not used as they would share hardware with the main queue.
+        for (u32 i = 0; i < queue_family_properties_count; i++)
+        {
+            VkQueueFlags const flags = queue_properties[i].queueFlags;
+            bool const graphics = (flags & VK_QUEUE_GRAPHICS_BIT) != 0;
+            bool const compute = (flags & VK_QUEUE_COMPUTE_BIT) != 0;
+            bool const transfer = (flags & VK_QUEUE_TRANSFER_BIT) != 0;
+            AsyncQueue & transfer_queue = async_queues.at(static_cast<u32>(QueueType::TRANSFER));
+            AsyncQueue & compute_queue = async_queues.at(static_cast<u32>(QueueType::COMPUTE));
+            if (transfer && !graphics && !compute && transfer_queue.family_index == -1)
+            {
+                transfer_queue.family_index = i;
+            }
+            if (compute && !graphics && compute_queue.family_index == -1)
+            {
+                compute_queue.family_index = i;
+            }
+        }
         std::array<f32, 1> queue_priorities = {0.0f};
 
-        VkDeviceQueueCreateInfo const queue_create_info{
+        std::vector<VkDeviceQueueCreateInfo> queue_create_infos = {};
+        queue_create_infos.push_back({
             .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0,
             .queueFamilyIndex = static_cast<u32>(main_queue_family_index),
             .queueCount = static_cast<u32>(queue_priorities.size()),
             .pQueuePriorities = queue_priorities.data(),
-        };
+        });
+        for (AsyncQueue const & async_queue : async_queues)
+        {
+            if (async_queue.family_index != -1)
+            {
+                queue_create_infos.push_back({
+                    .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .queueFamilyIndex = static_cast<u32>(async_queue.family_index),
+                    .queueCount = static_cast<u32>(queue_priorities.size()),
+                    .pQueuePriorities = queue_priorities.data(),
+                });
+            }
+        }
 
         PhysicalDeviceFeatureTable feature_table = {};
         feature_table.initialize();
         PhysicalDeviceExtensionList extension_list = {};
-        extension_list.initialize();
+        extension_list.initialize(!instance->headless);
 
         VkPhysicalDeviceFeatures2 physical_device_features_2 = {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
@@ -61,8 +99,8 @@ namespace ff
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
             .pNext = reinterpret_cast<void const *>(&physical_device_features_2),
             .flags = {},
-            .queueCreateInfoCount = static_cast<u32>(1),
-            .pQueueCreateInfos = &queue_create_info,
+            .queueCreateInfoCount = static_cast<u32>(queue_create_infos.size()),
+            .pQueueCreateInfos = queue_create_infos.data(),
             .enabledLayerCount = 0,
             .ppEnabledLayerNames = nullptr,
             .enabledExtensionCount = static_cast<u32>(extension_list.size),
@@ -93,6 +131,17 @@ namespace ff
             .flags = {},
         };
         CHECK_VK_RESULT(vkCreateSemaphore(vulkan_device, &vk_semaphore_create_info, nullptr, &main_gpu_semaphore));
+        for (AsyncQueue & async_queue : async_queues)
+        {
+            if (async_queue.family_index != -1)
+            {
+                vkGetDeviceQueue(vulkan_device, async_queue.family_index, 0, &async_queue.queue);
+                CHECK_VK_RESULT(vkCreateSemaphore(vulkan_device, &vk_semaphore_create_info, nullptr, &async_queue.gpu_semaphore));
+            }
+        }
+        BACKEND_LOG(fmt::format("[INFO][Device::Device()] Transfer queue: {}, compute queue: {}",
+                                has_dedicated_queue(QueueType::TRANSFER) ? "dedicated" : "shared with the main queue",
+                                has_dedicated_queue(QueueType::COMPUTE) ? "dedicated" : "shared with the main queue"));
 
         u32 const device_max_ds_buffers = physical_device_properties.properties.limits.maxDescriptorSetStorageBuffers;
         if (MAX_BUFFERS > device_max_ds_buffers)
@@ -140,6 +189,70 @@ namespace ff
             .pObjectName = "FF Main GPU semaphore",
         };
         CHECK_VK_RESULT(vkSetDebugUtilsObjectNameEXT(vulkan_device, &main_gpu_semaphore_name_info));
+        for (u32 queue_type_index = 0; queue_type_index < QUEUE_TYPE_COUNT; queue_type_index++)
+        {
+            AsyncQueue const & async_queue = async_queues.at(queue_type_index);
+            if (async_queue.family_index == -1)
+            {
+                continue;
+            }
+            bool const is_transfer = static_cast<QueueType>(queue_type_index) == QueueType::TRANSFER;
+            VkDebugUtilsObjectNameInfoEXT const async_queue_name_info = {
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_QUEUE,
+                .objectHandle = reinterpret_cast<uint64_t>(async_queue.queue),
+                .pObjectName = is_transfer ? "FF Transfer Queue" : "FF Compute Queue",
+            };
+            CHECK_VK_RESULT(vkSetDebugUtilsObjectNameEXT(vulkan_device, &async_queue_name_info));
+            VkDebugUtilsObjectNameInfoEXT const async_gpu_semaphore_name_info = {
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_SEMAPHORE,
+                .objectHandle = reinterpret_cast<uint64_t>(async_queue.gpu_semaphore),
+                .pObjectName = is_transfer ? "FF Transfer GPU semaphore" : "FF Compute GPU semaphore",
+            };
+            CHECK_VK_RESULT(vkSetDebugUtilsObjectNameEXT(vulkan_device, &async_gpu_semaphore_name_info));
+        }
+
+        timestamp_valid_bits = queue_properties.at(main_queue_family_index).timestampValidBits;
+        timestamp_period = physical_device_properties.properties.limits.timestampPeriod;
+        if (timestamp_valid_bits != 0)
+        {
+            VkQueryPoolCreateInfo const timestamp_query_pool_create_info = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = {},
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = GPU_PROFILER_FRAME_SLOTS * MAX_GPU_ZONES_PER_FRAME * 2,
+                .pipelineStatistics = {},
+            };
+            CHECK_VK_RESULT(vkCreateQueryPool(vulkan_device, &timestamp_query_pool_create_info, nullptr, &timestamp_query_pool));
+            vkResetQueryPool(vulkan_device, timestamp_query_pool, 0, timestamp_query_pool_create_info.queryCount);
+        }
+        else
+        {
+            BACKEND_LOG("[WARNING][Device::Device()] Main queue does not support timestamps, GPU zones will not be timed")
+        }
+        i32 const transfer_family_index = async_queues.at(static_cast<u32>(QueueType::TRANSFER)).family_index;
+        if (timestamp_valid_bits != 0 && transfer_family_index != -1 && queue_properties.at(transfer_family_index).timestampValidBits != 0)
+        {
+            VkQueryPoolCreateInfo const submit_timestamp_query_pool_create_info = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = {},
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = SUBMIT_TIMING_SLOTS * 2,
+                .pipelineStatistics = {},
+            };
+            CHECK_VK_RESULT(vkCreateQueryPool(vulkan_device, &submit_timestamp_query_pool_create_info, nullptr, &submit_timestamp_query_pool));
+            vkResetQueryPool(vulkan_device, submit_timestamp_query_pool, 0, submit_timestamp_query_pool_create_info.queryCount);
+            for (u32 slot = 0; slot < SUBMIT_TIMING_SLOTS; slot++)
+            {
+                free_submit_timing_slots.push_back(SUBMIT_TIMING_SLOTS - 1 - slot);
+            }
+        }
+        create_pipeline_cache();
         BACKEND_LOG("[INFO][Device::Device()] Device initalization and setup successful")
         resource_table = std::make_unique<GpuResourceTable>(CreateGpuResourceTableInfo{
             .max_buffer_slots = MAX_BUFFERS,
@@ -202,6 +315,15 @@ namespace ff
 
         CHECK_VK_RESULT(vmaCreateAllocator(&vma_allocator_create_info, &allocator));
         BACKEND_LOG("[INFO][Device::Device()] VMA allocator creation successful");
+
+        staging_ring_buffer = create_buffer({
+            .size = STAGING_RING_SIZE,
+            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .name = "staging ring",
+        });
+        staging_ring_host_address = reinterpret_cast<std::byte *>(get_buffer_host_pointer(staging_ring_buffer));
+        allocation_statistics = {};
+        BACKEND_LOG("[INFO][Device::Device()] Staging ring creation successful");
     }
 
     auto Device::info_image(ImageId image_id) -> CreateImageInfo &
@@ -250,6 +372,64 @@ namespace ff
         return resource_table->buffers.slot(buffer_id)->device_address;
     }
 
+    auto Device::has_dedicated_queue(QueueType queue) const -> bool
+    {
+        return resolve_queue_type(queue) != QueueType::MAIN;
+    }
+
+    auto Device::get_queue_family_index(QueueType queue) const -> u32
+    {
+        QueueType const resolved_queue = resolve_queue_type(queue);
+        if (resolved_queue == QueueType::MAIN)
+        {
+            return static_cast<u32>(main_queue_family_index);
+        }
+        return static_cast<u32>(async_queues.at(static_cast<u32>(resolved_queue)).family_index);
+    }
+
+    auto Device::get_last_submit_timeline(QueueType queue) const -> TimelineSemaphoreInfo
+    {
+        QueueType const resolved_queue = resolve_queue_type(queue);
+        return TimelineSemaphoreInfo{
+            .semaphore = get_gpu_semaphore(resolved_queue),
+            .value = resolved_queue == QueueType::MAIN ? main_cpu_timeline_value : async_queues.at(static_cast<u32>(resolved_queue)).cpu_timeline_value,
+        };
+    }
+
+    auto Device::get_completed_timeline_value(QueueType queue) const -> u64
+    {
+        u64 gpu_timeline_value = {};
+        CHECK_VK_RESULT(vkGetSemaphoreCounterValue(vulkan_device, get_gpu_semaphore(queue), &gpu_timeline_value));
+        return gpu_timeline_value;
+    }
+
+    auto Device::resolve_queue_type(QueueType queue) const -> QueueType
+    {
+        if (queue == QueueType::MAIN || async_queues.at(static_cast<u32>(queue)).family_index == -1)
+        {
+            return QueueType::MAIN;
+        }
+        return queue;
+    }
+
+    auto Device::get_vk_queue(QueueType queue) const -> VkQueue
+    {
+        QueueType const resolved_queue = resolve_queue_type(queue);
+        return resolved_queue == QueueType::MAIN ? main_queue : async_queues.at(static_cast<u32>(resolved_queue)).queue;
+    }
+
+    auto Device::get_gpu_semaphore(QueueType queue) const -> VkSemaphore
+    {
+        QueueType const resolved_queue = resolve_queue_type(queue);
+        return resolved_queue == QueueType::MAIN ? main_gpu_semaphore : async_queues.at(static_cast<u32>(resolved_queue)).gpu_semaphore;
+    }
+
+    auto Device::get_cpu_timeline_value(QueueType queue) -> u64 &
+    {
+        QueueType const resolved_queue = resolve_queue_type(queue);
+        return resolved_queue == QueueType::MAIN ? main_cpu_timeline_value : async_queues.at(static_cast<u32>(resolved_queue)).cpu_timeline_value;
+    }
+
     auto Device::create_buffer(CreateBufferInfo const & info) -> BufferId
     {
         if (info.size <= 0)
@@ -283,10 +463,12 @@ namespace ff
             host_accessible = true;
         }
 
+        /// NOTE: Buffers the host reads back are kept coherent, there is no API to invalidate their mapped range.
+        bool const host_readable = (vma_allocation_flags & VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT) != 0u;
         VmaAllocationCreateInfo const vma_allocation_create_info = {
             .flags = vma_allocation_flags,
             .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-            .requiredFlags = {},
+            .requiredFlags = host_readable ? static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) : VkMemoryPropertyFlags{},
             .preferredFlags = {},
             .memoryTypeBits = std::numeric_limits<u32>::max(),
             .pool = nullptr,
@@ -294,6 +476,7 @@ namespace ff
             .priority = 0.5f,
         };
         CHECK_VK_RESULT(vmaCreateBuffer(allocator, &vk_buffer_create_info, &vma_allocation_create_info, &buffer->buffer, &buffer->allocation, &vma_allocation_info));
+        allocation_statistics.buffer_allocations += 1;
 
         VkBufferDeviceAddressInfo const buffer_device_address_info = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
@@ -376,6 +559,7 @@ namespace ff
         };
 
         CHECK_VK_RESULT(vmaCreateImage(allocator, &image_create_info, &vma_allocation_create_info, &image->image, &image->allocation, nullptr));
+        allocation_statistics.image_allocations += 1;
 
         VkImageViewCreateInfo image_view_create_info{
             .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -468,6 +652,379 @@ namespace ff
         return id;
     }
 
+    auto Device::allocate_staging(usize size, usize alignment) -> std::optional<StagingAllocation>
+    {
+        if (size == 0 || size > STAGING_RING_SIZE)
+        {
+            BACKEND_LOG(fmt::format("[ERROR][Device::allocate_staging()] Invalid staging allocation size {}", size));
+            throw std::runtime_error("[ERROR][Device::allocate_staging()] Invalid staging allocation size");
+        }
+        while (true)
+        {
+            // Ring is empty, restart at the beginning so that the whole ring is available
+            if (staging_ring_allocated == staging_ring_released)
+            {
+                staging_ring_allocated = (staging_ring_allocated + STAGING_RING_SIZE - 1) / STAGING_RING_SIZE * STAGING_RING_SIZE;
+                staging_ring_submitted = staging_ring_allocated;
+                staging_ring_released = staging_ring_allocated;
+            }
+            u64 const head = staging_ring_allocated % STAGING_RING_SIZE;
+            u64 offset = (head + alignment - 1) / alignment * alignment;
+            // Allocations never straddle the end of the ring, skip the remainder and start over at the beginning
+            if (offset + size > STAGING_RING_SIZE)
+            {
+                offset = 0;
+            }
+            u64 const padding = offset >= head ? offset - head : STAGING_RING_SIZE - head;
+            u64 const used = staging_ring_allocated - staging_ring_released;
+            if (used + padding + size <= STAGING_RING_SIZE)
+            {
+                staging_ring_allocated += padding + size;
+                allocation_statistics.staging_allocations += 1;
+                allocation_statistics.staging_bytes += size;
+                return StagingAllocation{
+                    .buffer_id = staging_ring_buffer,
+                    .offset = static_cast<usize>(offset),
+                    .size = size,
+                    .host_address = staging_ring_host_address + offset,
+                };
+            }
+            if (staging_ring_regions.empty())
+            {
+                return std::nullopt;
+            }
+            /// NOTE: Ring is full, wait for the oldest submitted region to be retired by the GPU.
+            u64 const wait_value = staging_ring_regions.front().cpu_timeline_value;
+            VkSemaphore const wait_semaphore = get_gpu_semaphore(staging_ring_regions.front().queue);
+            VkSemaphoreWaitInfo const wait_info = {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                .pNext = nullptr,
+                .flags = {},
+                .semaphoreCount = 1,
+                .pSemaphores = &wait_semaphore,
+                .pValues = &wait_value,
+            };
+            CHECK_VK_RESULT(vkWaitSemaphores(vulkan_device, &wait_info, std::numeric_limits<u64>::max()));
+            release_staging_ring_regions();
+        }
+    }
+
+    auto Device::get_staging_ring_size() const -> usize
+    {
+        return STAGING_RING_SIZE;
+    }
+
+    auto Device::reset_allocation_statistics() -> AllocationStatistics
+    {
+        AllocationStatistics const ret = allocation_statistics;
+        allocation_statistics = {};
+        return ret;
+    }
+
+    void Device::begin_gpu_profiler_frame(u32 frame_slot)
+    {
+        if (timestamp_query_pool == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        if (frame_slot >= GPU_PROFILER_FRAME_SLOTS)
+        {
+            BACKEND_LOG(fmt::format("[ERROR][Device::begin_gpu_profiler_frame()] Frame slot {} out of range, there are {} slots", frame_slot, GPU_PROFILER_FRAME_SLOTS));
+            throw std::runtime_error("[ERROR][Device::begin_gpu_profiler_frame()] Frame slot out of range");
+        }
+        GpuProfilerFrameSlot & slot = gpu_profiler_frame_slots.at(frame_slot);
+        u32 const first_query = frame_slot * MAX_GPU_ZONES_PER_FRAME * 2;
+        resolved_gpu_zones.clear();
+        if (!slot.zones.empty())
+        {
+            /// NOTE: Each query returns its value followed by its availability. Zones which were recorded but never
+            //        submitted stay unavailable and are skipped.
+            u32 const query_count = static_cast<u32>(slot.zones.size()) * 2;
+            std::vector<u64> query_results(query_count * 2);
+            VkResult const result = vkGetQueryPoolResults(
+                vulkan_device, timestamp_query_pool, first_query, query_count,
+                query_results.size() * sizeof(u64), query_results.data(), sizeof(u64) * 2,
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            if (result != VK_SUCCESS && result != VK_NOT_READY)
+            {
+                CHECK_VK_RESULT(result);
+            }
+            // Zones recorded multiple times in a frame are summed
+            u64 const valid_mask = timestamp_valid_bits >= 64 ? ~0ull : ((1ull << timestamp_valid_bits) - 1ull);
+            std::vector<std::pair<std::string_view, f32>> frame_zones_ms = {};
+            for (GpuZoneRecord const & zone : slot.zones)
+            {
+                u32 const begin_result = (zone.begin_query - first_query) * 2;
+                bool const available = query_results.at(begin_result + 1) != 0 && query_results.at(begin_result + 3) != 0;
+                if (!available)
+                {
+                    continue;
+                }
+                u64 const ticks = (query_results.at(begin_result + 2) - query_results.at(begin_result)) & valid_mask;
+                f32 const zone_ms = static_cast<f32>(static_cast<f64>(ticks) * timestamp_period / 1'000'000.0);
+                auto const frame_zone_it = std::find_if(frame_zones_ms.begin(), frame_zones_ms.end(),
+                                                        [&](auto const & frame_zone) { return frame_zone.first == zone.name; });
+                if (frame_zone_it == frame_zones_ms.end())
+                {
+                    frame_zones_ms.push_back({zone.name, zone_ms});
+                }
+                else
+                {
+                    frame_zone_it->second += zone_ms;
+                }
+            }
+            for (auto const & [zone_name, zone_ms] : frame_zones_ms)
+            {
+                auto const timing_it = std::find_if(gpu_zone_timings.begin(), gpu_zone_timings.end(),
+                                                    [&](GpuZoneTiming const & timing) { return timing.name == zone_name; });
+                usize const zone_index = static_cast<usize>(std::distance(gpu_zone_timings.begin(), timing_it));
+                if (timing_it == gpu_zone_timings.end())
+                {
+                    gpu_zone_timings.push_back({.name = std::string(zone_name)});
+                    gpu_zone_histories.push_back({});
+                }
+                GpuZoneHistory & history = gpu_zone_histories.at(zone_index);
+                history.samples_ms.at(history.next_sample) = zone_ms;
+                history.next_sample = (history.next_sample + 1) % GPU_PROFILER_WINDOW_SIZE;
+                history.sample_count = std::min(history.sample_count + 1, GPU_PROFILER_WINDOW_SIZE);
+                f32 window_sum_ms = 0.0f;
+                for (u32 sample = 0; sample < history.sample_count; sample++)
+                {
+                    window_sum_ms += history.samples_ms.at(sample);
+                }
+                gpu_zone_timings.at(zone_index).last_ms = zone_ms;
+                gpu_zone_timings.at(zone_index).average_ms = window_sum_ms / static_cast<f32>(history.sample_count);
+                resolved_gpu_zones.push_back(gpu_zone_timings.at(zone_index));
+            }
+        }
+        vkResetQueryPool(vulkan_device, timestamp_query_pool, first_query, MAX_GPU_ZONES_PER_FRAME * 2);
+        slot.zones.clear();
+        active_gpu_profiler_frame_slot = frame_slot;
+    }
+
+    auto Device::get_gpu_zone_timings() const -> std::span<GpuZoneTiming const>
+    {
+        return gpu_zone_timings;
+    }
+
+    auto Device::get_resolved_gpu_zones() const -> std::span<GpuZoneTiming const>
+    {
+        return resolved_gpu_zones;
+    }
+
+    auto Device::get_pipeline_cache_file_header() -> PipelineCacheFileHeader
+    {
+        VkPhysicalDeviceIDProperties id_properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+            .pNext = nullptr,
+        };
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &id_properties,
+        };
+        vkGetPhysicalDeviceProperties2(vulkan_physical_device, &properties);
+
+        PipelineCacheFileHeader header = {
+            .vendor_id = properties.properties.vendorID,
+            .device_id = properties.properties.deviceID,
+            .driver_version = properties.properties.driverVersion,
+        };
+        std::copy_n(id_properties.deviceUUID, VK_UUID_SIZE, header.device_uuid.begin());
+        std::copy_n(id_properties.driverUUID, VK_UUID_SIZE, header.driver_uuid.begin());
+        std::copy_n(properties.properties.pipelineCacheUUID, VK_UUID_SIZE, header.pipeline_cache_uuid.begin());
+        return header;
+    }
+
+    void Device::create_pipeline_cache()
+    {
+        PipelineCacheFileHeader const expected_header = get_pipeline_cache_file_header();
+        std::vector<std::byte> initial_data = {};
+        std::string_view skip_reason = {};
+        std::ifstream file(pipeline_cache_path, std::ios::binary);
+        PipelineCacheFileHeader file_header = {};
+        if (!file)
+        {
+            skip_reason = "file not found";
+        }
+        else if (!file.read(reinterpret_cast<char *>(&file_header), sizeof(PipelineCacheFileHeader)))
+        {
+            skip_reason = "truncated header";
+        }
+        else if (file_header.magic != PIPELINE_CACHE_FILE_MAGIC || file_header.version != PIPELINE_CACHE_FILE_VERSION)
+        {
+            skip_reason = "unknown format";
+        }
+        else if (file_header.vendor_id != expected_header.vendor_id ||
+                 file_header.device_id != expected_header.device_id ||
+                 file_header.driver_version != expected_header.driver_version ||
+                 file_header.device_uuid != expected_header.device_uuid ||
+                 file_header.driver_uuid != expected_header.driver_uuid ||
+                 file_header.pipeline_cache_uuid != expected_header.pipeline_cache_uuid)
+        {
+            skip_reason = "written for a different device or driver";
+        }
+        else
+        {
+            initial_data.resize(file_header.data_size);
+            if (!file.read(reinterpret_cast<char *>(initial_data.data()), static_cast<std::streamsize>(initial_data.size())))
+            {
+                skip_reason = "truncated data";
+                initial_data.clear();
+            }
+        }
+        if (!skip_reason.empty())
+        {
+            BACKEND_LOG(fmt::format("[INFO][Device::create_pipeline_cache()] Pipeline cache \"{}\" not used: {}", pipeline_cache_path.string(), skip_reason));
+        }
+
+        VkPipelineCacheCreateInfo const pipeline_cache_create_info = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .initialDataSize = initial_data.size(),
+            .pInitialData = initial_data.data(),
+        };
+        CHECK_VK_RESULT(vkCreatePipelineCache(vulkan_device, &pipeline_cache_create_info, nullptr, &pipeline_cache));
+        if (!initial_data.empty())
+        {
+            BACKEND_LOG(fmt::format("[INFO][Device::create_pipeline_cache()] Loaded pipeline cache \"{}\" ({}B)", pipeline_cache_path.string(), initial_data.size()));
+        }
+    }
+
+    void Device::save_pipeline_cache()
+    {
+        PipelineCacheFileHeader header = get_pipeline_cache_file_header();
+        usize data_size = {};
+        CHECK_VK_RESULT(vkGetPipelineCacheData(vulkan_device, pipeline_cache, &data_size, nullptr));
+        std::vector<std::byte> data(data_size);
+        CHECK_VK_RESULT(vkGetPipelineCacheData(vulkan_device, pipeline_cache, &data_size, data.data()));
+        header.data_size = data_size;
+
+        /// NOTE: Written next to the cache and renamed over it, so that an interrupted write or a second instance
+        //        saving at the same time never leaves a partially written cache behind.
+        std::filesystem::path temporary_path = pipeline_cache_path;
+        temporary_path += ".tmp";
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<char const *>(&header), sizeof(PipelineCacheFileHeader));
+            file.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data_size));
+            if (!file.good())
+            {
+                BACKEND_LOG(fmt::format("[WARN][Device::save_pipeline_cache()] Could not write pipeline cache \"{}\"", temporary_path.string()));
+                return;
+            }
+        }
+        std::error_code error = {};
+        std::filesystem::rename(temporary_path, pipeline_cache_path, error);
+        if (error)
+        {
+            BACKEND_LOG(fmt::format("[WARN][Device::save_pipeline_cache()] Could not replace pipeline cache \"{}\": {}", pipeline_cache_path.string(), error.message()));
+            return;
+        }
+        BACKEND_LOG(fmt::format("[INFO][Device::save_pipeline_cache()] Saved pipeline cache \"{}\" ({}B)", pipeline_cache_path.string(), data_size));
+    }
+
+    auto Device::allocate_gpu_zone(std::string_view name) -> std::optional<u32>
+    {
+        if (!active_gpu_profiler_frame_slot.has_value())
+        {
+            return std::nullopt;
+        }
+        GpuProfilerFrameSlot & slot = gpu_profiler_frame_slots.at(active_gpu_profiler_frame_slot.value());
+        if (slot.zones.size() >= MAX_GPU_ZONES_PER_FRAME)
+        {
+            return std::nullopt;
+        }
+        u32 const begin_query = (active_gpu_profiler_frame_slot.value() * MAX_GPU_ZONES_PER_FRAME + static_cast<u32>(slot.zones.size())) * 2;
+        slot.zones.push_back({.name = std::string(name), .begin_query = begin_query});
+        return begin_query;
+    }
+
+    void Device::release_staging_ring_regions()
+    {
+        /// NOTE: Regions are released in submission order even when they were submitted to different queues, a
+        //        region finished early on one queue waits for the older regions of the other queue.
+        std::array<std::optional<u64>, QUEUE_TYPE_COUNT> gpu_timeline_values = {};
+        while (!staging_ring_regions.empty())
+        {
+            u32 const queue_index = static_cast<u32>(staging_ring_regions.front().queue);
+            if (!gpu_timeline_values.at(queue_index).has_value())
+            {
+                gpu_timeline_values.at(queue_index) = get_completed_timeline_value(staging_ring_regions.front().queue);
+            }
+            if (staging_ring_regions.front().cpu_timeline_value > gpu_timeline_values.at(queue_index).value())
+            {
+                break;
+            }
+            staging_ring_released = staging_ring_regions.front().allocated_end;
+            staging_ring_regions.pop();
+        }
+    }
+
+    auto Device::acquire_command_buffer(QueueType queue) -> std::pair<u32, VkCommandBuffer>
+    {
+        QueueType const resolved_queue = resolve_queue_type(queue);
+        std::optional<u32> & active_command_pool_index = active_command_pool_indices.at(static_cast<u32>(resolved_queue));
+        std::vector<u32> & free_pool_indices = free_command_pool_indices.at(static_cast<u32>(resolved_queue));
+        if (!active_command_pool_index.has_value())
+        {
+            if (!free_pool_indices.empty())
+            {
+                active_command_pool_index = free_pool_indices.back();
+                free_pool_indices.pop_back();
+            }
+            else
+            {
+                VkCommandPoolCreateInfo const command_pool_create_info = {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                    .pNext = nullptr,
+                    .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                    .queueFamilyIndex = get_queue_family_index(resolved_queue),
+                };
+                VkCommandPool pool = {};
+                CHECK_VK_RESULT(vkCreateCommandPool(vulkan_device, &command_pool_create_info, nullptr, &pool));
+                allocation_statistics.command_pool_allocations += 1;
+                active_command_pool_index = static_cast<u32>(command_pools.size());
+                command_pools.push_back({.pool = pool, .queue = resolved_queue});
+            }
+        }
+        u32 const pool_index = active_command_pool_index.value();
+        CommandPool & command_pool = command_pools.at(pool_index);
+        if (command_pool.used_buffer_count == command_pool.buffers.size())
+        {
+            VkCommandBufferAllocateInfo const command_buffer_allocate_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = command_pool.pool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+            VkCommandBuffer buffer = {};
+            CHECK_VK_RESULT(vkAllocateCommandBuffers(vulkan_device, &command_buffer_allocate_info, &buffer));
+            allocation_statistics.command_buffer_allocations += 1;
+            command_pool.buffers.push_back(buffer);
+        }
+        VkCommandBuffer const buffer = command_pool.buffers.at(command_pool.used_buffer_count);
+        command_pool.used_buffer_count += 1;
+        command_pool.acquired_buffer_count += 1;
+        return {pool_index, buffer};
+    }
+
+    void Device::release_command_buffer(u32 pool_index)
+    {
+        CommandPool & command_pool = command_pools.at(pool_index);
+        command_pool.acquired_buffer_count -= 1;
+        command_pool.cpu_timeline_value = std::max(command_pool.cpu_timeline_value, get_cpu_timeline_value(command_pool.queue));
+        if (command_pool.retired && command_pool.acquired_buffer_count == 0)
+        {
+            command_pool_zombies.push({
+                .queue = command_pool.queue,
+                .pool_index = pool_index,
+                .cpu_timeline_value = command_pool.cpu_timeline_value,
+            });
+        }
+    }
+
     auto Device::create_swapchain_image(VkImage swapchain_image, CreateImageInfo const & info) -> ImageId
     {
         ImageId const id = resource_table->images.create_slot();
@@ -580,7 +1137,55 @@ namespace ff
 
     void Device::submit(SubmitInfo const & info)
     {
-        main_cpu_timeline_value += 1;
+        QueueType const queue = resolve_queue_type(info.queue);
+        u64 & cpu_timeline_value = get_cpu_timeline_value(queue);
+        cpu_timeline_value += 1;
+        if (staging_ring_allocated != staging_ring_submitted)
+        {
+            staging_ring_regions.push({
+                .queue = queue,
+                .allocated_end = staging_ring_allocated,
+                .cpu_timeline_value = cpu_timeline_value,
+            });
+            staging_ring_submitted = staging_ring_allocated;
+        }
+        /// NOTE: The timestamp command buffers come from the active pool of the queue, they have to be acquired
+        //        before the pool is retired below.
+        std::vector<VkCommandBuffer> submit_command_buffers = {};
+        std::vector<u32> timestamp_pool_indices = {};
+        bool const timed = queue_overlap_timing && submit_timestamp_query_pool != VK_NULL_HANDLE && queue != QueueType::COMPUTE && !free_submit_timing_slots.empty();
+        if (timed)
+        {
+            u32 const slot = free_submit_timing_slots.back();
+            free_submit_timing_slots.pop_back();
+            auto const [begin_pool_index, begin_buffer] = record_submit_timestamp(queue, slot * 2);
+            auto const [end_pool_index, end_buffer] = record_submit_timestamp(queue, slot * 2 + 1);
+            submit_command_buffers.reserve(info.command_buffers.size() + 2);
+            submit_command_buffers.push_back(begin_buffer);
+            submit_command_buffers.insert(submit_command_buffers.end(), info.command_buffers.begin(), info.command_buffers.end());
+            submit_command_buffers.push_back(end_buffer);
+            timestamp_pool_indices = {begin_pool_index, end_pool_index};
+            pending_submit_timings.push_back({
+                .queue = queue,
+                .cpu_timeline_value = cpu_timeline_value,
+                .begin_query = slot * 2,
+            });
+        }
+        std::optional<u32> & active_command_pool_index = active_command_pool_indices.at(static_cast<u32>(queue));
+        if (active_command_pool_index.has_value())
+        {
+            CommandPool & command_pool = command_pools.at(active_command_pool_index.value());
+            command_pool.retired = true;
+            if (command_pool.acquired_buffer_count == 0)
+            {
+                command_pool_zombies.push({
+                    .queue = queue,
+                    .pool_index = active_command_pool_index.value(),
+                    .cpu_timeline_value = cpu_timeline_value,
+                });
+            }
+            active_command_pool_index = std::nullopt;
+        }
         std::vector<VkSemaphore> submit_semaphore_waits = {};
         std::vector<VkPipelineStageFlags> submit_semaphore_wait_stages = {};
         std::vector<u64> submit_semaphore_wait_values = {};
@@ -601,8 +1206,8 @@ namespace ff
         std::vector<VkSemaphore> submit_semaphore_signals = {};
         std::vector<u64> submit_semaphore_signal_values = {};
         submit_semaphore_signals.reserve(info.signal_binary_semaphores.size() + info.signal_timeline_semaphores.size() + 1);
-        submit_semaphore_signals.push_back(main_gpu_semaphore);
-        submit_semaphore_signal_values.push_back(main_cpu_timeline_value);
+        submit_semaphore_signals.push_back(get_gpu_semaphore(queue));
+        submit_semaphore_signal_values.push_back(cpu_timeline_value);
         for (u32 signal_binary_sema_idx = 0; signal_binary_sema_idx < info.signal_binary_semaphores.size(); signal_binary_sema_idx++)
         {
             submit_semaphore_signals.push_back(info.signal_binary_semaphores[signal_binary_sema_idx]);
@@ -629,13 +1234,129 @@ namespace ff
             .waitSemaphoreCount = static_cast<u32>(submit_semaphore_waits.size()),
             .pWaitSemaphores = submit_semaphore_waits.data(),
             .pWaitDstStageMask = submit_semaphore_wait_stages.data(),
-            .commandBufferCount = static_cast<u32>(info.command_buffers.size()),
-            .pCommandBuffers = info.command_buffers.data(),
+            .commandBufferCount = static_cast<u32>(timed ? submit_command_buffers.size() : info.command_buffers.size()),
+            .pCommandBuffers = timed ? submit_command_buffers.data() : info.command_buffers.data(),
             .signalSemaphoreCount = static_cast<u32>(submit_semaphore_signals.size()),
             .pSignalSemaphores = submit_semaphore_signals.data(),
         };
 
-        CHECK_VK_RESULT(vkQueueSubmit(main_queue, 1, &submit_info, VK_NULL_HANDLE));
+        CHECK_VK_RESULT(vkQueueSubmit(get_vk_queue(queue), 1, &submit_info, VK_NULL_HANDLE));
+        for (u32 const timestamp_pool_index : timestamp_pool_indices)
+        {
+            release_command_buffer(timestamp_pool_index);
+        }
+    }
+
+    auto Device::record_submit_timestamp(QueueType queue, u32 query) -> std::pair<u32, VkCommandBuffer>
+    {
+        auto const [pool_index, buffer] = acquire_command_buffer(queue);
+        VkCommandBufferBeginInfo const command_buffer_begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = {},
+        };
+        CHECK_VK_RESULT(vkBeginCommandBuffer(buffer, &command_buffer_begin_info));
+        vkCmdWriteTimestamp2(buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, submit_timestamp_query_pool, query);
+        CHECK_VK_RESULT(vkEndCommandBuffer(buffer));
+        return {pool_index, buffer};
+    }
+
+    void Device::resolve_submit_timings()
+    {
+        if (pending_submit_timings.empty() && unmatched_transfer_intervals.empty())
+        {
+            return;
+        }
+        // Read before the queries so that every main submit up to this value is already available below
+        u64 const main_gpu_timeline_value = get_completed_timeline_value(QueueType::MAIN);
+        std::vector<SubmitTiming> still_pending_submit_timings = {};
+        for (SubmitTiming const & timing : pending_submit_timings)
+        {
+            std::array<u64, 4> query_results = {};
+            VkResult const result = vkGetQueryPoolResults(
+                vulkan_device, submit_timestamp_query_pool, timing.begin_query, 2,
+                sizeof(query_results), query_results.data(), sizeof(u64) * 2,
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            if (result != VK_SUCCESS && result != VK_NOT_READY)
+            {
+                CHECK_VK_RESULT(result);
+            }
+            if (query_results.at(1) == 0 || query_results.at(3) == 0)
+            {
+                still_pending_submit_timings.push_back(timing);
+                continue;
+            }
+            vkResetQueryPool(vulkan_device, submit_timestamp_query_pool, timing.begin_query, 2);
+            free_submit_timing_slots.push_back(timing.begin_query / 2);
+            if (timing.queue == QueueType::MAIN)
+            {
+                main_submit_intervals.push_back({query_results.at(0), query_results.at(2)});
+                if (main_submit_intervals.size() > MAX_MAIN_SUBMIT_INTERVALS)
+                {
+                    main_submit_intervals.pop_front();
+                }
+            }
+            else
+            {
+                /// NOTE: Main submits recorded after this point start after the transfer finished, the ones already
+                //        submitted may still be running and have to finish before the overlap can be measured.
+                unmatched_transfer_intervals.push_back({
+                    .begin = query_results.at(0),
+                    .end = query_results.at(2),
+                    .main_cpu_timeline_value = main_cpu_timeline_value,
+                });
+            }
+        }
+        pending_submit_timings = std::move(still_pending_submit_timings);
+
+        std::vector<std::pair<u64, u64>> merged_main_intervals(main_submit_intervals.begin(), main_submit_intervals.end());
+        std::sort(merged_main_intervals.begin(), merged_main_intervals.end());
+        usize merged_count = 0;
+        for (auto const & interval : merged_main_intervals)
+        {
+            if (merged_count > 0 && interval.first <= merged_main_intervals.at(merged_count - 1).second)
+            {
+                merged_main_intervals.at(merged_count - 1).second = std::max(merged_main_intervals.at(merged_count - 1).second, interval.second);
+            }
+            else
+            {
+                merged_main_intervals.at(merged_count++) = interval;
+            }
+        }
+        merged_main_intervals.resize(merged_count);
+
+        auto const ticks_to_ms = [&](u64 ticks) { return static_cast<f32>(static_cast<f64>(ticks) * timestamp_period / 1'000'000.0); };
+        std::erase_if(unmatched_transfer_intervals, [&](TransferInterval const & transfer)
+        {
+            if (transfer.main_cpu_timeline_value > main_gpu_timeline_value)
+            {
+                return false;
+            }
+            u64 overlapped_ticks = 0;
+            for (auto const & [main_begin, main_end] : merged_main_intervals)
+            {
+                u64 const begin = std::max(main_begin, transfer.begin);
+                u64 const end = std::min(main_end, transfer.end);
+                overlapped_ticks += end > begin ? end - begin : 0;
+            }
+            queue_overlap_statistics.transfer_submit_count += 1;
+            queue_overlap_statistics.transfer_busy_ms += ticks_to_ms(transfer.end > transfer.begin ? transfer.end - transfer.begin : 0);
+            queue_overlap_statistics.transfer_overlapped_ms += ticks_to_ms(overlapped_ticks);
+            return true;
+        });
+    }
+
+    auto Device::reset_queue_overlap_statistics() -> QueueOverlapStatistics
+    {
+        QueueOverlapStatistics const ret = queue_overlap_statistics;
+        queue_overlap_statistics = {};
+        return ret;
+    }
+
+    void Device::set_queue_overlap_timing(bool enabled)
+    {
+        queue_overlap_timing = enabled;
     }
 
     void Device::destroy_buffer(BufferId id)
@@ -679,17 +1400,23 @@ namespace ff
 
     void Device::cleanup_resources()
     {
-        u64 gpu_timeline_value = {};
-        CHECK_VK_RESULT(vkGetSemaphoreCounterValue(vulkan_device, main_gpu_semaphore, &gpu_timeline_value));
-        while (!command_buffer_zombies.empty())
+        u64 const gpu_timeline_value = get_completed_timeline_value(QueueType::MAIN);
+        release_staging_ring_regions();
+        resolve_submit_timings();
+        while (!command_pool_zombies.empty())
         {
-            if (command_buffer_zombies.front().cpu_timeline_value > gpu_timeline_value)
+            if (command_pool_zombies.front().cpu_timeline_value > get_completed_timeline_value(command_pool_zombies.front().queue))
             {
                 break;
             }
-            vkFreeCommandBuffers(vulkan_device, command_buffer_zombies.front().pool, 1, &command_buffer_zombies.front().buffer);
-            vkDestroyCommandPool(vulkan_device, command_buffer_zombies.front().pool, nullptr);
-            command_buffer_zombies.pop();
+            u32 const pool_index = command_pool_zombies.front().pool_index;
+            CommandPool & command_pool = command_pools.at(pool_index);
+            CHECK_VK_RESULT(vkResetCommandPool(vulkan_device, command_pool.pool, {}));
+            command_pool.used_buffer_count = 0;
+            command_pool.cpu_timeline_value = 0;
+            command_pool.retired = false;
+            free_command_pool_indices.at(static_cast<u32>(command_pool.queue)).push_back(pool_index);
+            command_pool_zombies.pop();
         }
 
         while (!pipeline_zombies.empty())
@@ -751,11 +1478,33 @@ namespace ff
 
     Device::~Device()
     {
-        cleanup_resources();
         wait_idle();
+        destroy_buffer(staging_ring_buffer);
+        cleanup_resources();
+        for (CommandPool const & command_pool : command_pools)
+        {
+            vkDestroyCommandPool(vulkan_device, command_pool.pool, nullptr);
+        }
         resource_table.reset();
         vmaDestroyAllocator(allocator);
         vkDestroySemaphore(vulkan_device, main_gpu_semaphore, nullptr);
+        for (AsyncQueue const & async_queue : async_queues)
+        {
+            if (async_queue.family_index != -1)
+            {
+                vkDestroySemaphore(vulkan_device, async_queue.gpu_semaphore, nullptr);
+            }
+        }
+        if (timestamp_query_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(vulkan_device, timestamp_query_pool, nullptr);
+        }
+        if (submit_timestamp_query_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(vulkan_device, submit_timestamp_query_pool, nullptr);
+        }
+        save_pipeline_cache();
+        vkDestroyPipelineCache(vulkan_device, pipeline_cache, nullptr);
         vkDestroyDevice(vulkan_device, nullptr);
         BACKEND_LOG("[INFO][Device::~Device()] Device destroyed")
     }
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <span>
+#include <deque>
 #include <queue>
+#include <filesystem>
+#include <string_view>
+#include <optional>
+#include <utility>
 
 #include "core.hpp"
 #include "instance.hpp"
@@ -10,6 +15,17 @@
 
 namespace ff
 {
+    /// NOTE: TRANSFER and COMPUTE run on their own queue when the device has a queue family dedicated to them
+    //        (transfer only, or compute without graphics). Otherwise they are aliases of MAIN and share its queue,
+    //        timeline and command pools, so the code using them does not need to care.
+    enum struct QueueType
+    {
+        MAIN,
+        TRANSFER,
+        COMPUTE,
+    };
+    static constexpr u32 QUEUE_TYPE_COUNT = 3;
+
     struct TimelineSemaphoreInfo
     {
         VkSemaphore semaphore;
@@ -17,6 +33,7 @@ namespace ff
     };
     struct SubmitInfo
     {
+        QueueType queue = QueueType::MAIN;
         std::span<VkCommandBuffer> command_buffers = {};
         std::span<VkSemaphore> wait_binary_semaphores = {};
         std::span<TimelineSemaphoreInfo> wait_timeline_semaphores = {};
@@ -24,10 +41,10 @@ namespace ff
         std::span<TimelineSemaphoreInfo> signal_timeline_semaphores = {};
     };
 
-    struct CommandBufferZombie
+    struct CommandPoolZombie
     {
-        VkCommandPool pool = {};
-        VkCommandBuffer buffer = {};
+        QueueType queue = {};
+        u32 pool_index = {};
         u64 cpu_timeline_value = {};
     };
     struct PipelineZombie
@@ -51,28 +68,114 @@ namespace ff
         SamplerId sampler_id = {};
         u64 cpu_timeline_value = {};
     };
+
+    struct StagingAllocation
+    {
+        BufferId buffer_id = {};
+        usize offset = {};
+        usize size = {};
+        std::byte * host_address = {};
+    };
+
+    // Range of the staging ring that is in use until the timeline of queue reaches cpu_timeline_value
+    struct StagingRingRegion
+    {
+        QueueType queue = {};
+        u64 allocated_end = {};
+        u64 cpu_timeline_value = {};
+    };
+
+    struct GpuZoneTiming
+    {
+        std::string name = {};
+        f32 last_ms = {};
+        // Averaged over the last Device::GPU_PROFILER_WINDOW_SIZE frames the zone was recorded in
+        f32 average_ms = {};
+    };
+
+    struct AllocationStatistics
+    {
+        u32 buffer_allocations = {};
+        u32 image_allocations = {};
+        u32 staging_allocations = {};
+        usize staging_bytes = {};
+        u32 command_pool_allocations = {};
+        u32 command_buffer_allocations = {};
+    };
+
+    struct QueueOverlapStatistics
+    {
+        u32 transfer_submit_count = {};
+        // GPU time the transfer queue spent executing submits
+        f32 transfer_busy_ms = {};
+        // Part of transfer_busy_ms during which the main queue was executing work as well
+        f32 transfer_overlapped_ms = {};
+    };
     struct Device
     {
       public:
         VkPhysicalDeviceProperties2 physical_device_properties = {};
         VkQueue main_queue = {};
         VkSemaphore main_gpu_semaphore = {};
+        // Number of frames the gpu zone timings are averaged over
+        constexpr static u32 GPU_PROFILER_WINDOW_SIZE = 64u;
 
         Device() = default;
-        Device(std::shared_ptr<Instance> instance);
+        Device(std::shared_ptr<Instance> instance, std::filesystem::path pipeline_cache_path = "pipeline_cache.ffpc");
 
         auto info_image(ImageId image_id) -> CreateImageInfo &;
         auto info_buffer(BufferId buffer_id) -> CreateBufferInfo &;
         auto get_buffer_host_pointer(BufferId buffer_id) -> void *;
         auto get_buffer_device_address(BufferId buffer_id) -> VkDeviceAddress;
+        // True when the queue type runs on its own queue instead of aliasing the main one
+        auto has_dedicated_queue(QueueType queue) const -> bool;
+        auto get_queue_family_index(QueueType queue) const -> u32;
+        // Timeline value signaled by the last submit to the queue, waiting on it consumes everything submitted so far
+        auto get_last_submit_timeline(QueueType queue) const -> TimelineSemaphoreInfo;
+        // Highest timeline value the GPU has finished on the queue
+        auto get_completed_timeline_value(QueueType queue) const -> u64;
 
         auto create_buffer(CreateBufferInfo const & info) -> BufferId;
         auto create_image(CreateImageInfo const & info) -> ImageId;
         auto create_sampler(CreateSamplerInfo const & info) -> SamplerId;
+        /// NOTE: Sub-allocates from the persistent staging ring. All allocations made between two submits are recycled
+        //        once the later of those submits finishes on the GPU, so the staging memory must be consumed by the next
+        //        submit, whichever queue it goes to. Blocks on in flight work when the ring is full, returns std::nullopt
+        //        when the ring is only occupied by allocations that were not submitted yet (the caller should submit
+        //        and try again).
+        auto allocate_staging(usize size, usize alignment = 16) -> std::optional<StagingAllocation>;
+        auto get_staging_ring_size() const -> usize;
+        // Returns the allocation counters accumulated since the previous call and resets them.
+        auto reset_allocation_statistics() -> AllocationStatistics;
+        /// NOTE: While queue overlap timing is enabled every submit to the main and transfer queue is bracketed by
+        //        timestamps when the transfer queue is dedicated and both families support timestamps, otherwise the
+        //        statistics stay empty. A transfer submit is counted once the main queue finished everything that was
+        //        submitted before the transfer completed. Returns the statistics accumulated since the previous call
+        //        and resets them.
+        auto reset_queue_overlap_statistics() -> QueueOverlapStatistics;
+        // Disabled by default, the timestamp command buffers cost two extra command buffers per submit
+        void set_queue_overlap_timing(bool enabled);
+        /// NOTE: Destruction is tied to the main timeline. Resources written on another queue must be acquired by
+        //        a main queue submit which waited for that queue before they are destroyed.
         void destroy_buffer(BufferId id);
         void destroy_image(ImageId id);
         void destroy_sampler(SamplerId id);
 
+        /// NOTE: GPU timestamp profiler. Every frame slot owns a range of timestamp queries. Starting a frame reads
+        //        back the zones the slot recorded the last time it was used and resets its queries from the host, so
+        //        the caller must guarantee that the GPU finished that frame. Zones are recorded by
+        //        CommandBuffer::begin_zone() and end_zone() into the slot of the current frame.
+        void begin_gpu_profiler_frame(u32 frame_slot);
+        // Zones in the order they were first recorded, empty when the main queue does not support timestamps
+        auto get_gpu_zone_timings() const -> std::span<GpuZoneTiming const>;
+        // Zones of the frame read back by the last begin_gpu_profiler_frame() call, empty if there was none
+        auto get_resolved_gpu_zones() const -> std::span<GpuZoneTiming const>;
+
+        /// NOTE: All pipelines are created through a pipeline cache which is loaded from pipeline_cache_path when the
+        //        file was written for the same device, driver version and cache UUID. Saving is also done on destruction,
+        //        calling this earlier keeps the cache when the application does not shut down cleanly.
+        void save_pipeline_cache();
+
         void submit(SubmitInfo const & info);
         void cleanup_resources();
         void wait_idle();
@@ -88,6 +191,12 @@ namespace ff
         constexpr static u32 MAX_BUFFERS = 1000u;
         constexpr static u32 MAX_IMAGES = 1000u;
         constexpr static u32 MAX_SAMPLERS = 100u;
+        constexpr static usize STAGING_RING_SIZE = 128u * 1024u * 1024u;
+        constexpr static u32 GPU_PROFILER_FRAME_SLOTS = 4u;
+        constexpr static u32 MAX_GPU_ZONES_PER_FRAME = 64u;
+        constexpr static u32 SUBMIT_TIMING_SLOTS = 64u;
+        // Resolved main queue submits kept around to intersect the transfer submits with
+        constexpr static u32 MAX_MAIN_SUBMIT_INTERVALS = 256u;
         std::shared_ptr<Instance> instance;
 
         std::unique_ptr<GpuResourceTable> resource_table = {};
@@ -103,15 +212,138 @@ namespace ff
 
         std::queue<ImageZombie> image_zombies = {};
         std::queue<BufferZombie> buffer_zombies = {};
-        std::queue<CommandBufferZombie> command_buffer_zombies = {};
+        std::queue<CommandPoolZombie> command_pool_zombies = {};
         std::queue<PipelineZombie> pipeline_zombies = {};
         std::queue<SamplerZombie> sampler_zombies = {};
 
+        /// NOTE: The ring is addressed by monotonically growing byte counters, the offset into the buffer is the
+        //        counter modulo STAGING_RING_SIZE. Padding skipped when wrapping around counts as allocated.
+        BufferId staging_ring_buffer = {};
+        std::byte * staging_ring_host_address = {};
+        u64 staging_ring_allocated = {};
+        u64 staging_ring_submitted = {};
+        u64 staging_ring_released = {};
+        std::queue<StagingRingRegion> staging_ring_regions = {};
+        AllocationStatistics allocation_statistics = {};
+
+        struct GpuZoneRecord
+        {
+            std::string name = {};
+            // The end timestamp is written into the following query
+            u32 begin_query = {};
+        };
+        struct GpuProfilerFrameSlot
+        {
+            std::vector<GpuZoneRecord> zones = {};
+        };
+        struct GpuZoneHistory
+        {
+            std::array<f32, GPU_PROFILER_WINDOW_SIZE> samples_ms = {};
+            u32 sample_count = {};
+            u32 next_sample = {};
+        };
+        VkQueryPool timestamp_query_pool = {};
+        // Nanoseconds per timestamp tick
+        f32 timestamp_period = {};
+        u32 timestamp_valid_bits = {};
+        std::array<GpuProfilerFrameSlot, GPU_PROFILER_FRAME_SLOTS> gpu_profiler_frame_slots = {};
+        std::optional<u32> active_gpu_profiler_frame_slot = {};
+        // Indexed in parallel
+        std::vector<GpuZoneTiming> gpu_zone_timings = {};
+        std::vector<GpuZoneHistory> gpu_zone_histories = {};
+        std::vector<GpuZoneTiming> resolved_gpu_zones = {};
+
+        // "FFPC"
+        constexpr static u32 PIPELINE_CACHE_FILE_MAGIC = 0x43504646u;
+        constexpr static u32 PIPELINE_CACHE_FILE_VERSION = 1u;
+        // Written in front of the vkGetPipelineCacheData() blob
+        struct PipelineCacheFileHeader
+        {
+            u32 magic = PIPELINE_CACHE_FILE_MAGIC;
+            u32 version = PIPELINE_CACHE_FILE_VERSION;
+            u32 vendor_id = {};
+            u32 device_id = {};
+            u32 driver_version = {};
+            std::array<u8, VK_UUID_SIZE> device_uuid = {};
+            std::array<u8, VK_UUID_SIZE> driver_uuid = {};
+            std::array<u8, VK_UUID_SIZE> pipeline_cache_uuid = {};
+            u64 data_size = {};
+        };
+        std::filesystem::path pipeline_cache_path = {};
+        VkPipelineCache pipeline_cache = {};
+
+        /// NOTE: Command buffers are handed out from the active pool until the next submit. After that the pool
+        //        is retired and once every command buffer acquired from it is destroyed and the GPU reaches the
+        //        timeline value of the last one, the whole pool is reset and reused together with its buffers.
+        struct CommandPool
+        {
+            VkCommandPool pool = {};
+            std::vector<VkCommandBuffer> buffers = {};
+            u32 used_buffer_count = {};
+            u32 acquired_buffer_count = {};
+            u64 cpu_timeline_value = {};
+            bool retired = {};
+            QueueType queue = {};
+        };
+        std::vector<CommandPool> command_pools = {};
+        // Indexed by QueueType, only the entries of queues which are not aliased to the main queue are used
+        std::array<std::vector<u32>, QUEUE_TYPE_COUNT> free_command_pool_indices = {};
+        std::array<std::optional<u32>, QUEUE_TYPE_COUNT> active_command_pool_indices = {};
+
         i32 main_queue_family_index = {};
         u64 main_cpu_timeline_value = {};
+        struct AsyncQueue
+        {
+            VkQueue queue = {};
+            // -1 when the queue type is an alias of the main queue
+            i32 family_index = -1;
+            VkSemaphore gpu_semaphore = {};
+            u64 cpu_timeline_value = {};
+        };
+        // Indexed by QueueType, the MAIN entry is unused
+        std::array<AsyncQueue, QUEUE_TYPE_COUNT> async_queues = {};
+
+        struct SubmitTiming
+        {
+            QueueType queue = {};
+            u64 cpu_timeline_value = {};
+            // The end timestamp is written into the following query
+            u32 begin_query = {};
+        };
+        struct TransferInterval
+        {
+            u64 begin = {};
+            u64 end = {};
+            // Main queue submits up to this value may overlap the transfer
+            u64 main_cpu_timeline_value = {};
+        };
+        VkQueryPool submit_timestamp_query_pool = {};
+        std::vector<u32> free_submit_timing_slots = {};
+        std::vector<SubmitTiming> pending_submit_timings = {};
+        std::deque<std::pair<u64, u64>> main_submit_intervals = {};
+        std::vector<TransferInterval> unmatched_transfer_intervals = {};
+        QueueOverlapStatistics queue_overlap_statistics = {};
+        bool queue_overlap_timing = {};
 
         auto create_swapchain_image(VkImage swapchain_image, CreateImageInfo const & info) -> ImageId;
         void destroy_swapchain_image(ImageId id);
         auto get_physical_device() -> VkPhysicalDevice;
+        auto get_pipeline_cache_file_header() -> PipelineCacheFileHeader;
+        // Starts with an empty cache when the file is missing or was written for a different device or driver
+        void create_pipeline_cache();
+        // MAIN for queue types without a dedicated queue
+        auto resolve_queue_type(QueueType queue) const -> QueueType;
+        auto get_vk_queue(QueueType queue) const -> VkQueue;
+        auto get_gpu_semaphore(QueueType queue) const -> VkSemaphore;
+        auto get_cpu_timeline_value(QueueType queue) -> u64 &;
+        void release_staging_ring_regions();
+        // Reads back the timestamps of finished submits and intersects the transfer submits with the main ones
+        void resolve_submit_timings();
+        // Acquires a command buffer of the queue and records a single timestamp write into it
+        auto record_submit_timestamp(QueueType queue, u32 query) -> std::pair<u32, VkCommandBuffer>;
+        auto acquire_command_buffer(QueueType queue = QueueType::MAIN) -> std::pair<u32, VkCommandBuffer>;
+        void release_command_buffer(u32 pool_index);
+        // Returns the begin query of the zone, std::nullopt when the zone can not be timed
+        auto allocate_gpu_zone(std::string_view name) -> std::optional<u32>;
     };
 } // namespace ff
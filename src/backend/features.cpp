@@ -15,7 +15,7 @@ namespace ff
             .dualSrcBlend = VK_FALSE,
             .logicOp = VK_FALSE,
             .multiDrawIndirect = VK_TRUE, // Very useful for gpu driven rendering
-            .drawIndirectFirstInstance = VK_FALSE,
+            .drawIndirectFirstInstance = VK_TRUE, // Indirect draws locate their visible instances through the first instance
             .depthClamp = VK_TRUE, // NOTE(msakmary) need self for bikeshed if breaks ping me
             .depthBiasClamp = VK_FALSE,
             .fillModeNonSolid = VK_TRUE,
@@ -27,7 +27,7 @@ namespace ff
             .samplerAnisotropy = VK_TRUE, // Allows for anisotropic filtering.
             .textureCompressionETC2 = VK_FALSE,
             .textureCompressionASTC_LDR = VK_FALSE,
-            .textureCompressionBC = VK_FALSE,
+            .textureCompressionBC = VK_TRUE, // Cooked albedo and normal maps are BC1, BC3 or BC5 compressed.
             .occlusionQueryPrecise = VK_FALSE,
             .pipelineStatisticsQuery = VK_FALSE,
             .vertexPipelineStoresAndAtomics = VK_FALSE,
@@ -133,10 +133,14 @@ namespace ff
         this->chain = reinterpret_cast<void *>(&this->maintenance_features);
     }
 
-    void PhysicalDeviceExtensionList::initialize()
+    void PhysicalDeviceExtensionList::initialize(bool enable_swapchain)
     {
         this->size = 0;
-        this->data[size++] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        if (enable_swapchain)
+        {
+            this->data[size++] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        }
         this->data[size++] = {VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME};
+        this->data[size++] = {VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME};
     }
 } // namespace ff
\ No newline at end of file
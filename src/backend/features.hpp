@@ -27,6 +27,7 @@ namespace ff
         char const * data[EXTENSION_LIST_MAX] = {};
         u32 size = {};
 
-        void initialize();
+        // Headless devices never present and can run on implementations without window system integration
+        void initialize(bool enable_swapchain);
     };
 } // namespace ff
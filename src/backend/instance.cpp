@@ -3,12 +3,16 @@
 
 namespace ff
 {
-    Instance::Instance()
+    Instance::Instance(bool headless)
+        : headless{headless}
     {
         std::vector<char const *> required_extensions = {};
-        required_extensions.push_back({VK_KHR_SURFACE_EXTENSION_NAME});
         required_extensions.push_back({VK_EXT_DEBUG_UTILS_EXTENSION_NAME});
-        required_extensions.push_back({VK_KHR_WIN32_SURFACE_EXTENSION_NAME});
+        if (!headless)
+        {
+            required_extensions.push_back({VK_KHR_SURFACE_EXTENSION_NAME});
+            required_extensions.push_back({VK_KHR_WIN32_SURFACE_EXTENSION_NAME});
+        }
 
         std::vector<VkExtensionProperties> instance_extensions = {};
         u32 instance_extension_count = {};
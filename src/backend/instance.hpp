@@ -8,12 +8,14 @@ namespace ff
     struct Instance
     {
       public:
-        Instance();
+        // A headless instance does not enable the surface extensions, it can only render offscreen
+        Instance(bool headless = false);
         ~Instance();
 
       private:
         friend struct Device;
         friend struct Swapchain;
         VkInstance vulkan_instance = {};
+        bool headless = {};
     };
 } // namespace ff
\ No newline at end of file
@@ -213,7 +213,7 @@ namespace ff
             .basePipelineIndex = 0,
         };
 
-        CHECK_VK_RESULT(vkCreateGraphicsPipelines(device->vulkan_device, VK_NULL_HANDLE, 1u, &graphics_pipeline_create_info, nullptr, &pipeline));
+        CHECK_VK_RESULT(vkCreateGraphicsPipelines(device->vulkan_device, device->pipeline_cache, 1u, &graphics_pipeline_create_info, nullptr, &pipeline));
         for (auto & shader_module : shader_modules)
         {
             vkDestroyShaderModule(device->vulkan_device, shader_module, nullptr);
@@ -311,7 +311,7 @@ namespace ff
             .basePipelineIndex = 0,
         };
 
-        CHECK_VK_RESULT(vkCreateComputePipelines(device->vulkan_device, VK_NULL_HANDLE, 1u, &compute_pipeline_create_info, nullptr, &pipeline));
+        CHECK_VK_RESULT(vkCreateComputePipelines(device->vulkan_device, device->pipeline_cache, 1u, &compute_pipeline_create_info, nullptr, &pipeline));
         vkDestroyShaderModule(device->vulkan_device, shader_module, nullptr);
         {
             VkDebugUtilsObjectNameInfoEXT const name_info{
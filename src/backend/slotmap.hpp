@@ -71,6 +71,10 @@ namespace ff
             auto const uz_index = static_cast<size_t>(id.index);
             return uz_index < slots.size() && versions[uz_index] == id.version;
         }
+        auto id_from_index(u32 index) const -> Id
+        {
+            return Id{index, versions[static_cast<size_t>(index)]};
+        }
         auto size() const -> usize
         {
             return slots.size() - free_list.size();
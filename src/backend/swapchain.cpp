@@ -3,6 +3,11 @@ namespace ff
 {
     void Swapchain::resize()
     {
+        // Headless targets keep the extent they were created with
+        if (is_headless())
+        {
+            return;
+        }
         device->wait_idle();
         for (ImageId const & id : images)
         {
@@ -77,136 +82,163 @@ namespace ff
           window_handle{info.window_handle},
           vkCreateWin32SurfaceKHR{reinterpret_cast<PFN_vkCreateWin32SurfaceKHR>(vkGetInstanceProcAddr(instance->vulkan_instance, "vkCreateWin32SurfaceKHR"))}
     {
-        VkWin32SurfaceCreateInfoKHR const surface_create_info = {
-            .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
-            .pNext = nullptr,
-            .flags = 0,
-            .hinstance = GetModuleHandleA(nullptr),
-            .hwnd = static_cast<HWND>(window_handle),
-        };
-        CHECK_VK_RESULT(vkCreateWin32SurfaceKHR(instance->vulkan_instance, &surface_create_info, nullptr, &surface));
-        BACKEND_LOG("[INFO][Swaphcain::create_surface()] Surface creation successful")
-
-        u32 present_mode_count = 0;
-        std::vector<VkPresentModeKHR> present_modes = {};
-        CHECK_VK_RESULT(vkGetPhysicalDeviceSurfacePresentModesKHR(device->vulkan_physical_device, surface, &present_mode_count, nullptr));
-        present_modes.resize(present_mode_count);
-        CHECK_VK_RESULT(vkGetPhysicalDeviceSurfacePresentModesKHR(device->vulkan_physical_device, surface, &present_mode_count, present_modes.data()));
-
-        auto present_mode_selector = [](VkPresentModeKHR const & present_mode)
+        if (window_handle == nullptr)
         {
-            switch (present_mode)
+            /// NOTE: Without a surface the frames are rendered into plain device images which are never presented.
+            //        They are cycled the same way the swapchain images would be so that the frame pacing matches.
+            surface_format = {
+                .format = VkFormat::VK_FORMAT_R8G8B8A8_SRGB,
+                .colorSpace = VkColorSpaceKHR::VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+            };
+            surface_extent = info.headless_extent;
+            images.resize(MIN_IMAGE_COUNT);
+            for (u32 image_index = 0; image_index < MIN_IMAGE_COUNT; image_index++)
             {
-                case VkPresentModeKHR::VK_PRESENT_MODE_MAILBOX_KHR:      return 100;
-                case VkPresentModeKHR::VK_PRESENT_MODE_FIFO_KHR:         return 90;
-                case VkPresentModeKHR::VK_PRESENT_MODE_FIFO_RELAXED_KHR: return 80;
-                case VkPresentModeKHR::VK_PRESENT_MODE_IMMEDIATE_KHR:    return 70;
-                default:                                                 return 0;
+                images.at(image_index) = device->create_image({
+                    .format = surface_format.format,
+                    .extent = {surface_extent.width, surface_extent.height, 1},
+                    .usage = VkImageUsageFlagBits::VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                             VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                             VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    .aspect = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+                    .name = fmt::format("headless target {}", image_index),
+                });
             }
-        };
-
-        auto present_mode_comparator = [&](VkPresentModeKHR const & a, VkPresentModeKHR const & b)
-        {
-            return present_mode_selector(a) < present_mode_selector(b);
-        };
-        auto const best_present_mode_it = std::max_element(present_modes.begin(), present_modes.end(), present_mode_comparator);
-        present_mode = *best_present_mode_it;
-        if (present_mode_selector(present_mode) == 0)
-        {
-            BACKEND_LOG(fmt::format("[WARN][Swapchain::Swapchain()] Found only present mode which was not explicitly wanted"));
+            BACKEND_LOG(fmt::format("[INFO][Swapchain::Swapchain()] Headless targets {}x{} creation successful", surface_extent.width, surface_extent.height));
         }
+        else
+        {
+            VkWin32SurfaceCreateInfoKHR const surface_create_info = {
+                .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
+                .pNext = nullptr,
+                .flags = 0,
+                .hinstance = GetModuleHandleA(nullptr),
+                .hwnd = static_cast<HWND>(window_handle),
+            };
+            CHECK_VK_RESULT(vkCreateWin32SurfaceKHR(instance->vulkan_instance, &surface_create_info, nullptr, &surface));
+            BACKEND_LOG("[INFO][Swaphcain::create_surface()] Surface creation successful")
 
-        u32 format_count = 0;
-        std::vector<VkSurfaceFormatKHR> formats = {};
-        CHECK_VK_RESULT(vkGetPhysicalDeviceSurfaceFormatsKHR(device->vulkan_physical_device, surface, &format_count, nullptr));
-        formats.resize(format_count);
-        CHECK_VK_RESULT(vkGetPhysicalDeviceSurfaceFormatsKHR(device->vulkan_physical_device, surface, &format_count, formats.data()));
+            u32 present_mode_count = 0;
+            std::vector<VkPresentModeKHR> present_modes = {};
+            CHECK_VK_RESULT(vkGetPhysicalDeviceSurfacePresentModesKHR(device->vulkan_physical_device, surface, &present_mode_count, nullptr));
+            present_modes.resize(present_mode_count);
+            CHECK_VK_RESULT(vkGetPhysicalDeviceSurfacePresentModesKHR(device->vulkan_physical_device, surface, &present_mode_count, present_modes.data()));
 
-        if (format_count == 0)
-        {
-            throw std::runtime_error("[ERROR][Swaphcain::Swapchain()] Found no surface formats");
-        }
+            auto present_mode_selector = [](VkPresentModeKHR const & present_mode)
+            {
+                switch (present_mode)
+                {
+                    case VkPresentModeKHR::VK_PRESENT_MODE_MAILBOX_KHR:      return 100;
+                    case VkPresentModeKHR::VK_PRESENT_MODE_FIFO_KHR:         return 90;
+                    case VkPresentModeKHR::VK_PRESENT_MODE_FIFO_RELAXED_KHR: return 80;
+                    case VkPresentModeKHR::VK_PRESENT_MODE_IMMEDIATE_KHR:    return 70;
+                    default:                                                 return 0;
+                }
+            };
 
-        auto format_selector = [](VkFormat const & format) -> i32
-        {
-            switch (format)
+            auto present_mode_comparator = [&](VkPresentModeKHR const & a, VkPresentModeKHR const & b)
             {
-                case VkFormat::VK_FORMAT_R8G8B8A8_SRGB:  return 100;
-                case VkFormat::VK_FORMAT_R8G8B8A8_UNORM: return 90;
-                case VkFormat::VK_FORMAT_B8G8R8A8_SRGB:  return 80;
-                case VkFormat::VK_FORMAT_B8G8R8A8_UNORM: return 70;
-                default:                                 return 0;
+                return present_mode_selector(a) < present_mode_selector(b);
+            };
+            auto const best_present_mode_it = std::max_element(present_modes.begin(), present_modes.end(), present_mode_comparator);
+            present_mode = *best_present_mode_it;
+            if (present_mode_selector(present_mode) == 0)
+            {
+                BACKEND_LOG(fmt::format("[WARN][Swapchain::Swapchain()] Found only present mode which was not explicitly wanted"));
             }
-        };
 
-        auto format_comparator = [&](VkSurfaceFormatKHR const & a, VkSurfaceFormatKHR const & b)
-        {
-            return format_selector(a.format) < format_selector(b.format);
-        };
+            u32 format_count = 0;
+            std::vector<VkSurfaceFormatKHR> formats = {};
+            CHECK_VK_RESULT(vkGetPhysicalDeviceSurfaceFormatsKHR(device->vulkan_physical_device, surface, &format_count, nullptr));
+            formats.resize(format_count);
+            CHECK_VK_RESULT(vkGetPhysicalDeviceSurfaceFormatsKHR(device->vulkan_physical_device, surface, &format_count, formats.data()));
 
-        auto const best_format_it = std::max_element(formats.begin(), formats.end(), format_comparator);
-        surface_format = *best_format_it;
-        if (format_selector(surface_format.format) == 0)
-        {
-            BACKEND_LOG(fmt::format("[Swapchain::Swapchain()][WARN] Found only format which was not explicitly wanted"));
-        }
-        VkSurfaceCapabilitiesKHR surface_capabilities;
-        CHECK_VK_RESULT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device->vulkan_physical_device, surface, &surface_capabilities));
-        surface_extent = {
-            .width = surface_capabilities.currentExtent.width,
-            .height = surface_capabilities.currentExtent.height};
+            if (format_count == 0)
+            {
+                throw std::runtime_error("[ERROR][Swaphcain::Swapchain()] Found no surface formats");
+            }
 
-        VkImageUsageFlags const usage = VkImageUsageFlagBits::VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            auto format_selector = [](VkFormat const & format) -> i32
+            {
+                switch (format)
+                {
+                    case VkFormat::VK_FORMAT_R8G8B8A8_SRGB:  return 100;
+                    case VkFormat::VK_FORMAT_R8G8B8A8_UNORM: return 90;
+                    case VkFormat::VK_FORMAT_B8G8R8A8_SRGB:  return 80;
+                    case VkFormat::VK_FORMAT_B8G8R8A8_UNORM: return 70;
+                    default:                                 return 0;
+                }
+            };
 
-        VkSwapchainCreateInfoKHR const swapchain_create_info = {
-            .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-            .pNext = nullptr,
-            .flags = 0,
-            .surface = surface,
-            .minImageCount = MIN_IMAGE_COUNT,
-            .imageFormat = surface_format.format,
-            .imageColorSpace = surface_format.colorSpace,
-            .imageExtent = surface_extent,
-            .imageArrayLayers = 1,
-            .imageUsage = usage,
-            .imageSharingMode = VkSharingMode::VK_SHARING_MODE_EXCLUSIVE,
-            .queueFamilyIndexCount = 1,
-            .pQueueFamilyIndices = reinterpret_cast<u32 *>(&device->main_queue_family_index),
-            .preTransform = VkSurfaceTransformFlagBitsKHR::VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
-            .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-            .presentMode = present_mode,
-            .clipped = VK_TRUE,
-            .oldSwapchain = nullptr,
-        };
+            auto format_comparator = [&](VkSurfaceFormatKHR const & a, VkSurfaceFormatKHR const & b)
+            {
+                return format_selector(a.format) < format_selector(b.format);
+            };
 
-        CHECK_VK_RESULT(vkCreateSwapchainKHR(device->vulkan_device, &swapchain_create_info, nullptr, &swapchain));
-        BACKEND_LOG("[INFO][Swapchain::Swapchain()] Swapchain creation successful");
+            auto const best_format_it = std::max_element(formats.begin(), formats.end(), format_comparator);
+            surface_format = *best_format_it;
+            if (format_selector(surface_format.format) == 0)
+            {
+                BACKEND_LOG(fmt::format("[Swapchain::Swapchain()][WARN] Found only format which was not explicitly wanted"));
+            }
+            VkSurfaceCapabilitiesKHR surface_capabilities;
+            CHECK_VK_RESULT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device->vulkan_physical_device, surface, &surface_capabilities));
+            surface_extent = {
+                .width = surface_capabilities.currentExtent.width,
+                .height = surface_capabilities.currentExtent.height};
 
-        u32 vulkan_swapchain_image_count = 0;
-        std::vector<VkImage> vulkan_swapchain_images = {};
-        CHECK_VK_RESULT(vkGetSwapchainImagesKHR(device->vulkan_device, swapchain, &vulkan_swapchain_image_count, nullptr));
-        vulkan_swapchain_images.resize(vulkan_swapchain_image_count);
-        CHECK_VK_RESULT(vkGetSwapchainImagesKHR(device->vulkan_device, swapchain, &vulkan_swapchain_image_count, vulkan_swapchain_images.data()));
+            VkImageUsageFlags const usage = VkImageUsageFlagBits::VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
-        images.resize(vulkan_swapchain_image_count);
-        for (u32 swapchain_image_index = 0; swapchain_image_index < vulkan_swapchain_image_count; swapchain_image_index++)
-        {
-            CreateImageInfo image_info = {
-                .format = surface_format.format,
-                .extent = {surface_extent.width, surface_extent.height, 1},
-                .usage = usage,
-                .name = fmt::format("swapchain {}", swapchain_image_index),
+            VkSwapchainCreateInfoKHR const swapchain_create_info = {
+                .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+                .pNext = nullptr,
+                .flags = 0,
+                .surface = surface,
+                .minImageCount = MIN_IMAGE_COUNT,
+                .imageFormat = surface_format.format,
+                .imageColorSpace = surface_format.colorSpace,
+                .imageExtent = surface_extent,
+                .imageArrayLayers = 1,
+                .imageUsage = usage,
+                .imageSharingMode = VkSharingMode::VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = 1,
+                .pQueueFamilyIndices = reinterpret_cast<u32 *>(&device->main_queue_family_index),
+                .preTransform = VkSurfaceTransformFlagBitsKHR::VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
+                .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+                .presentMode = present_mode,
+                .clipped = VK_TRUE,
+                .oldSwapchain = nullptr,
             };
-            images.at(swapchain_image_index) = device->create_swapchain_image(vulkan_swapchain_images.at(swapchain_image_index), image_info);
+
+            CHECK_VK_RESULT(vkCreateSwapchainKHR(device->vulkan_device, &swapchain_create_info, nullptr, &swapchain));
+            BACKEND_LOG("[INFO][Swapchain::Swapchain()] Swapchain creation successful");
+
+            u32 vulkan_swapchain_image_count = 0;
+            std::vector<VkImage> vulkan_swapchain_images = {};
+            CHECK_VK_RESULT(vkGetSwapchainImagesKHR(device->vulkan_device, swapchain, &vulkan_swapchain_image_count, nullptr));
+            vulkan_swapchain_images.resize(vulkan_swapchain_image_count);
+            CHECK_VK_RESULT(vkGetSwapchainImagesKHR(device->vulkan_device, swapchain, &vulkan_swapchain_image_count, vulkan_swapchain_images.data()));
+
+            images.resize(vulkan_swapchain_image_count);
+            for (u32 swapchain_image_index = 0; swapchain_image_index < vulkan_swapchain_image_count; swapchain_image_index++)
+            {
+                CreateImageInfo image_info = {
+                    .format = surface_format.format,
+                    .extent = {surface_extent.width, surface_extent.height, 1},
+                    .usage = usage,
+                    .name = fmt::format("swapchain {}", swapchain_image_index),
+                };
+                images.at(swapchain_image_index) = device->create_swapchain_image(vulkan_swapchain_images.at(swapchain_image_index), image_info);
+            }
+            VkDebugUtilsObjectNameInfoEXT const swapchain_name_info{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+                .pNext = nullptr,
+                .objectType = VK_OBJECT_TYPE_SWAPCHAIN_KHR,
+                .objectHandle = reinterpret_cast<u64>(swapchain),
+                .pObjectName = "FF Swapchain",
+            };
+            CHECK_VK_RESULT(device->vkSetDebugUtilsObjectNameEXT(device->vulkan_device, &swapchain_name_info));
         }
-        VkDebugUtilsObjectNameInfoEXT const swapchain_name_info{
-            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-            .pNext = nullptr,
-            .objectType = VK_OBJECT_TYPE_SWAPCHAIN_KHR,
-            .objectHandle = reinterpret_cast<u64>(swapchain),
-            .pObjectName = "FF Swapchain",
-        };
-        CHECK_VK_RESULT(device->vkSetDebugUtilsObjectNameEXT(device->vulkan_device, &swapchain_name_info));
 
         swapchain_cpu_timeline = 0;
         VkSemaphoreTypeCreateInfo timeline_semaphore_type_create_info = {
@@ -271,8 +303,15 @@ namespace ff
         };
         CHECK_VK_RESULT(vkWaitSemaphores(device->vulkan_device, &semaphore_wait_info, std::numeric_limits<u32>::max()));
         current_semaphore_index = (swapchain_cpu_timeline) % FRAMES_IN_FLIGHT;
-        VkSemaphore const & acquire_semaphore = swapchain_acquire_semaphores.at(current_semaphore_index);
-        CHECK_VK_RESULT(vkAcquireNextImageKHR(device->vulkan_device, swapchain, std::numeric_limits<u64>::max(), acquire_semaphore, nullptr, &current_acquired_image_index));
+        if (is_headless())
+        {
+            current_acquired_image_index = static_cast<u32>(swapchain_cpu_timeline % images.size());
+        }
+        else
+        {
+            VkSemaphore const & acquire_semaphore = swapchain_acquire_semaphores.at(current_semaphore_index);
+            CHECK_VK_RESULT(vkAcquireNextImageKHR(device->vulkan_device, swapchain, std::numeric_limits<u64>::max(), acquire_semaphore, nullptr, &current_acquired_image_index));
+        }
         swapchain_cpu_timeline += 1;
         return images.at(current_acquired_image_index);
     }
@@ -297,8 +336,18 @@ namespace ff
         return swapchain_cpu_timeline;
     }
 
+    auto Swapchain::is_headless() const -> bool
+    {
+        return window_handle == nullptr;
+    }
+
     void Swapchain::present(PresentInfo const & info)
     {
+        if (is_headless())
+        {
+            BACKEND_LOG("[ERROR][Swapchain::present()] Headless swapchain can not present");
+            throw std::runtime_error("[ERROR][Swapchain::present()] Headless swapchain can not present");
+        }
         VkPresentInfoKHR const present_info = {
             .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
             .pNext = nullptr,
@@ -326,6 +375,15 @@ namespace ff
             vkDestroySemaphore(device->vulkan_device, swapchain_present_semaphore, nullptr);
         }
         BACKEND_LOG("[INFO][Swapchain::~Swapchain] Swapchain acquire and present semaphores destroyed")
+        if (is_headless())
+        {
+            for (ImageId const & id : images)
+            {
+                device->destroy_image(id);
+            }
+            BACKEND_LOG("[INFO][Swapchain::~Swapchain] Headless targets destroyed")
+            return;
+        }
         for (ImageId const & id : images)
         {
             device->destroy_swapchain_image(id);
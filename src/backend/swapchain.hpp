@@ -10,7 +10,9 @@ namespace ff
     {
         std::shared_ptr<Instance> instance = {};
         std::shared_ptr<Device> device = {};
+        // A null window handle creates a headless swapchain rendering into images of this extent
         void * window_handle = {};
+        VkExtent2D headless_extent = {};
     };
 
     constexpr u32 FRAMES_IN_FLIGHT = 2;
@@ -35,6 +37,9 @@ namespace ff
         auto get_current_present_semaphore() -> VkSemaphore;
         auto get_timeline_semaphore() -> VkSemaphore;
         auto get_timeline_cpu_value() -> u64;
+        /// NOTE: Headless swapchains do not acquire or present. The renderer must not wait on the acquire semaphore,
+        //        signal the present semaphore or call present(), the acquired images are left in TRANSFER_SRC_OPTIMAL.
+        auto is_headless() const -> bool;
         void present(PresentInfo const & inf);
         ~Swapchain();
 
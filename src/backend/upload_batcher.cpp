@@ -0,0 +1,126 @@
+#include "upload_batcher.hpp"
+#include <cstring>
+
+namespace ff
+{
+    UploadBatcher::UploadBatcher(std::shared_ptr<Device> device)
+        : device{device}
+    {
+    }
+
+    auto UploadBatcher::get_command_buffer() -> CommandBuffer &
+    {
+        if (!command_buffer.has_value())
+        {
+            command_buffer.emplace(device);
+            command_buffer->begin();
+        }
+        return command_buffer.value();
+    }
+
+    auto UploadBatcher::allocate_staging(usize size, usize alignment) -> StagingAllocation
+    {
+        statistics.uploaded_bytes += size;
+        if (size > device->get_staging_ring_size() / 2)
+        {
+            BufferId const dedicated_staging_buffer = device->create_buffer({
+                .size = size,
+                .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+                .name = "upload batcher dedicated staging",
+            });
+            pending_dedicated_staging_buffers.push_back(dedicated_staging_buffer);
+            return StagingAllocation{
+                .buffer_id = dedicated_staging_buffer,
+                .offset = 0,
+                .size = size,
+                .host_address = reinterpret_cast<std::byte *>(device->get_buffer_host_pointer(dedicated_staging_buffer)),
+            };
+        }
+        std::optional<StagingAllocation> staging = device->allocate_staging(size, alignment);
+        if (!staging.has_value())
+        {
+            // Ring is filled only by our own pending allocations, submit them so the ring can be recycled
+            flush();
+            staging = device->allocate_staging(size, alignment);
+        }
+        if (!staging.has_value())
+        {
+            BACKEND_LOG(fmt::format("[ERROR][UploadBatcher::allocate_staging()] Failed to allocate {} bytes of staging memory", size));
+            throw std::runtime_error("[ERROR][UploadBatcher::allocate_staging()] Failed to allocate staging memory");
+        }
+        return staging.value();
+    }
+
+    void UploadBatcher::upload_buffer(BufferId dst_buffer, usize dst_offset, std::span<std::byte const> data)
+    {
+        usize const max_chunk_size = device->get_staging_ring_size() / 4;
+        usize uploaded_size = 0;
+        while (uploaded_size < data.size())
+        {
+            usize const chunk_size = std::min(max_chunk_size, data.size() - uploaded_size);
+            StagingAllocation const staging = allocate_staging(chunk_size);
+            std::memcpy(staging.host_address, data.data() + uploaded_size, chunk_size);
+            get_command_buffer().cmd_copy_buffer_to_buffer({
+                .src_buffer = staging.buffer_id,
+                .src_offset = static_cast<u32>(staging.offset),
+                .dst_buffer = dst_buffer,
+                .dst_offset = static_cast<u32>(dst_offset + uploaded_size),
+                .size = static_cast<u32>(chunk_size),
+            });
+            uploaded_size += chunk_size;
+        }
+    }
+
+    void UploadBatcher::flush()
+    {
+        if (!command_buffer.has_value())
+        {
+            return;
+        }
+        command_buffer->end();
+        auto recorded_command_buffer = command_buffer->get_recorded_command_buffer();
+        device->submit({.command_buffers = {&recorded_command_buffer, 1}});
+        statistics.submit_count += 1;
+        /// NOTE: Destroying after the submit makes the buffers zombies of this submit's timeline value.
+        command_buffer.reset();
+        for (BufferId const dedicated_staging_buffer : pending_dedicated_staging_buffers)
+        {
+            device->destroy_buffer(dedicated_staging_buffer);
+        }
+        pending_dedicated_staging_buffers.clear();
+    }
+
+    auto UploadBatcher::finish() -> UploadStatistics
+    {
+        // Make the uploaded data visible to all subsequent work on the queue
+        get_command_buffer().cmd_memory_barrier({
+            .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dst_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dst_access = VK_ACCESS_2_MEMORY_READ_BIT,
+        });
+        flush();
+        device->wait_idle();
+        device->cleanup_resources();
+        finished = true;
+        statistics.elapsed_time_ms = stopwatch.elapsed_time<f32, std::chrono::microseconds>() / 1000.0f;
+        return statistics;
+    }
+
+    /// NOTE: Reached without finish() only when the upload was abandoned, usually while an exception unwinds. Nothing
+    //        is submitted or waited for here, the recorded commands are dropped together with the staging buffers
+    //        only they referenced.
+    UploadBatcher::~UploadBatcher() noexcept
+    {
+        if (finished)
+        {
+            return;
+        }
+        command_buffer.reset();
+        for (BufferId const dedicated_staging_buffer : pending_dedicated_staging_buffers)
+        {
+            device->destroy_buffer(dedicated_staging_buffer);
+        }
+        pending_dedicated_staging_buffers.clear();
+    }
+} // namespace ff
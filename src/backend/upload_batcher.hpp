@@ -0,0 +1,50 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "core.hpp"
+#include "device.hpp"
+#include "command_buffer.hpp"
+
+namespace ff
+{
+    struct UploadStatistics
+    {
+        usize uploaded_bytes = {};
+        u32 submit_count = {};
+        f32 elapsed_time_ms = {};
+    };
+
+    /// NOTE: Records all upload copies and layout transitions into as few command buffers as possible. A command
+    //        buffer is only submitted when the staging ring can not fit the next allocation, in which case recording
+    //        continues in a new command buffer while the GPU consumes the previous one. The CPU waits only once, in finish().
+    struct UploadBatcher
+    {
+      public:
+        UploadBatcher(std::shared_ptr<Device> device);
+        UploadBatcher(UploadBatcher const &) = delete;
+        UploadBatcher & operator=(UploadBatcher const &) = delete;
+
+        // Reference is invalidated by the next call to allocate_staging(), upload_buffer() or flush().
+        auto get_command_buffer() -> CommandBuffer &;
+        /// NOTE: Never fails, submits the pending commands when the ring is full. Allocations larger than half of the
+        //        staging ring get a dedicated staging buffer which is destroyed after it was submitted.
+        auto allocate_staging(usize size, usize alignment = 16) -> StagingAllocation;
+        void upload_buffer(BufferId dst_buffer, usize dst_offset, std::span<std::byte const> data);
+        void flush();
+        // Submits the remaining commands and waits for all of the uploads to finish. Has to be called explicitly, a
+        // batcher destroyed without it drops the commands it did not submit yet.
+        auto finish() -> UploadStatistics;
+        ~UploadBatcher() noexcept;
+
+      private:
+        std::shared_ptr<Device> device = {};
+        std::optional<CommandBuffer> command_buffer = {};
+        std::vector<BufferId> pending_dedicated_staging_buffers = {};
+        PreciseStopwatch stopwatch = {};
+        UploadStatistics statistics = {};
+        bool finished = {};
+    };
+} // namespace ff
@@ -0,0 +1,141 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+// "generate draws" -> "generate_draws"
+static auto to_column_name(std::string_view zone_name) -> std::string
+{
+    std::string column_name = std::string(zone_name);
+    std::replace(column_name.begin(), column_name.end(), ' ', '_');
+    return column_name;
+}
+
+static auto escape_json(std::string_view string) -> std::string
+{
+    std::string escaped = {};
+    for (char const character : string)
+    {
+        if (character == '"' || character == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += character;
+    }
+    return escaped;
+}
+
+// Zone names in the order they first appear over all frames
+static auto collect_zone_names(std::span<BenchmarkFrame const> frames) -> std::vector<std::string>
+{
+    std::vector<std::string> zone_names = {};
+    for (BenchmarkFrame const & frame : frames)
+    {
+        for (ff::GpuZoneTiming const & zone : frame.gpu_zones)
+        {
+            if (std::find(zone_names.begin(), zone_names.end(), zone.name) == zone_names.end())
+            {
+                zone_names.push_back(zone.name);
+            }
+        }
+    }
+    return zone_names;
+}
+
+static auto find_zone_ms(BenchmarkFrame const & frame, std::string_view zone_name) -> std::optional<f32>
+{
+    auto const zone_it = std::find_if(frame.gpu_zones.begin(), frame.gpu_zones.end(),
+                                      [&](ff::GpuZoneTiming const & zone) { return zone.name == zone_name; });
+    if (zone_it == frame.gpu_zones.end())
+    {
+        return std::nullopt;
+    }
+    return zone_it->last_ms;
+}
+
+static void write_csv(std::ofstream & file, std::span<BenchmarkFrame const> frames, std::span<std::string const> zone_names)
+{
+    file << "frame,time_s,cpu_ms";
+    for (std::string const & zone_name : zone_names)
+    {
+        file << fmt::format(",{}_gpu_ms", to_column_name(zone_name));
+    }
+    file << '\n';
+    for (BenchmarkFrame const & frame : frames)
+    {
+        file << fmt::format("{},{:.6f},{:.4f}", frame.frame_index, frame.time_s, frame.cpu_ms);
+        for (std::string const & zone_name : zone_names)
+        {
+            auto const zone_ms = find_zone_ms(frame, zone_name);
+            file << (zone_ms.has_value() ? fmt::format(",{:.4f}", zone_ms.value()) : std::string(","));
+        }
+        file << '\n';
+    }
+}
+
+static void write_json(std::ofstream & file, BenchmarkInfo const & info, std::span<BenchmarkFrame const> frames, std::span<std::string const> zone_names)
+{
+    f64 cpu_sum_ms = 0.0;
+    for (BenchmarkFrame const & frame : frames)
+    {
+        cpu_sum_ms += frame.cpu_ms;
+    }
+    f64 const frame_count = static_cast<f64>(std::max(frames.size(), usize(1)));
+
+    file << "{\n";
+    file << fmt::format("  \"device\": \"{}\",\n", escape_json(info.device_name));
+    file << fmt::format("  \"width\": {},\n  \"height\": {},\n", info.extent.width, info.extent.height);
+    file << fmt::format("  \"timestep_s\": {:.6f},\n  \"frame_count\": {},\n", info.timestep, frames.size());
+    file << fmt::format("  \"average\": {{\n    \"cpu_ms\": {:.4f},\n    \"gpu_ms\": {{", cpu_sum_ms / frame_count);
+    for (usize zone_index = 0; zone_index < zone_names.size(); zone_index++)
+    {
+        f64 zone_sum_ms = 0.0;
+        u32 zone_frame_count = 0;
+        for (BenchmarkFrame const & frame : frames)
+        {
+            auto const zone_ms = find_zone_ms(frame, zone_names[zone_index]);
+            if (zone_ms.has_value())
+            {
+                zone_sum_ms += zone_ms.value();
+                zone_frame_count += 1;
+            }
+        }
+        file << fmt::format("{}\n      \"{}\": {:.4f}", zone_index == 0 ? "" : ",",
+                            escape_json(to_column_name(zone_names[zone_index])),
+                            zone_sum_ms / static_cast<f64>(std::max(zone_frame_count, 1u)));
+    }
+    file << "\n    }\n  },\n  \"frames\": [";
+    for (usize frame_index = 0; frame_index < frames.size(); frame_index++)
+    {
+        BenchmarkFrame const & frame = frames[frame_index];
+        file << fmt::format("{}\n    {{\"frame\": {}, \"time_s\": {:.6f}, \"cpu_ms\": {:.4f}, \"gpu_ms\": {{",
+                            frame_index == 0 ? "" : ",", frame.frame_index, frame.time_s, frame.cpu_ms);
+        for (usize zone_index = 0; zone_index < frame.gpu_zones.size(); zone_index++)
+        {
+            file << fmt::format("{}\"{}\": {:.4f}", zone_index == 0 ? "" : ", ",
+                                escape_json(to_column_name(frame.gpu_zones[zone_index].name)),
+                                frame.gpu_zones[zone_index].last_ms);
+        }
+        file << "}}";
+    }
+    file << "\n  ]\n}\n";
+}
+
+auto write_benchmark_results(std::filesystem::path const & path, BenchmarkInfo const & info, std::span<BenchmarkFrame const> frames) -> bool
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::vector<std::string> const zone_names = collect_zone_names(frames);
+    if (path.extension() == ".json")
+    {
+        write_json(file, info, frames, zone_names);
+    }
+    else
+    {
+        write_csv(file, frames, zone_names);
+    }
+    return file.good();
+}
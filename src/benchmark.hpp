@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "fairy_forest.hpp"
+#include "backend/backend.hpp"
+
+using namespace ff::types;
+
+struct BenchmarkFrame
+{
+    u32 frame_index = {};
+    // Time along the cinematic path after the frame was stepped
+    f32 time_s = {};
+    // Camera update and draw_frame() including the wait for a free frame in flight
+    f32 cpu_ms = {};
+    // Empty when the device does not support timestamps
+    std::vector<ff::GpuZoneTiming> gpu_zones = {};
+};
+
+struct BenchmarkInfo
+{
+    std::string device_name = {};
+    VkExtent2D extent = {};
+    f32 timestep = {};
+};
+
+/// NOTE: Writes one row per frame, a .json extension writes JSON including averages over all frames, anything else
+//        writes CSV. Every GPU zone gets its own column named after the zone, frames without the zone leave it empty.
+//        Returns false when the file could not be written.
+auto write_benchmark_results(std::filesystem::path const & path, BenchmarkInfo const & info, std::span<BenchmarkFrame const> frames) -> bool;
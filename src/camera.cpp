@@ -133,11 +133,11 @@ void CameraController::update_matrices(Window & window)
     cam_info.up = up;
 }
 
-CinematicCamera::CinematicCamera(std::vector<AnimationKeyframe> const & keyframes, Window & window) : path_keyframes{keyframes}
+CinematicCamera::CinematicCamera(std::vector<AnimationKeyframe> const & keyframes) : path_keyframes{keyframes}
 {
 }
 
-void CinematicCamera::update_projection(Window & window, const glm::fquat view_quat)
+void CinematicCamera::update_projection(f32 aspect_ratio, const glm::fquat view_quat)
 {
     auto inf_depth_reverse_z_perspective = [](auto fov_rads, auto aspect, auto z_near)
     {
@@ -153,7 +153,7 @@ void CinematicCamera::update_projection(Window & window, const glm::fquat view_q
         ret[3][2] = z_near;
         return ret;
     };
-    glm::mat4 prespective = inf_depth_reverse_z_perspective(glm::radians(70.0f), f32(window.get_width()) / f32(window.get_height()), near_plane);
+    glm::mat4 prespective = inf_depth_reverse_z_perspective(glm::radians(70.0f), aspect_ratio, near_plane);
     prespective[1][1] *= -1.0f;
     info.proj = prespective;
     info.up = {0.0f, 0.0f, 1.0f};
@@ -183,7 +183,7 @@ void CinematicCamera::update_projection(Window & window, const glm::fquat view_q
 
     f32 fov_tan = glm::tan(glm::radians(70.0f) / 2.0f);
 
-    auto right_aspect_fov_correct = right_ * (f32(window.get_width()) / f32(window.get_height())) * fov_tan;
+    auto right_aspect_fov_correct = right_ * aspect_ratio * fov_tan;
     auto up_fov_correct = glm::normalize(up_) * fov_tan;
 
     info.fsr_cam_info = {
@@ -198,7 +198,7 @@ void CinematicCamera::update_projection(Window & window, const glm::fquat view_q
     info.up = up;
 }
 
-void CinematicCamera::update_position(Window & window, f32 dt)
+void CinematicCamera::update_position(f32 aspect_ratio, f32 dt)
 {
     // TODO(msakmary) Whenever the update position dt is longer than a whole keyframe transition time
     // this code will not properly account for this
@@ -232,5 +232,5 @@ void CinematicCamera::update_position(Window & window, f32 dt)
         w3 * current_keyframe.end_position;
 
     auto const view_quat = glm::slerp(current_keyframe.start_rotation, current_keyframe.end_rotation, t);
-    update_projection(window, view_quat);
+    update_projection(aspect_ratio, view_quat);
 }
\ No newline at end of file
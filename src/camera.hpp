@@ -39,9 +39,10 @@ struct AnimationKeyframe
 struct CinematicCamera
 {
     CinematicCamera() = default;
-    CinematicCamera(std::vector<AnimationKeyframe> const & keyframes, Window & window);
-    void update_position(Window & window, f32 dt);
-    void update_projection(Window & window, const glm::fquat view_quat);
+    CinematicCamera(std::vector<AnimationKeyframe> const & keyframes);
+    // Only advances by dt, stepping with a fixed dt makes the path reproducible
+    void update_position(f32 aspect_ratio, f32 dt);
+    void update_projection(f32 aspect_ratio, const glm::fquat view_quat);
     CameraInfo info;
 
     f32 near_plane = 0.1f;
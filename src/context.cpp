@@ -11,6 +11,17 @@ Context::Context(void * window_handle)
 {
 }
 
+Context::Context(VkExtent2D headless_extent)
+    : instance{std::make_shared<ff::Instance>(true)},
+      device{std::make_shared<ff::Device>(instance)},
+      swapchain{
+          std::make_shared<ff::Swapchain>(ff::CreateSwapchainInfo{
+              .instance = instance,
+              .device = device,
+              .headless_extent = headless_extent})}
+{
+}
+
 Context::~Context(){
 
 };
\ No newline at end of file
@@ -8,5 +8,7 @@ struct Context
     std::shared_ptr<ff::Swapchain> swapchain = {};
 
     Context(void * window_handle);
+    // Renders into offscreen images of the given extent without a window or a surface
+    Context(VkExtent2D headless_extent);
     ~Context();
 };
\ No newline at end of file
@@ -1,7 +1,99 @@
 #include "application.hpp"
 
-int main()
+#include <charconv>
+
+static void print_usage()
+{
+    fmt::println("Usage: fairyforest [--headless] [--frames <count>] [--timestep <seconds>] [--resolution <width>x<height>] [--output <file.csv|file.json>] [--compressed-vertices] [--no-texture-streaming] [--texture-budget <MiB>]");
+    fmt::println("  --headless    Renders the cinematic path offscreen and writes per frame CPU and GPU timings");
+    fmt::println("  --frames      Number of benchmarked frames, default 1000");
+    fmt::println("  --timestep    Fixed camera timestep in seconds, default 1/60");
+    fmt::println("  --resolution  Offscreen resolution, default 1920x1080");
+    fmt::println("  --output      Results file, written as JSON for a .json extension and CSV otherwise");
+    fmt::println("  --compressed-vertices  Uploads quantized positions, normals, tangents and uvs instead of full precision floats");
+    fmt::println("  --no-texture-streaming  Uploads every texture mip while loading instead of streaming them in by GPU feedback");
+    fmt::println("  --texture-budget  Device memory of the streamed textures in MiB, default 512");
+}
+
+template <typename T>
+static auto parse_number(std::string_view string, T & value) -> bool
+{
+    auto const [end, error] = std::from_chars(string.data(), string.data() + string.size(), value);
+    return error == std::errc{} && end == string.data() + string.size();
+}
+
+static auto parse_command_line(i32 argc, char ** argv) -> std::optional<ApplicationInfo>
+{
+    ApplicationInfo info = {};
+    for (i32 arg_index = 1; arg_index < argc; arg_index++)
+    {
+        std::string_view const arg = argv[arg_index];
+        bool const has_value = arg_index + 1 < argc;
+        if (arg == "--headless")
+        {
+            info.headless = true;
+        }
+        else if (arg == "--compressed-vertices")
+        {
+            info.compressed_vertices = true;
+        }
+        else if (arg == "--no-texture-streaming")
+        {
+            info.texture_streaming = false;
+        }
+        else if (arg == "--frames" && has_value)
+        {
+            if (!parse_number(argv[++arg_index], info.benchmark_frame_count) || info.benchmark_frame_count == 0)
+            {
+                return std::nullopt;
+            }
+        }
+        else if (arg == "--timestep" && has_value)
+        {
+            if (!parse_number(argv[++arg_index], info.benchmark_timestep) || !(info.benchmark_timestep > 0.0f))
+            {
+                return std::nullopt;
+            }
+        }
+        else if (arg == "--resolution" && has_value)
+        {
+            std::string_view const resolution = argv[++arg_index];
+            usize const separator = resolution.find('x');
+            if (separator == std::string_view::npos ||
+                !parse_number(resolution.substr(0, separator), info.headless_extent.width) ||
+                !parse_number(resolution.substr(separator + 1), info.headless_extent.height) ||
+                info.headless_extent.width == 0 || info.headless_extent.height == 0)
+            {
+                return std::nullopt;
+            }
+        }
+        else if (arg == "--texture-budget" && has_value)
+        {
+            if (!parse_number(argv[++arg_index], info.texture_budget_mib) || info.texture_budget_mib == 0)
+            {
+                return std::nullopt;
+            }
+        }
+        else if (arg == "--output" && has_value)
+        {
+            info.benchmark_output = argv[++arg_index];
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    return info;
+}
+
+int main(int argc, char ** argv)
 {
-    Application app = Application();
+    auto const info = parse_command_line(argc, argv);
+    if (!info.has_value())
+    {
+        print_usage();
+        return 1;
+    }
+    Application app = Application(info.value());
     return app.run();
-}
\ No newline at end of file
+}
@@ -0,0 +1,141 @@
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ff
+{
+    MappedFile::MappedFile(std::filesystem::path const & path)
+    {
+#if defined(_WIN32)
+        HANDLE const file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+        file_handle = file;
+        LARGE_INTEGER file_size = {};
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        {
+            close();
+            return;
+        }
+        HANDLE const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            close();
+            return;
+        }
+        mapping_handle = mapping;
+        void * const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            close();
+            return;
+        }
+        data = reinterpret_cast<std::byte const *>(view);
+        size = static_cast<usize>(file_size.QuadPart);
+#else
+        file_descriptor = ::open(path.c_str(), O_RDONLY);
+        if (file_descriptor < 0)
+        {
+            return;
+        }
+        struct stat file_stat = {};
+        if (fstat(file_descriptor, &file_stat) != 0 || file_stat.st_size == 0)
+        {
+            close();
+            return;
+        }
+        void * const view = mmap(nullptr, static_cast<usize>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (view == MAP_FAILED)
+        {
+            close();
+            return;
+        }
+        data = reinterpret_cast<std::byte const *>(view);
+        size = static_cast<usize>(file_stat.st_size);
+#endif
+    }
+
+    MappedFile::MappedFile(MappedFile && other)
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile & MappedFile::operator=(MappedFile && other)
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+#if defined(_WIN32)
+            std::swap(file_handle, other.file_handle);
+            std::swap(mapping_handle, other.mapping_handle);
+#else
+            std::swap(file_descriptor, other.file_descriptor);
+#endif
+        }
+        return *this;
+    }
+
+    auto MappedFile::is_open() const -> bool
+    {
+        return data != nullptr;
+    }
+
+    auto MappedFile::get_data() const -> std::span<std::byte const>
+    {
+        return {data, size};
+    }
+
+    void MappedFile::close()
+    {
+#if defined(_WIN32)
+        if (data != nullptr)
+        {
+            UnmapViewOfFile(data);
+        }
+        if (mapping_handle != nullptr)
+        {
+            CloseHandle(mapping_handle);
+        }
+        if (file_handle != nullptr)
+        {
+            CloseHandle(file_handle);
+        }
+        file_handle = {};
+        mapping_handle = {};
+#else
+        if (data != nullptr)
+        {
+            munmap(const_cast<std::byte *>(data), size);
+        }
+        if (file_descriptor >= 0)
+        {
+            ::close(file_descriptor);
+        }
+        file_descriptor = -1;
+#endif
+        data = {};
+        size = {};
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+} // namespace ff
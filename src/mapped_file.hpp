@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "fairy_forest.hpp"
+
+namespace ff
+{
+    /// NOTE: Read only memory mapping of a whole file. The mapping stays at the same address for the lifetime
+    //        of the object (including after a move) so spans returned by get_data() can be stored by the user.
+    struct MappedFile
+    {
+      public:
+        MappedFile() = default;
+        MappedFile(std::filesystem::path const & path);
+        MappedFile(MappedFile && other);
+        MappedFile & operator=(MappedFile && other);
+        MappedFile(MappedFile const &) = delete;
+        MappedFile & operator=(MappedFile const &) = delete;
+        ~MappedFile();
+
+        auto is_open() const -> bool;
+        auto get_data() const -> std::span<std::byte const>;
+
+      private:
+        std::byte const * data = {};
+        usize size = {};
+#if defined(_WIN32)
+        void * file_handle = {};
+        void * mapping_handle = {};
+#else
+        i32 file_descriptor = -1;
+#endif
+        void close();
+    };
+} // namespace ff
@@ -1,5 +1,7 @@
 #include "renderer.hpp"
 #include "../shared/shared.inl"
+#include "../thread_pool.hpp"
+#include <algorithm>
 #include <random>
 namespace ff
 {
@@ -15,7 +17,10 @@ namespace ff
 
     void Renderer::create_pipelines()
     {
-        pipelines.prepass = RasterPipeline({RasterPipelineCreateInfo{
+        PreciseStopwatch stopwatch = {};
+        std::vector<std::pair<RasterPipeline *, RasterPipelineCreateInfo>> raster_pipelines = {};
+        std::vector<std::pair<ComputePipeline *, ComputePipelineCreateInfo>> compute_pipelines = {};
+        raster_pipelines.push_back({&pipelines.prepass, RasterPipelineCreateInfo{
             .device = context->device,
             .vert_spirv_path = ".\\src\\shaders\\bin\\prepass.vert.spv",
             .frag_spirv_path = ".\\src\\shaders\\bin\\prepass.frag.spv",
@@ -33,7 +38,7 @@ namespace ff
             .name = "prepass pipeline",
         }});
 
-        pipelines.prepass_discard = RasterPipeline({RasterPipelineCreateInfo{
+        raster_pipelines.push_back({&pipelines.prepass_discard, RasterPipelineCreateInfo{
             .device = context->device,
             .vert_spirv_path = ".\\src\\shaders\\bin\\prepass.vert.spv",
             .frag_spirv_path = ".\\src\\shaders\\bin\\prepass_discard.frag.spv",
@@ -51,7 +56,7 @@ namespace ff
             .name = "prepass pipeline",
         }});
 
-        pipelines.shadowmap_pass = RasterPipeline({RasterPipelineCreateInfo{
+        raster_pipelines.push_back({&pipelines.shadowmap_pass, RasterPipelineCreateInfo{
             .device = context->device,
             .vert_spirv_path = ".\\src\\shaders\\bin\\shadow_pass.vert.spv",
             .frag_spirv_path = ".\\src\\shaders\\bin\\shadow_pass.frag.spv",
@@ -70,7 +75,7 @@ namespace ff
             .name = "shadow pass pipeline",
         }});
 
-        pipelines.shadowmap_pass_discard = RasterPipeline({RasterPipelineCreateInfo{
+        raster_pipelines.push_back({&pipelines.shadowmap_pass_discard, RasterPipelineCreateInfo{
             .device = context->device,
             .vert_spirv_path = ".\\src\\shaders\\bin\\shadow_pass.vert.spv",
             .frag_spirv_path = ".\\src\\shaders\\bin\\shadow_pass_discard.frag.spv",
@@ -89,7 +94,36 @@ namespace ff
             .name = "shadow pass discard pipeline",
         }});
 
-        pipelines.main_pass = RasterPipeline({RasterPipelineCreateInfo{
+        // The virtual shadow passes have no attachments, fragments write their depth into the physical pages
+        raster_pipelines.push_back({&pipelines.vsm_pass, RasterPipelineCreateInfo{
+            .device = context->device,
+            .vert_spirv_path = ".\\src\\shaders\\bin\\vsm_pass.vert.spv",
+            .frag_spirv_path = ".\\src\\shaders\\bin\\vsm_pass.frag.spv",
+            .raster_info = RasterInfo{
+                .face_culling = VK_CULL_MODE_BACK_BIT,
+                .front_face_winding = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                .depth_clamp_enable = true,
+            },
+            .entry_point = "main",
+            .push_constant_size = sizeof(VsmPassPC),
+            .name = "vsm pass pipeline",
+        }});
+
+        raster_pipelines.push_back({&pipelines.vsm_pass_discard, RasterPipelineCreateInfo{
+            .device = context->device,
+            .vert_spirv_path = ".\\src\\shaders\\bin\\vsm_pass.vert.spv",
+            .frag_spirv_path = ".\\src\\shaders\\bin\\vsm_pass_discard.frag.spv",
+            .raster_info = RasterInfo{
+                .face_culling = VK_CULL_MODE_BACK_BIT,
+                .front_face_winding = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                .depth_clamp_enable = true,
+            },
+            .entry_point = "main",
+            .push_constant_size = sizeof(VsmPassPC),
+            .name = "vsm pass discard pipeline",
+        }});
+
+        raster_pipelines.push_back({&pipelines.main_pass, RasterPipelineCreateInfo{
             .device = context->device,
             .vert_spirv_path = ".\\src\\shaders\\bin\\mesh_draw.vert.spv",
             .frag_spirv_path = ".\\src\\shaders\\bin\\mesh_draw.frag.spv",
@@ -110,7 +144,7 @@ namespace ff
             .name = "mesh draw pipeline",
         }});
 
-        pipelines.ssao_pass = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.ssao_pass, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\ssao.comp.spv",
             .entry_point = "main",
@@ -118,7 +152,7 @@ namespace ff
             .name = "ssao pipeline",
         }});
 
-        pipelines.fog_pass = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.fog_pass, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\fog_pass.comp.spv",
             .entry_point = "main",
@@ -126,7 +160,7 @@ namespace ff
             .name = "fog pass pipeline",
         }});
 
-        pipelines.first_depth_pass = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.first_depth_pass, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\minmax_first_pass.comp.spv",
             .entry_point = "main",
@@ -134,7 +168,7 @@ namespace ff
             .name = "first depth pass pipeline",
         }});
 
-        pipelines.subseq_depth_pass = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.subseq_depth_pass, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\minmax_subseq_pass.comp.spv",
             .entry_point = "main",
@@ -142,7 +176,7 @@ namespace ff
             .name = "subsequent depth pass pipeline",
         }});
 
-        pipelines.write_shadow_matrices = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.write_shadow_matrices, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\write_shadow_matrices.comp.spv",
             .entry_point = "main",
@@ -150,7 +184,7 @@ namespace ff
             .name = "write shadow matrices pipeline",
         }});
 
-        pipelines.first_esm_pass = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.first_esm_pass, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\esm_first_pass.comp.spv",
             .entry_point = "main",
@@ -158,19 +192,132 @@ namespace ff
             .name = "first esm pass pipeline",
         }});
 
-        pipelines.second_esm_pass = ComputePipeline({ComputePipelineCreateInfo{
+        compute_pipelines.push_back({&pipelines.second_esm_pass, ComputePipelineCreateInfo{
             .device = context->device,
             .comp_spirv_path = ".\\src\\shaders\\bin\\esm_second_pass.comp.spv",
             .entry_point = "main",
             .push_constant_size = sizeof(ESMShadowPC),
             .name = "second esm pass pipeline",
         }});
+
+        compute_pipelines.push_back({&pipelines.esm_scroll, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\esm_scroll.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(ESMScrollPC),
+            .name = "esm scroll pipeline",
+        }});
+
+        compute_pipelines.push_back({&pipelines.vsm_free_pages, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\vsm_free_pages.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(VsmPagesPC),
+            .name = "vsm free pages pipeline",
+        }});
+
+        compute_pipelines.push_back({&pipelines.vsm_mark_pages, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\vsm_mark_pages.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(VsmPagesPC),
+            .name = "vsm mark pages pipeline",
+        }});
+
+        compute_pipelines.push_back({&pipelines.vsm_allocate_pages, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\vsm_allocate_pages.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(VsmPagesPC),
+            .name = "vsm allocate pages pipeline",
+        }});
+
+        compute_pipelines.push_back({&pipelines.vsm_clear_pages, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\vsm_clear_pages.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(VsmPagesPC),
+            .name = "vsm clear pages pipeline",
+        }});
+
+        compute_pipelines.push_back({&pipelines.generate_draws, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\generate_draws.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(GenerateDrawsPC),
+            .name = "generate draws pipeline",
+        }});
+
+        compute_pipelines.push_back({&pipelines.hiz_generate, ComputePipelineCreateInfo{
+            .device = context->device,
+            .comp_spirv_path = ".\\src\\shaders\\bin\\hiz_generate.comp.spv",
+            .entry_point = "main",
+            .push_constant_size = sizeof(HizGeneratePC),
+            .name = "hiz generate pipeline",
+        }});
+
+        /// NOTE: The pipelines do not depend on each other and the driver compiles them independently, so they are
+        //        created in parallel. The pipeline cache is internally synchronized.
+        u32 const pipeline_count = static_cast<u32>(raster_pipelines.size() + compute_pipelines.size());
+        ThreadPool thread_pool{std::min(pipeline_count, std::max(std::thread::hardware_concurrency(), 1u))};
+        thread_pool.parallel_for(pipeline_count, [&](u32 task_index, u32 thread_index)
+        {
+            if (task_index < raster_pipelines.size())
+            {
+                auto & [pipeline, create_info] = raster_pipelines.at(task_index);
+                *pipeline = RasterPipeline(create_info);
+            }
+            else
+            {
+                auto & [pipeline, create_info] = compute_pipelines.at(task_index - raster_pipelines.size());
+                *pipeline = ComputePipeline(create_info);
+            }
+        });
+        context->device->save_pipeline_cache();
+        BACKEND_LOG(fmt::format("[INFO][Renderer::create_pipelines()] Created {} pipelines on {} threads in {}ms",
+                                pipeline_count, thread_pool.get_thread_count(), stopwatch.elapsed_time<f32, std::chrono::milliseconds>()));
     }
 
 	void Renderer::change_fsr_scaling(f32 new_scaling)
     {
         curr_fsr_factor = new_scaling;
         resize();
+        // The material lod bias follows the render resolution
+        context->device->destroy_sampler(repeat_sampler);
+        create_repeat_sampler();
+    }
+
+    auto Renderer::get_material_lod_bias() const -> f32
+    {
+        return std::log2(1.0f / curr_fsr_factor) - 1.0f;
+    }
+
+    void Renderer::create_repeat_sampler()
+    {
+        repeat_sampler = context->device->create_sampler({
+            .address_mode_u = VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .address_mode_v = VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .mip_lod_bias = get_material_lod_bias(),
+            .enable_anisotropy = true,
+            .max_anisotropy = 16.0f,
+            .name = "repeat sampler",
+        });
+    }
+
+    auto Renderer::get_texture_feedback() const -> std::span<TextureFeedback const>
+    {
+        return texture_feedback;
+    }
+
+    void Renderer::invalidate_shadow_cache()
+    {
+        shadow_cache_valid = false;
+        virtual_shadow_cache_valid = false;
+    }
+
+    auto Renderer::get_last_frame_allocation_statistics() const -> AllocationStatistics const &
+    {
+        return last_frame_allocation_statistics;
     }
 
     void Renderer::create_resolution_dep_resources()
@@ -250,18 +397,25 @@ namespace ff
             .size = static_cast<u32>(sizeof(DepthLimits) * limits_size.x * limits_size.y),
             .name = "depth limits",
         });
+
+        // Hi-Z levels, see HizTexel in shared.inl, followed by the counter of the downsampler
+        usize hiz_texel_count = 0;
+        u32vec2 hiz_level_size = {render_resolution.width, render_resolution.height};
+        do
+        {
+            hiz_level_size = (hiz_level_size + 1u) / 2u;
+            hiz_texel_count += hiz_level_size.x * hiz_level_size.y;
+        } while (hiz_level_size.x > 1 || hiz_level_size.y > 1);
+        buffers.hiz = context->device->create_buffer({
+            .size = sizeof(HizTexel) * hiz_texel_count + sizeof(SpdCounter),
+            .name = "hiz",
+        });
+        hiz_valid = false;
     }
 
     void Renderer::create_resolution_indep_resources()
     {
-        repeat_sampler = context->device->create_sampler({
-            .address_mode_u = VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            .address_mode_v = VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            .mip_lod_bias = std::log2(1.0f / curr_fsr_factor) - 1.0f,
-            .enable_anisotropy = true,
-            .max_anisotropy = 16.0f,
-            .name = "repeat sampler",
-        });
+        create_repeat_sampler();
 
         clamp_sampler = context->device->create_sampler({
             .address_mode_u = VkSamplerAddressMode::VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
@@ -290,6 +444,37 @@ namespace ff
             .name = "shadowmap cascade data",
         });
 
+        buffers.cascade_cache = context->device->create_buffer({
+            .size = sizeof(ShadowCascadeCache) * NUM_CASCADES,
+            .name = "shadowmap cascade cache",
+        });
+
+        // One slot per frame in flight, the clip levels follow the camera
+        buffers.vsm_clip_levels = context->device->create_buffer({
+            .size = sizeof(VsmClipLevel) * VSM_CLIP_LEVEL_COUNT * (FRAMES_IN_FLIGHT + 1),
+            .name = "vsm clip levels",
+        });
+
+        buffers.vsm_page_table = context->device->create_buffer({
+            .size = sizeof(VsmPageTableEntry) * VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * VSM_CLIP_LEVEL_COUNT,
+            .name = "vsm page table",
+        });
+
+        buffers.vsm_physical_pages = context->device->create_buffer({
+            .size = sizeof(VsmPhysicalPage) * VSM_PHYSICAL_PAGE_COUNT,
+            .name = "vsm physical pages",
+        });
+
+        buffers.vsm_physical_texels = context->device->create_buffer({
+            .size = sizeof(VsmPhysicalTexel) * VSM_PAGE_SIZE * VSM_PAGE_SIZE * VSM_PHYSICAL_PAGE_COUNT,
+            .name = "vsm physical texels",
+        });
+
+        buffers.vsm_state = context->device->create_buffer({
+            .size = sizeof(VsmState),
+            .name = "vsm state",
+        });
+
         // Shadowmap textures
         DBG_ASSERT_TRUE_M(NUM_CASCADES <= 8, "[ERROR][Renderer::create_resolution_indep_resources()] More than 8 cascades not supported");
         auto const resolution_multiplier = resolution_table[NUM_CASCADES - 1];
@@ -327,7 +512,7 @@ namespace ff
         std::mt19937 engine = std::mt19937(747474);
         std::uniform_real_distribution distribution = std::uniform_real_distribution<f32>(0.0, 1.0);
         std::uniform_real_distribution distribution_z = std::uniform_real_distribution<f32>(0.2, 1.0);
-        BufferId ssao_kernel_staging = {};
+        StagingAllocation ssao_kernel_staging = {};
         {
             DBG_ASSERT_TRUE_M(sizeof(SSAOKernel) == sizeof(f32vec3), "SSAO Kernel was changed from f32vec3 -> ssao_kernel vector needs to be updated too");
             std::vector<f32vec3> ssao_kernel = {};
@@ -348,18 +533,12 @@ namespace ff
                 ssao_kernel.emplace_back(weighed_random_sample);
             }
 
-            ssao_kernel_staging = context->device->create_buffer({
-                .size = sizeof(SSAOKernel) * SSAO_KERNEL_SAMPLE_COUNT,
-                .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
-                .name = "SSAO kernel staging",
-            });
-
-            void * staging_ptr = context->device->get_buffer_host_pointer(ssao_kernel_staging);
-            std::memcpy(staging_ptr, ssao_kernel.data(), sizeof(SSAOKernel) * SSAO_KERNEL_SAMPLE_COUNT);
+            ssao_kernel_staging = context->device->allocate_staging(sizeof(SSAOKernel) * SSAO_KERNEL_SAMPLE_COUNT).value();
+            std::memcpy(ssao_kernel_staging.host_address, ssao_kernel.data(), sizeof(SSAOKernel) * SSAO_KERNEL_SAMPLE_COUNT);
         }
 
         // SSAO KERNEL NOISE
-        BufferId ssao_kernel_noise_staging = {};
+        StagingAllocation ssao_kernel_noise_staging = {};
         {
             std::vector<f32vec4> ssao_kernel_noise = {};
             ssao_kernel_noise.reserve(SSAO_KERNEL_NOISE_SIZE * SSAO_KERNEL_NOISE_SIZE);
@@ -371,11 +550,7 @@ namespace ff
                     distribution(engine) * 2.0f - 1.0f,
                     0.0f);
             }
-            ssao_kernel_noise_staging = context->device->create_buffer({
-                .size = sizeof(f32vec4) * SSAO_KERNEL_NOISE_SIZE * SSAO_KERNEL_NOISE_SIZE,
-                .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-                .name = "SSAO kernel noise staging",
-            });
+            ssao_kernel_noise_staging = context->device->allocate_staging(sizeof(f32vec4) * SSAO_KERNEL_NOISE_SIZE * SSAO_KERNEL_NOISE_SIZE).value();
 
             // TODO(msakmary) change this to be a buffer
             images.ssao_kernel_noise = context->device->create_image({
@@ -387,12 +562,11 @@ namespace ff
                 .name = "ssao kernel noise",
             });
 
-            void * staging_ptr = context->device->get_buffer_host_pointer(ssao_kernel_noise_staging);
-            std::memcpy(staging_ptr, ssao_kernel_noise.data(), sizeof(f32vec4) * SSAO_KERNEL_NOISE_SIZE * SSAO_KERNEL_NOISE_SIZE);
+            std::memcpy(ssao_kernel_noise_staging.host_address, ssao_kernel_noise.data(), sizeof(f32vec4) * SSAO_KERNEL_NOISE_SIZE * SSAO_KERNEL_NOISE_SIZE);
         }
 
         // LIGHTS
-        BufferId lights_info_staging = {};
+        StagingAllocation lights_info_staging = {};
         {
             std::vector<LightInfo> info = {};
             info.reserve(MAX_NUM_LIGHTS);
@@ -468,20 +642,17 @@ namespace ff
                 .name = "Lights info",
             });
 
-            lights_info_staging = context->device->create_buffer({
-                .size = sizeof(LightInfo) * MAX_NUM_LIGHTS,
-                .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
-                .name = "Lights info staging",
-            });
-            void * staging_ptr = context->device->get_buffer_host_pointer(lights_info_staging);
-            std::memcpy(staging_ptr, info.data(), sizeof(LightInfo) * MAX_NUM_LIGHTS);
+            lights_info_staging = context->device->allocate_staging(sizeof(LightInfo) * MAX_NUM_LIGHTS).value();
+            std::memset(lights_info_staging.host_address, 0, lights_info_staging.size);
+            std::memcpy(lights_info_staging.host_address, info.data(), sizeof(LightInfo) * info.size());
         }
         auto resource_update_command_buffer = CommandBuffer(context->device);
         resource_update_command_buffer.begin();
         // Fill kernel buffer
         {
             resource_update_command_buffer.cmd_copy_buffer_to_buffer({
-                .src_buffer = ssao_kernel_staging,
+                .src_buffer = ssao_kernel_staging.buffer_id,
+                .src_offset = static_cast<u32>(ssao_kernel_staging.offset),
                 .dst_buffer = buffers.ssao_kernel,
                 .size = static_cast<u32>(sizeof(SSAOKernel) * SSAO_KERNEL_SAMPLE_COUNT),
             });
@@ -499,7 +670,8 @@ namespace ff
                 .image_id = images.ssao_kernel_noise,
             });
             resource_update_command_buffer.cmd_copy_buffer_to_image({
-                .buffer_id = ssao_kernel_noise_staging,
+                .buffer_id = ssao_kernel_noise_staging.buffer_id,
+                .buffer_offset = ssao_kernel_noise_staging.offset,
                 .image_id = images.ssao_kernel_noise,
                 .image_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                 .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
@@ -519,7 +691,8 @@ namespace ff
         }
         {
             resource_update_command_buffer.cmd_copy_buffer_to_buffer({
-                .src_buffer = lights_info_staging,
+                .src_buffer = lights_info_staging.buffer_id,
+                .src_offset = static_cast<u32>(lights_info_staging.offset),
                 .dst_buffer = buffers.lights_info,
                 .size = static_cast<u32>(sizeof(LightInfo) * MAX_NUM_LIGHTS),
             });
@@ -527,9 +700,6 @@ namespace ff
         resource_update_command_buffer.end();
         auto recorded_command_buffer = resource_update_command_buffer.get_recorded_command_buffer();
         context->device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        context->device->destroy_buffer(ssao_kernel_staging);
-        context->device->destroy_buffer(ssao_kernel_noise_staging);
-        context->device->destroy_buffer(lights_info_staging);
         context->device->wait_idle();
         context->device->cleanup_resources();
     }
@@ -544,6 +714,7 @@ namespace ff
         context->device->destroy_image(images.fsr_target);
         context->device->destroy_image(images.motion_vectors);
         context->device->destroy_buffer(buffers.depth_limits);
+        context->device->destroy_buffer(buffers.hiz);
         auto const swapchain_extent = context->swapchain->surface_extent;
         create_resolution_dep_resources();
     }
@@ -558,6 +729,29 @@ namespace ff
             1.0f));
         auto swapchain_image = context->swapchain->acquire_next_image();
         u32 const fif_index = frame_index % (FRAMES_IN_FLIGHT + 1);
+        // The swapchain acquire waited for the frame which last used this slot
+        context->device->begin_gpu_profiler_frame(fif_index);
+        /// NOTE: Every frame slot has its own range of the texture feedback buffer. The range is read back before it
+        //        is cleared for this frame, so it holds the feedback of the frame which last used the slot.
+        if (std::max(draw_commands.material_count, 1u) > texture_feedback_material_capacity)
+        {
+            if (texture_feedback_material_capacity > 0)
+            {
+                context->device->destroy_buffer(buffers.texture_feedback);
+            }
+            texture_feedback_material_capacity = std::max(draw_commands.material_count, 1u);
+            usize const texture_feedback_size = sizeof(TextureFeedback) * texture_feedback_material_capacity * (FRAMES_IN_FLIGHT + 1);
+            buffers.texture_feedback = context->device->create_buffer({
+                .size = texture_feedback_size,
+                .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+                .name = "texture feedback",
+            });
+            std::memset(context->device->get_buffer_host_pointer(buffers.texture_feedback), 0, texture_feedback_size);
+        }
+        usize const texture_feedback_offset = sizeof(TextureFeedback) * texture_feedback_material_capacity * fif_index;
+        auto const * const texture_feedback_slot = reinterpret_cast<TextureFeedback const *>(
+            reinterpret_cast<std::byte const *>(context->device->get_buffer_host_pointer(buffers.texture_feedback)) + texture_feedback_offset);
+        texture_feedback.assign(texture_feedback_slot, texture_feedback_slot + draw_commands.material_count);
 
         auto command_buffer = CommandBuffer(context->device);
         auto const & swapchain_extent = context->device->info_image(swapchain_image).extent;
@@ -577,12 +771,7 @@ namespace ff
             camera_info.proj : 
             glm::translate(glm::identity<f32mat4x4>(), jitter_vec) * camera_info.proj;
 
-        auto camera_info_staging_buffer = context->device->create_buffer({
-            .size = sizeof(CameraInfoBuf),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "camera info staging",
-        });
-        void * staging_memory = context->device->get_buffer_host_pointer(camera_info_staging_buffer);
+        StagingAllocation const camera_info_staging = context->device->allocate_staging(sizeof(CameraInfoBuf)).value();
         CameraInfoBuf curr_frame_camera = {
             .position = camera_info.pos,
             .frust_right_offset = camera_info.frust_right_offset,
@@ -599,18 +788,25 @@ namespace ff
             .prev_view_projection = prev_view_projection,
             .jittered_view_projection = jittered_projection * camera_info.view,
         };
-        std::memcpy(staging_memory, &curr_frame_camera, sizeof(CameraInfoBuf));
+        std::memcpy(camera_info_staging.host_address, &curr_frame_camera, sizeof(CameraInfoBuf));
+
+        bool const use_virtual_shadows = draw_commands.virtual_shadows != 0;
+        VkDeviceAddress const vsm_clip_levels_address =
+            context->device->get_buffer_device_address(buffers.vsm_clip_levels) + sizeof(VsmClipLevel) * VSM_CLIP_LEVEL_COUNT * fif_index;
 
         DrawPc draw_push = DrawPc{
             .scene_descriptor = draw_commands.scene_descriptor,
             .camera_info = context->device->get_buffer_device_address(buffers.camera_info),
             .cascade_data = context->device->get_buffer_device_address(buffers.cascade_data),
             .lights_info = context->device->get_buffer_device_address(buffers.lights_info),
+            .texture_feedback = context->device->get_buffer_device_address(buffers.texture_feedback) + texture_feedback_offset,
+            .vsm_clip_levels = vsm_clip_levels_address,
+            .vsm_page_table = context->device->get_buffer_device_address(buffers.vsm_page_table),
+            .vsm_physical_texels = context->device->get_buffer_device_address(buffers.vsm_physical_texels),
             .ss_normals_index = images.ss_normals.index,
             .ssao_index = images.ambient_occlusion.index,
             .esm_shadowmap_index = images.esm_cascades.index,
             .fif_index = fif_index,
-            .mesh_index = {},
             .sampler_id = repeat_sampler.index,
             .shadow_sampler_id = clamp_sampler.index,
             .sun_direction = sun_direction,
@@ -620,29 +816,327 @@ namespace ff
             .no_shadows = draw_commands.no_shadows,
             .no_normal_maps = draw_commands.no_normal_maps,
             .curr_num_lights = curr_num_lights,
+            .virtual_shadows = use_virtual_shadows ? 1u : 0u,
         };
-        auto record_mesh_draw_commands = [&](auto const & commands)
+        /// NOTE: The draw lists are rewritten every frame by the generate draws pass, the buffers only grow when the
+        //        scene gets more meshes or instances than they can currently hold. Each draw list is laid out as
+        //        [DrawListHeader | commands of all lists | visible instances | occluded counts]. The camera draw list
+        //        contains the instances which passed the first occlusion culling phase, the occlusion draw list the
+        //        ones which were only found visible in the second phase. Every shadow cascade has its own draw list
+        //        culled against the cascade, as shadow casters can lie outside of the camera frustum, and so has every
+        //        clip level of the virtual shadow map. Each mesh can
+        //        emit one command per lod. The camera draw lists are additionally cluster culled and hold the indices
+        //        of the visible clusters, see DRAW_LIST_COMMANDS_OFFSET. Their culled indices are sized for the most
+        //        detailed lod of every instance.
+        u32 const mesh_count = draw_commands.mesh_count;
+        u32 const instance_count = draw_commands.instance_count;
+        u32 const cluster_work_capacity = std::max(draw_commands.cluster_batch_count, 1u);
+        u32 const culled_index_capacity = static_cast<u32>(std::clamp(draw_commands.cluster_index_count, usize(1), usize(CLUSTER_CULLED_INDEX_CAPACITY)));
+        /// NOTE: Shadow cascades are cached across frames, see ShadowCascadeCache. Their contents are discarded
+        //        together with the cache when it is invalidated, the esm passes then filter every texel again. The
+        //        pages of the virtual shadow map are cached the same way. Only the cache of the shadows used this
+        //        frame is rebuilt, the other one stays invalid until it is used again.
+        if (mesh_count != shadow_cache_mesh_count || instance_count != shadow_cache_instance_count)
+        {
+            shadow_cache_mesh_count = mesh_count;
+            shadow_cache_instance_count = instance_count;
+            shadow_cache_valid = false;
+            virtual_shadow_cache_valid = false;
+        }
+        bool const invalidate_shadow_cache = !shadow_cache_valid;
+        bool const invalidate_virtual_shadow_cache = !virtual_shadow_cache_valid;
+        if (use_virtual_shadows)
+        {
+            virtual_shadow_cache_valid = true;
+        }
+        else
+        {
+            shadow_cache_valid = true;
+        }
+        /// NOTE: The clip levels of the virtual shadow map use the rotation only light space of the shadow cascades.
+        //        Their origins are snapped to whole pages so that cached pages keep their texels while the camera
+        //        moves, the depth range is snapped to half of its extent. It is only recentered once the camera moved
+        //        more than one snapping step away from its center, so moving back and forth around a step boundary
+        //        does not drop all cached pages every time.
+        std::array<VsmClipLevel, VSM_CLIP_LEVEL_COUNT> vsm_clip_levels = {};
+        if (use_virtual_shadows)
         {
-            for (auto const & draw_command : commands)
+            f32vec3 const light_front = -sun_direction;
+            f32vec3 const light_right = glm::normalize(glm::cross(light_front, f32vec3(0.0f, 0.0f, 1.0f)));
+            f32vec3 const light_up = glm::normalize(glm::cross(light_front, light_right));
+            f32mat3x3 const light_rotation = f32mat3x3(light_right, light_up, light_front);
+            f32vec3 const light_space_camera = glm::transpose(light_rotation) * camera_info.pos;
+            f32 const depth_step = 0.5f * VSM_DEPTH_EXTENT;
+            f32 depth_center = vsm_depth_center;
+            if (invalidate_virtual_shadow_cache || std::abs(light_space_camera.z - vsm_depth_center) > depth_step)
             {
-                draw_push.mesh_index = draw_command.mesh_idx;
-                command_buffer.cmd_set_push_constant(draw_push);
-
-                command_buffer.cmd_draw_indexed({
-                    .index_count = draw_command.index_count,
-                    .instance_count = draw_command.instance_count,
-                    .first_index = draw_command.index_offset,
-                    .vertex_offset = 0,
-                    .first_instance = 0,
+                depth_center = std::round(light_space_camera.z / depth_step) * depth_step;
+            }
+            for (u32 clip_level = 0; clip_level < VSM_CLIP_LEVEL_COUNT; clip_level++)
+            {
+                f32 const level_extent = VSM_FIRST_LEVEL_EXTENT * std::exp2(static_cast<f32>(clip_level));
+                f32 const page_extent = level_extent / VSM_PAGE_TABLE_RESOLUTION;
+                i32vec2 const origin_page = i32vec2(glm::floor(f32vec2(light_space_camera) / page_extent)) - VSM_PAGE_TABLE_RESOLUTION / 2;
+                f32vec2 const level_min = f32vec2(origin_page) * page_extent;
+                f32vec2 const level_max = level_min + level_extent;
+                f32 const near_depth = depth_center - VSM_DEPTH_EXTENT;
+                f32 const far_plane = 2.0f * VSM_DEPTH_EXTENT;
+
+                // Same orthographic projection as the shadow cascades, the near plane is at zero
+                f32mat4x4 view = f32mat4x4(glm::transpose(light_rotation));
+                view[3] = f32vec4(0.0f, 0.0f, -near_depth, 1.0f);
+                f32mat4x4 const projection = f32mat4x4(
+                    f32vec4(2.0f / (level_max.x - level_min.x), 0.0f, 0.0f, 0.0f),
+                    f32vec4(0.0f, 2.0f / (level_max.y - level_min.y), 0.0f, 0.0f),
+                    f32vec4(0.0f, 0.0f, 1.0f / far_plane, 0.0f),
+                    f32vec4((level_min.x + level_max.x) / (level_min.x - level_max.x), (level_min.y + level_max.y) / (level_min.y - level_max.y), 0.0f, 1.0f));
+                vsm_clip_levels.at(clip_level) = VsmClipLevel{
+                    .view = view,
+                    .projection = projection,
+                    .origin_page = origin_page,
+                    .prev_origin_page = vsm_origin_pages.at(clip_level),
+                    .invalidate = (invalidate_virtual_shadow_cache || depth_center != vsm_depth_center) ? 1u : 0u,
+                };
+                vsm_origin_pages.at(clip_level) = origin_page;
+            }
+            vsm_depth_center = depth_center;
+        }
+        if (std::max(mesh_count, 1u) > draw_list_mesh_capacity || std::max(instance_count, 1u) > draw_list_instance_capacity ||
+            cluster_work_capacity > draw_list_cluster_work_capacity || culled_index_capacity > draw_list_culled_index_capacity)
+        {
+            if (draw_list_mesh_capacity > 0)
+            {
+                context->device->destroy_buffer(buffers.draw_list);
+                context->device->destroy_buffer(buffers.occlusion_draw_list);
+                for (BufferId const shadow_draw_list : buffers.shadow_draw_lists)
+                {
+                    context->device->destroy_buffer(shadow_draw_list);
+                }
+                for (BufferId const vsm_draw_list : buffers.vsm_draw_lists)
+                {
+                    context->device->destroy_buffer(vsm_draw_list);
+                }
+            }
+            draw_list_mesh_capacity = std::max(mesh_count, draw_list_mesh_capacity);
+            draw_list_mesh_capacity = std::max(draw_list_mesh_capacity, 1u);
+            draw_list_instance_capacity = std::max(instance_count, draw_list_instance_capacity);
+            draw_list_instance_capacity = std::max(draw_list_instance_capacity, 1u);
+            draw_list_cluster_work_capacity = std::max(cluster_work_capacity, draw_list_cluster_work_capacity);
+            draw_list_culled_index_capacity = std::max(culled_index_capacity, draw_list_culled_index_capacity);
+            usize const draw_list_size =
+                DRAW_LIST_COMMANDS_OFFSET +
+                sizeof(DrawIndexedIndirectCommand) * DRAW_LIST_SLOT_COUNT * (MAX_MESH_LODS * draw_list_mesh_capacity + draw_list_cluster_work_capacity) +
+                sizeof(DrawIndexedIndirectCommand) * DRAW_LIST_COUNT * draw_list_cluster_work_capacity +
+                sizeof(VisibleInstance) * draw_list_instance_capacity +
+                sizeof(OccludedInstanceCount) * draw_list_mesh_capacity;
+            usize const cluster_culled_draw_list_size =
+                draw_list_size +
+                sizeof(ClusterCullWork) * draw_list_cluster_work_capacity +
+                sizeof(u32) * draw_list_culled_index_capacity;
+            buffers.draw_list = context->device->create_buffer({
+                .size = cluster_culled_draw_list_size,
+                .name = "draw list",
+            });
+            buffers.occlusion_draw_list = context->device->create_buffer({
+                .size = cluster_culled_draw_list_size,
+                .name = "occlusion draw list",
+            });
+            for (u32 cascade = 0; cascade < NUM_CASCADES; cascade++)
+            {
+                buffers.shadow_draw_lists.at(cascade) = context->device->create_buffer({
+                    .size = draw_list_size,
+                    .name = fmt::format("shadow draw list {}", cascade),
+                });
+            }
+            for (u32 clip_level = 0; clip_level < VSM_CLIP_LEVEL_COUNT; clip_level++)
+            {
+                buffers.vsm_draw_lists.at(clip_level) = context->device->create_buffer({
+                    .size = draw_list_size,
+                    .name = fmt::format("vsm draw list {}", clip_level),
+                });
+            }
+        }
+        // With cluster culling every work item can emit a fallback command drawn from the scene index pools
+        u32 const command_capacity = MAX_MESH_LODS * mesh_count + cluster_work_capacity;
+        usize const cluster_commands_offset = DRAW_LIST_COMMANDS_OFFSET + sizeof(DrawIndexedIndirectCommand) * DRAW_LIST_SLOT_COUNT * command_capacity;
+        usize const visible_instances_offset = cluster_commands_offset + sizeof(DrawIndexedIndirectCommand) * DRAW_LIST_COUNT * cluster_work_capacity;
+        usize const occluded_counts_offset = visible_instances_offset + sizeof(VisibleInstance) * instance_count;
+        usize const cluster_work_offset = occluded_counts_offset + sizeof(OccludedInstanceCount) * mesh_count;
+        usize const culled_indices_offset = cluster_work_offset + sizeof(ClusterCullWork) * cluster_work_capacity;
+        auto is_cluster_culled = [&](BufferId draw_list) -> bool
+        {
+            return draw_list == buffers.draw_list || draw_list == buffers.occlusion_draw_list;
+        };
+        auto get_visible_instances_address = [&](BufferId draw_list) -> VkDeviceAddress
+        {
+            return context->device->get_buffer_device_address(draw_list) + visible_instances_offset;
+        };
+        auto get_occluded_counts_address = [&](BufferId draw_list) -> VkDeviceAddress
+        {
+            return context->device->get_buffer_device_address(draw_list) + occluded_counts_offset;
+        };
+        /// NOTE: Binds the index pools themselves, each pool draws the slot of the list with its index format. The
+        //        cluster culled commands index into the culled indices of the draw list.
+        auto record_indirect_draws = [&](BufferId draw_list, u32 draw_list_index)
+        {
+            for (u32 index_format = 0; index_format < MESH_INDEX_FORMAT_COUNT; index_format++)
+            {
+                u32 const slot = index_format * DRAW_LIST_COUNT + draw_list_index;
+                command_buffer.cmd_set_index_buffer({
+                    .buffer_id = index_format == MESH_INDEX_FORMAT_U16 ? draw_commands.index_buffer_16_id : draw_commands.index_buffer_id,
+                    .offset = 0,
+                    .index_type = index_format == MESH_INDEX_FORMAT_U16 ? VkIndexType::VK_INDEX_TYPE_UINT16 : VkIndexType::VK_INDEX_TYPE_UINT32,
+                });
+                command_buffer.cmd_draw_indexed_indirect_count({
+                    .draw_buffer = draw_list,
+                    .draw_buffer_offset = DRAW_LIST_COMMANDS_OFFSET + sizeof(DrawIndexedIndirectCommand) * slot * command_capacity,
+                    .count_buffer = draw_list,
+                    .count_buffer_offset = offsetof(DrawListHeader, draw_counts) + sizeof(u32) * slot,
+                    .max_draw_count = command_capacity,
+                });
+            }
+            if (is_cluster_culled(draw_list))
+            {
+                command_buffer.cmd_set_index_buffer({
+                    .buffer_id = draw_list,
+                    .offset = static_cast<u32>(culled_indices_offset),
+                    .index_type = VkIndexType::VK_INDEX_TYPE_UINT32,
+                });
+                command_buffer.cmd_draw_indexed_indirect_count({
+                    .draw_buffer = draw_list,
+                    .draw_buffer_offset = cluster_commands_offset + sizeof(DrawIndexedIndirectCommand) * draw_list_index * cluster_work_capacity,
+                    .count_buffer = draw_list,
+                    .count_buffer_offset = offsetof(DrawListHeader, cluster_draw_counts) + sizeof(u32) * draw_list_index,
+                    .max_draw_count = cluster_work_capacity,
+                });
+            }
+        };
+        /// NOTE: One workgroup per mesh, each workgroup culls and compacts the instances of its mesh. Cluster culled
+        //        draw lists are followed by the cluster pass, dispatched with the work items the first dispatch wrote.
+        auto record_generate_draws = [&](BufferId draw_list, u32 frustum, u32 cascade_index, u32 occlusion_phase)
+        {
+            GenerateDrawsPC generate_draws_pc = {
+                .scene_descriptor = draw_commands.scene_descriptor,
+                .mesh_draw_infos = context->device->get_buffer_device_address(draw_commands.mesh_draw_infos),
+                .draw_list = context->device->get_buffer_device_address(draw_list),
+                .visible_instances = get_visible_instances_address(draw_list),
+                .camera_info = context->device->get_buffer_device_address(buffers.camera_info),
+                .shadow_data = frustum == GENERATE_DRAWS_FRUSTUM_VIRTUAL_SHADOW
+                                   ? vsm_clip_levels_address
+                                   : context->device->get_buffer_device_address(buffers.cascade_data),
+                .shadow_state = frustum == GENERATE_DRAWS_FRUSTUM_VIRTUAL_SHADOW
+                                    ? context->device->get_buffer_device_address(buffers.vsm_state)
+                                    : context->device->get_buffer_device_address(buffers.cascade_cache),
+                .hiz = context->device->get_buffer_device_address(buffers.hiz),
+                .occluded_instances = get_visible_instances_address(buffers.draw_list),
+                .occluded_counts = occlusion_phase == GENERATE_DRAWS_OCCLUSION_SECOND_PHASE
+                                       ? get_occluded_counts_address(buffers.draw_list)
+                                       : get_occluded_counts_address(draw_list),
+                .depth_dimensions = {render_resolution.width, render_resolution.height},
+                .fif_index = fif_index,
+                .command_capacity = command_capacity,
+                .cluster_work_offset = static_cast<u32>(cluster_work_offset),
+                .cluster_work_capacity = cluster_work_capacity,
+                .culled_indices_offset = static_cast<u32>(culled_indices_offset),
+                .culled_index_capacity = culled_index_capacity,
+                .frustum = frustum,
+                .cascade_index = cascade_index,
+                .occlusion_phase = occlusion_phase,
+                .cluster_culling = is_cluster_culled(draw_list) ? u32(GENERATE_DRAWS_CLUSTER_CULLING_INSTANCES) : u32(GENERATE_DRAWS_NO_CLUSTER_CULLING),
+            };
+            command_buffer.cmd_set_compute_pipeline(pipelines.generate_draws);
+            command_buffer.cmd_set_push_constant(generate_draws_pc);
+            command_buffer.cmd_dispatch({.x = mesh_count, .y = 1, .z = 1});
+            if (is_cluster_culled(draw_list))
+            {
+                command_buffer.cmd_memory_barrier({
+                    .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                    .dst_stages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .dst_access = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                });
+                generate_draws_pc.cluster_culling = GENERATE_DRAWS_CLUSTER_CULLING_CLUSTERS;
+                command_buffer.cmd_set_push_constant(generate_draws_pc);
+                command_buffer.cmd_dispatch_indirect({
+                    .dispatch_buffer = draw_list,
+                    .offset = offsetof(DrawListHeader, cluster_cull_dispatch),
+                });
+            }
+        };
+        /// NOTE: Depth has to be in SHADER_READ_ONLY_OPTIMAL. A single dispatch builds the whole pyramid unless the
+        //        depth is larger than SPD_TILE_SIZE * SPD_TILE_SIZE, then every dispatch continues from the last level
+        //        of the previous one.
+        auto record_build_hiz = [&]()
+        {
+            u32vec2 const depth_dimensions = {render_resolution.width, render_resolution.height};
+            usize hiz_texel_count = 0;
+            u32 hiz_level_count = 0;
+            u32vec2 level_size = depth_dimensions;
+            do
+            {
+                level_size = (level_size + 1u) / 2u;
+                hiz_texel_count += level_size.x * level_size.y;
+                hiz_level_count += 1;
+            } while (level_size.x > 1 || level_size.y > 1);
+            usize const counter_offset = sizeof(HizTexel) * hiz_texel_count;
+            // The downsampler resets the counter itself, it only has to be cleared once after the buffer was created
+            if (!hiz_valid)
+            {
+                command_buffer.cmd_fill_buffer({
+                    .buffer_id = buffers.hiz,
+                    .offset = counter_offset,
+                    .size = sizeof(SpdCounter),
+                    .data = 0,
+                });
+                command_buffer.cmd_memory_barrier({
+                    .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                    .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                });
+            }
+            command_buffer.cmd_set_compute_pipeline(pipelines.hiz_generate);
+            VkDeviceAddress const hiz_address = context->device->get_buffer_device_address(buffers.hiz);
+            u32 base_level = 0;
+            u32vec2 base_level_size = depth_dimensions;
+            while (base_level < hiz_level_count)
+            {
+                bool const fits_single_dispatch = std::max(base_level_size.x, base_level_size.y) <= SPD_TILE_SIZE * SPD_TILE_SIZE;
+                u32 const level_count = std::min(hiz_level_count - base_level, (fits_single_dispatch ? 2u : 1u) * SPD_TILE_LEVEL_COUNT);
+                command_buffer.cmd_set_push_constant(HizGeneratePC{
+                    .hiz = hiz_address,
+                    .counter = hiz_address + counter_offset,
+                    .depth_dimensions = depth_dimensions,
+                    .depth_index = images.depth.index,
+                    .sampler_id = no_mip_sampler.index,
+                    .base_level = base_level,
+                    .level_count = level_count,
+                });
+                command_buffer.cmd_dispatch({
+                    .x = (base_level_size.x + SPD_TILE_SIZE - 1) / SPD_TILE_SIZE,
+                    .y = (base_level_size.y + SPD_TILE_SIZE - 1) / SPD_TILE_SIZE,
+                    .z = 1,
+                });
+                command_buffer.cmd_memory_barrier({
+                    .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                    .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
                 });
+                for (u32 level = 0; level < level_count; level++)
+                {
+                    base_level_size = (base_level_size + 1u) / 2u;
+                }
+                base_level += level_count;
             }
         };
         command_buffer.begin();
+        command_buffer.begin_zone("frame");
         // COPY CAMERA INFO
         {
             command_buffer.cmd_copy_buffer_to_buffer({
-                .src_buffer = camera_info_staging_buffer,
-                .src_offset = 0,
+                .src_buffer = camera_info_staging.buffer_id,
+                .src_offset = static_cast<u32>(camera_info_staging.offset),
                 .dst_buffer = buffers.camera_info,
                 .dst_offset = static_cast<u32>(sizeof(CameraInfoBuf) * fif_index),
                 .size = static_cast<u32>(sizeof(CameraInfoBuf)),
@@ -654,13 +1148,79 @@ namespace ff
                 .dst_access = VK_ACCESS_2_SHADER_READ_BIT,
             });
         }
+        // CLEAR TEXTURE FEEDBACK
+        {
+            command_buffer.cmd_fill_buffer({
+                .buffer_id = buffers.texture_feedback,
+                .offset = texture_feedback_offset,
+                .size = sizeof(TextureFeedback) * texture_feedback_material_capacity,
+                .data = 0,
+            });
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+        }
+        // GENERATE DRAWS
+        {
+            command_buffer.begin_zone("generate draws");
+            // The previous frame might still be reading the draw lists as indirect arguments, culled indices and visible
+            // instances, its Hi-Z pyramid writes have to be visible to the first occlusion culling phase
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_READ_BIT,
+            });
+            auto clear_draw_list = [&](BufferId draw_list)
+            {
+                command_buffer.cmd_fill_buffer({
+                    .buffer_id = draw_list,
+                    .offset = 0,
+                    .size = sizeof(DrawListHeader),
+                    .data = 0,
+                });
+            };
+            clear_draw_list(buffers.draw_list);
+            clear_draw_list(buffers.occlusion_draw_list);
+            for (BufferId const shadow_draw_list : buffers.shadow_draw_lists)
+            {
+                clear_draw_list(shadow_draw_list);
+            }
+            for (BufferId const vsm_draw_list : buffers.vsm_draw_lists)
+            {
+                clear_draw_list(vsm_draw_list);
+            }
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+            if (mesh_count > 0)
+            {
+                record_generate_draws(
+                    buffers.draw_list,
+                    GENERATE_DRAWS_FRUSTUM_CAMERA, 0,
+                    hiz_valid ? GENERATE_DRAWS_OCCLUSION_FIRST_PHASE : GENERATE_DRAWS_NO_OCCLUSION);
+            }
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT,
+            });
+            command_buffer.end_zone();
+        }
         // swapchain_image      UNDEFINED -> TANSFER_DST_OPTIMAL
         // ss_normals           UNDEFINED -> COLOR_ATTACHMENT_OPTIMAL
         // ambient_occlusion    UNDEFINED -> GENERAL
         // depth                UNDEFINED -> DEPTH_ATTACHMENT_OPTIMAL
         // shadowmap_cascades   UNDEFINED -> DEPTH_ATTACHMENT_OPTIMAL
         // esm_shadowmap        UNDEFINED -> GENERAL
-        // esm_cascades         UNDEFINED -> GENERAL
+        // esm_cascades         SHADER_READ_ONLY_OPTIMAL (UNDEFINED when the shadow cache is invalid) -> GENERAL
         // esm_tmp_cascades     UNDEFINED -> GENERAL
         // offscreen            UNDEFINED -> COLOR_ATTACHMENT_OPTIMAL
         // fsr_target           UNDEFINED -> GENERAL
@@ -721,12 +1281,15 @@ namespace ff
                 .image_id = images.shadowmap_cascades,
             });
 
+            // Cached cascades of the previous frame are kept, the main pass of the previous frame might still read them
             command_buffer.cmd_image_memory_transition_barrier({
-                .src_stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+                .src_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
                 .src_access = VK_ACCESS_2_NONE_KHR,
                 .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-                .dst_access = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
-                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED,
+                .dst_access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                .src_layout = invalidate_shadow_cache
+                                  ? VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED
+                                  : VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                 .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_GENERAL,
                 .layer_count = NUM_CASCADES,
                 .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
@@ -779,35 +1342,107 @@ namespace ff
             });
         }
 
-        // PREPASS
+        auto record_prepass = [&](BufferId draw_list, VkAttachmentLoadOp load_op)
         {
+            DrawPc prepass_push = draw_push;
+            prepass_push.visible_instances = get_visible_instances_address(draw_list);
             command_buffer.cmd_begin_renderpass({
                 .color_attachments = {RenderingAttachmentInfo{
                     .image_id = images.ss_normals,
                     .layout = VkImageLayout::VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                    .load_op = VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    .load_op = load_op,
                     .store_op = VkAttachmentStoreOp::VK_ATTACHMENT_STORE_OP_STORE,
                     .clear_value = {.color = {.float32 = {0.0f, 0.0f, 0.0f, 0.0f}}},
                 }},
                 .depth_attachment = RenderingAttachmentInfo{
                     .image_id = images.depth,
                     .layout = VkImageLayout::VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
-                    .load_op = VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    .load_op = load_op,
                     .store_op = VkAttachmentStoreOp::VK_ATTACHMENT_STORE_OP_STORE,
                     .clear_value = {.depthStencil = {.depth = 0.0f, .stencil = 0}},
                 },
                 .render_area = VkRect2D{.offset = {.x = 0, .y = 0}, .extent = {.width = render_resolution.width, .height = render_resolution.height}},
             });
             command_buffer.cmd_set_raster_pipeline(pipelines.prepass);
-            command_buffer.cmd_set_index_buffer({
-                .buffer_id = draw_commands.index_buffer_id,
-                .offset = 0,
-                .index_type = VkIndexType::VK_INDEX_TYPE_UINT32,
-            });
-            record_mesh_draw_commands(draw_commands.draw_commands);
+            command_buffer.cmd_set_push_constant(prepass_push);
+            record_indirect_draws(draw_list, DRAW_LIST_OPAQUE);
             command_buffer.cmd_set_raster_pipeline(pipelines.prepass_discard);
-            record_mesh_draw_commands(draw_commands.alpha_discard_commands);
+            command_buffer.cmd_set_push_constant(prepass_push);
+            record_indirect_draws(draw_list, DRAW_LIST_ALPHA_DISCARD);
             command_buffer.cmd_end_renderpass();
+        };
+
+        // PREPASS FIRST PHASE
+        {
+            command_buffer.begin_zone("prepass");
+            record_prepass(buffers.draw_list, VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_CLEAR);
+            command_buffer.end_zone();
+        }
+
+        // OCCLUSION CULLING SECOND PHASE
+        // depth    DEPTH_ATTACHMENT_OPTIMAL -> SHADER_READ_ONLY_OPTIMAL -> DEPTH_ATTACHMENT_OPTIMAL
+        {
+            command_buffer.begin_zone("occlusion culling");
+            command_buffer.cmd_image_memory_transition_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT,
+                .src_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT,
+                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_DEPTH_BIT,
+                .image_id = images.depth,
+            });
+            // The first phase read the previous frame pyramid which is now overwritten
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_READ_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+            record_build_hiz();
+            if (mesh_count > 0)
+            {
+                record_generate_draws(buffers.occlusion_draw_list, GENERATE_DRAWS_FRUSTUM_CAMERA, 0, GENERATE_DRAWS_OCCLUSION_SECOND_PHASE);
+            }
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT,
+            });
+            command_buffer.cmd_image_memory_transition_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_READ_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT,
+                .dst_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_DEPTH_BIT,
+                .image_id = images.depth,
+            });
+            // ss_normals stays an attachment, the second phase prepass loads it
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                .src_access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                .dst_access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            });
+            command_buffer.end_zone();
+        }
+
+        // PREPASS SECOND PHASE
+        {
+            command_buffer.begin_zone("prepass");
+            record_prepass(buffers.occlusion_draw_list, VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_LOAD);
+            // The host reads the texture feedback back once this frame slot is reused
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_HOST_BIT,
+                .dst_access = VK_ACCESS_2_HOST_READ_BIT,
+            });
+            command_buffer.end_zone();
         }
 
         // ss_normals COLOR_ATTACHMENT_OPTIMAL -> SHADER_READ_ONLY_OPTIMAL
@@ -836,8 +1471,25 @@ namespace ff
             });
         }
 
+        // HI-Z
+        // Built from the complete depth, the first occlusion culling phase of the next frame tests against it
+        {
+            command_buffer.begin_zone("hi-z");
+            // The second occlusion culling phase read the pyramid which is now overwritten
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_READ_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+            record_build_hiz();
+            hiz_valid = true;
+            command_buffer.end_zone();
+        }
+
         // SSAO
         {
+            command_buffer.begin_zone("ssao");
             command_buffer.cmd_set_compute_pipeline(pipelines.ssao_pass);
             command_buffer.cmd_set_push_constant(SSAOPC{
                 .SSAO_kernel = context->device->get_buffer_device_address(buffers.ssao_kernel),
@@ -854,10 +1506,12 @@ namespace ff
                 .y = (render_resolution.height + SSAO_Y_TILE_SIZE - 1) / SSAO_Y_TILE_SIZE,
                 .z = 1,
             });
+            command_buffer.end_zone();
         }
 
         // Depth passes
         {
+            command_buffer.begin_zone("depth min/max");
             u32vec2 const first_pass_dispatch_size = u32vec2{
                 (render_resolution.width + DEPTH_PASS_WG_READS_PER_AXIS.x - 1) / DEPTH_PASS_WG_READS_PER_AXIS.x,
                 (render_resolution.height + DEPTH_PASS_WG_READS_PER_AXIS.y - 1) / DEPTH_PASS_WG_READS_PER_AXIS.y};
@@ -894,10 +1548,166 @@ namespace ff
                 command_buffer.cmd_set_compute_pipeline(pipelines.subseq_depth_pass);
                 command_buffer.cmd_dispatch({second_pass_dispatch_size, 1, 1});
             }
+            command_buffer.end_zone();
+        }
+
+        // Virtual shadow map
+        if (use_virtual_shadows)
+        {
+            command_buffer.begin_zone("virtual shadows");
+            // The previous frame might still be reading the pages in its main pass
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+            StagingAllocation const vsm_clip_levels_staging = context->device->allocate_staging(sizeof(VsmClipLevel) * VSM_CLIP_LEVEL_COUNT).value();
+            std::memcpy(vsm_clip_levels_staging.host_address, vsm_clip_levels.data(), sizeof(VsmClipLevel) * VSM_CLIP_LEVEL_COUNT);
+            command_buffer.cmd_copy_buffer_to_buffer({
+                .src_buffer = vsm_clip_levels_staging.buffer_id,
+                .src_offset = static_cast<u32>(vsm_clip_levels_staging.offset),
+                .dst_buffer = buffers.vsm_clip_levels,
+                .dst_offset = static_cast<u32>(sizeof(VsmClipLevel) * VSM_CLIP_LEVEL_COUNT * fif_index),
+                .size = static_cast<u32>(sizeof(VsmClipLevel) * VSM_CLIP_LEVEL_COUNT),
+            });
+            // Every page is unallocated and the whole physical pool is free
+            if (invalidate_virtual_shadow_cache)
+            {
+                command_buffer.cmd_fill_buffer({
+                    .buffer_id = buffers.vsm_page_table,
+                    .offset = 0,
+                    .size = sizeof(VsmPageTableEntry) * VSM_PAGE_TABLE_RESOLUTION * VSM_PAGE_TABLE_RESOLUTION * VSM_CLIP_LEVEL_COUNT,
+                    .data = 0,
+                });
+                command_buffer.cmd_fill_buffer({
+                    .buffer_id = buffers.vsm_physical_pages,
+                    .offset = 0,
+                    .size = sizeof(VsmPhysicalPage) * VSM_PHYSICAL_PAGE_COUNT,
+                    .data = 0,
+                });
+                auto vsm_state = std::make_unique<VsmState>();
+                vsm_state->free_page_count = VSM_PHYSICAL_PAGE_COUNT;
+                for (u32 physical_page = 0; physical_page < VSM_PHYSICAL_PAGE_COUNT; physical_page++)
+                {
+                    vsm_state->free_pages[physical_page] = physical_page;
+                }
+                StagingAllocation const vsm_state_staging = context->device->allocate_staging(sizeof(VsmState)).value();
+                std::memcpy(vsm_state_staging.host_address, vsm_state.get(), sizeof(VsmState));
+                command_buffer.cmd_copy_buffer_to_buffer({
+                    .src_buffer = vsm_state_staging.buffer_id,
+                    .src_offset = static_cast<u32>(vsm_state_staging.offset),
+                    .dst_buffer = buffers.vsm_state,
+                    .size = static_cast<u32>(sizeof(VsmState)),
+                });
+            }
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+
+            VsmPagesPC const vsm_pages_push = {
+                .camera_info = context->device->get_buffer_device_address(buffers.camera_info),
+                .clip_levels = vsm_clip_levels_address,
+                .page_table = context->device->get_buffer_device_address(buffers.vsm_page_table),
+                .physical_pages = context->device->get_buffer_device_address(buffers.vsm_physical_pages),
+                .physical_texels = context->device->get_buffer_device_address(buffers.vsm_physical_texels),
+                .state = context->device->get_buffer_device_address(buffers.vsm_state),
+                .depth_dimensions = {render_resolution.width, render_resolution.height},
+                .depth_index = images.depth.index,
+                .fif_index = fif_index,
+            };
+            auto vsm_pages_barrier = [&]()
+            {
+                command_buffer.cmd_memory_barrier({
+                    .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                    .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                });
+            };
+            u32 const page_table_workgroups = VSM_PAGE_TABLE_RESOLUTION / VSM_WORKGROUP_SIZE;
+            command_buffer.cmd_set_compute_pipeline(pipelines.vsm_free_pages);
+            command_buffer.cmd_set_push_constant(vsm_pages_push);
+            command_buffer.cmd_dispatch({page_table_workgroups, page_table_workgroups, VSM_CLIP_LEVEL_COUNT});
+            vsm_pages_barrier();
+            command_buffer.cmd_set_compute_pipeline(pipelines.vsm_mark_pages);
+            command_buffer.cmd_set_push_constant(vsm_pages_push);
+            command_buffer.cmd_dispatch({
+                (render_resolution.width + VSM_WORKGROUP_SIZE - 1) / VSM_WORKGROUP_SIZE,
+                (render_resolution.height + VSM_WORKGROUP_SIZE - 1) / VSM_WORKGROUP_SIZE,
+                1,
+            });
+            vsm_pages_barrier();
+            command_buffer.cmd_set_compute_pipeline(pipelines.vsm_allocate_pages);
+            command_buffer.cmd_set_push_constant(vsm_pages_push);
+            command_buffer.cmd_dispatch({page_table_workgroups, page_table_workgroups, VSM_CLIP_LEVEL_COUNT});
+            vsm_pages_barrier();
+            command_buffer.cmd_set_compute_pipeline(pipelines.vsm_clear_pages);
+            command_buffer.cmd_set_push_constant(vsm_pages_push);
+            command_buffer.cmd_dispatch({VSM_PHYSICAL_PAGE_COUNT, 1, 1});
+            // Culled against the pages allocated this frame
+            if (mesh_count > 0)
+            {
+                for (u32 clip_level = 0; clip_level < VSM_CLIP_LEVEL_COUNT; clip_level++)
+                {
+                    record_generate_draws(
+                        buffers.vsm_draw_lists.at(clip_level),
+                        GENERATE_DRAWS_FRUSTUM_VIRTUAL_SHADOW, clip_level,
+                        GENERATE_DRAWS_NO_OCCLUSION);
+                }
+            }
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+            });
+
+            /// NOTE: Every clip level is rendered into its whole virtual resolution, fragments outside of the dirty
+            //        pages are dropped by the fragment shader. Depth is resolved with atomics on the physical texels.
+            command_buffer.cmd_begin_renderpass({
+                .render_area = VkRect2D{
+                    .offset = {.x = 0, .y = 0},
+                    .extent = {.width = VSM_VIRTUAL_RESOLUTION, .height = VSM_VIRTUAL_RESOLUTION},
+                },
+            });
+            for (u32 draw_list_index : {DRAW_LIST_OPAQUE, DRAW_LIST_ALPHA_DISCARD})
+            {
+                command_buffer.cmd_set_raster_pipeline(draw_list_index == DRAW_LIST_OPAQUE ? pipelines.vsm_pass : pipelines.vsm_pass_discard);
+                for (u32 clip_level = 0; clip_level < VSM_CLIP_LEVEL_COUNT; clip_level++)
+                {
+                    command_buffer.cmd_set_push_constant(VsmPassPC{
+                        .scene_descriptor = draw_commands.scene_descriptor,
+                        .clip_levels = vsm_clip_levels_address,
+                        .page_table = context->device->get_buffer_device_address(buffers.vsm_page_table),
+                        .physical_texels = context->device->get_buffer_device_address(buffers.vsm_physical_texels),
+                        .visible_instances = get_visible_instances_address(buffers.vsm_draw_lists.at(clip_level)),
+                        .sampler_id = no_mip_sampler.index,
+                        .clip_level = clip_level,
+                    });
+                    record_indirect_draws(buffers.vsm_draw_lists.at(clip_level), draw_list_index);
+                }
+            }
+            command_buffer.cmd_end_renderpass();
+            // Sampled by the main pass
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT,
+            });
+            command_buffer.end_zone();
         }
 
+        /// NOTE: The esm cascades are skipped while the virtual shadow map is used. Their images keep the cached
+        //        cascades, they are scrolled to the camera once they are used again.
         // Shadowmap matrices
+        if (!use_virtual_shadows)
         {
+            command_buffer.begin_zone("shadow matrices");
             command_buffer.cmd_memory_barrier({
                 .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
                 .src_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
@@ -909,19 +1719,80 @@ namespace ff
                 .fif_index = fif_index,
                 .depth_limits = context->device->get_buffer_device_address(buffers.depth_limits),
                 .cascade_data = context->device->get_buffer_device_address(buffers.cascade_data),
+                .cascade_cache = context->device->get_buffer_device_address(buffers.cascade_cache),
                 .sun_direction = sun_direction,
+                .invalidate_cache = invalidate_shadow_cache ? 1u : 0u,
             });
             command_buffer.cmd_set_compute_pipeline(pipelines.write_shadow_matrices);
             command_buffer.cmd_dispatch({1, 1, 1});
+            command_buffer.end_zone();
+        }
+
+        // Scroll cached esm cascades
+        if (!use_virtual_shadows)
+        {
+            command_buffer.begin_zone("esm scroll");
+            command_buffer.cmd_set_compute_pipeline(pipelines.esm_scroll);
+            for (u32 scroll_pass = 0; scroll_pass < 2; scroll_pass++)
+            {
+                command_buffer.cmd_memory_barrier({
+                    .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                    .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                });
+                for (u32 cascade = 0; cascade < NUM_CASCADES; cascade++)
+                {
+                    command_buffer.cmd_set_push_constant(ESMScrollPC{
+                        .cascade_cache = context->device->get_buffer_device_address(buffers.cascade_cache),
+                        .src_index = scroll_pass == 0 ? images.esm_cascades.index : images.esm_tmp_cascades.index,
+                        .dst_index = scroll_pass == 0 ? images.esm_tmp_cascades.index : images.esm_cascades.index,
+                        .cascade_index = cascade,
+                        .apply_scroll = scroll_pass == 0 ? 1u : 0u,
+                    });
+                    command_buffer.cmd_dispatch({
+                        SHADOWMAP_RESOLUTION / ESM_SCROLL_WORKGROUP_SIZE,
+                        SHADOWMAP_RESOLUTION / ESM_SCROLL_WORKGROUP_SIZE,
+                        1,
+                    });
+                }
+            }
+            command_buffer.end_zone();
+        }
+
+        // Generate shadow draws
+        if (!use_virtual_shadows)
+        {
+            command_buffer.begin_zone("generate shadow draws");
+            // The esm passes write the scrolled cascades again
+            command_buffer.cmd_memory_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+            });
+            if (mesh_count > 0)
+            {
+                for (u32 cascade = 0; cascade < NUM_CASCADES; cascade++)
+                {
+                    record_generate_draws(
+                        buffers.shadow_draw_lists.at(cascade),
+                        GENERATE_DRAWS_FRUSTUM_SHADOW_CASCADE, cascade,
+                        GENERATE_DRAWS_NO_OCCLUSION);
+                }
+            }
+            command_buffer.end_zone();
         }
 
         // Draw shadows
+        if (!use_virtual_shadows)
         {
+            command_buffer.begin_zone("shadow pass");
             command_buffer.cmd_memory_barrier({
                 .src_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
                 .src_access = VK_ACCESS_2_SHADER_WRITE_BIT,
-                .dst_stages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
-                .dst_access = VK_ACCESS_2_SHADER_READ_BIT,
+                .dst_stages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                .dst_access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
             });
             auto const resolution_multiplier = resolution_table[NUM_CASCADES - 1];
 
@@ -942,11 +1813,6 @@ namespace ff
                 },
             });
             command_buffer.cmd_set_raster_pipeline(pipelines.shadowmap_pass);
-            command_buffer.cmd_set_index_buffer({
-                .buffer_id = draw_commands.index_buffer_id,
-                .offset = 0,
-                .index_type = VkIndexType::VK_INDEX_TYPE_UINT32,
-            });
             for (u32 cascade = 0; cascade < NUM_CASCADES; cascade++)
             {
                 u32vec2 offset;
@@ -960,23 +1826,14 @@ namespace ff
                     .minDepth = 0.0f,
                     .maxDepth = 1.0f,
                 });
-                for (auto const & draw_command : draw_commands.draw_commands)
-                {
-                    command_buffer.cmd_set_push_constant(ShadowPC{
-                        .scene_descriptor = draw_commands.scene_descriptor,
-                        .cascade_data = context->device->get_buffer_device_address(buffers.cascade_data),
-                        .mesh_index = draw_command.mesh_idx,
-                        .sampler_id = no_mip_sampler.index,
-                        .cascade_index = cascade,
-                    });
-                    command_buffer.cmd_draw_indexed({
-                        .index_count = draw_command.index_count,
-                        .instance_count = draw_command.instance_count,
-                        .first_index = draw_command.index_offset,
-                        .vertex_offset = 0,
-                        .first_instance = 0,
-                    });
-                }
+                command_buffer.cmd_set_push_constant(ShadowPC{
+                    .scene_descriptor = draw_commands.scene_descriptor,
+                    .cascade_data = context->device->get_buffer_device_address(buffers.cascade_data),
+                    .visible_instances = get_visible_instances_address(buffers.shadow_draw_lists.at(cascade)),
+                    .sampler_id = no_mip_sampler.index,
+                    .cascade_index = cascade,
+                });
+                record_indirect_draws(buffers.shadow_draw_lists.at(cascade), DRAW_LIST_OPAQUE);
             }
 
             command_buffer.cmd_set_raster_pipeline(pipelines.shadowmap_pass_discard);
@@ -993,25 +1850,17 @@ namespace ff
                     .minDepth = 0.0f,
                     .maxDepth = 1.0f,
                 });
-                for (auto const & draw_command : draw_commands.alpha_discard_commands)
-                {
-                    command_buffer.cmd_set_push_constant(ShadowPC{
-                        .scene_descriptor = draw_commands.scene_descriptor,
-                        .cascade_data = context->device->get_buffer_device_address(buffers.cascade_data),
-                        .mesh_index = draw_command.mesh_idx,
-                        .sampler_id = no_mip_sampler.index,
-                        .cascade_index = cascade,
-                    });
-                    command_buffer.cmd_draw_indexed({
-                        .index_count = draw_command.index_count,
-                        .instance_count = draw_command.instance_count,
-                        .first_index = draw_command.index_offset,
-                        .vertex_offset = 0,
-                        .first_instance = 0,
-                    });
-                }
+                command_buffer.cmd_set_push_constant(ShadowPC{
+                    .scene_descriptor = draw_commands.scene_descriptor,
+                    .cascade_data = context->device->get_buffer_device_address(buffers.cascade_data),
+                    .visible_instances = get_visible_instances_address(buffers.shadow_draw_lists.at(cascade)),
+                    .sampler_id = no_mip_sampler.index,
+                    .cascade_index = cascade,
+                });
+                record_indirect_draws(buffers.shadow_draw_lists.at(cascade), DRAW_LIST_ALPHA_DISCARD);
             }
             command_buffer.cmd_end_renderpass();
+            command_buffer.end_zone();
         }
 
         // shadowmap_cascades DEPTH_ATTACHMENT_OPTIMAL -> SHADER_READ_ONLY_OPTIMAL
@@ -1029,7 +1878,9 @@ namespace ff
         }
 
         // ESM blur first pass
+        if (!use_virtual_shadows)
         {
+            command_buffer.begin_zone("esm blur");
             auto const resolution_multiplier = resolution_table[NUM_CASCADES - 1];
             command_buffer.cmd_set_compute_pipeline(pipelines.first_esm_pass);
             for (u32 cascade = 0; cascade < NUM_CASCADES; cascade++)
@@ -1039,6 +1890,7 @@ namespace ff
                     cascade / resolution_multiplier.x,
                 };
                 command_buffer.cmd_set_push_constant(ESMShadowPC{
+                    .cascade_cache = context->device->get_buffer_device_address(buffers.cascade_cache),
                     .tmp_esm_index = images.esm_tmp_cascades.index,
                     .esm_index = images.esm_cascades.index,
                     .shadowmap_index = images.shadowmap_cascades.index,
@@ -1050,6 +1902,7 @@ namespace ff
                 });
                 command_buffer.cmd_dispatch({SHADOWMAP_RESOLUTION / ESM_BLUR_WORKGROUP_SIZE, SHADOWMAP_RESOLUTION, 1});
             }
+            command_buffer.end_zone();
         }
         // esm_tmp_cascades     GENERAL -> SHADER_READ_ONLY_OPTIMAL
         {
@@ -1067,11 +1920,14 @@ namespace ff
         }
 
         // ESM blur second pass
+        if (!use_virtual_shadows)
         {
+            command_buffer.begin_zone("esm blur");
             command_buffer.cmd_set_compute_pipeline(pipelines.second_esm_pass);
             for (u32 cascade = 0; cascade < NUM_CASCADES; cascade++)
             {
                 command_buffer.cmd_set_push_constant(ESMShadowPC{
+                    .cascade_cache = context->device->get_buffer_device_address(buffers.cascade_cache),
                     .tmp_esm_index = images.esm_tmp_cascades.index,
                     .esm_index = images.esm_cascades.index,
                     .shadowmap_index = images.shadowmap_cascades.index,
@@ -1080,6 +1936,7 @@ namespace ff
                 });
                 command_buffer.cmd_dispatch({SHADOWMAP_RESOLUTION, SHADOWMAP_RESOLUTION / ESM_BLUR_WORKGROUP_SIZE, 1});
             }
+            command_buffer.end_zone();
         }
 
         // depth                SHADER_READ_ONLY_OPTIMAL -> DEPTH_ATTACHMENT_OPTIMAL
@@ -1123,6 +1980,7 @@ namespace ff
 
         // COLOR PASS
         {
+            command_buffer.begin_zone("main pass");
             command_buffer.cmd_begin_renderpass({
                 .color_attachments = {
                     {
@@ -1150,36 +2008,16 @@ namespace ff
                 .render_area = VkRect2D{.offset = {.x = 0, .y = 0}, .extent = {.width = render_resolution.width, .height = render_resolution.height}},
             });
             command_buffer.cmd_set_raster_pipeline(pipelines.main_pass);
-            command_buffer.cmd_set_index_buffer({
-                .buffer_id = draw_commands.index_buffer_id,
-                .offset = 0,
-                .index_type = VkIndexType::VK_INDEX_TYPE_UINT32,
-            });
-            for (auto const & draw_command : draw_commands.draw_commands)
-            {
-                draw_push.mesh_index = draw_command.mesh_idx;
-                command_buffer.cmd_set_push_constant(draw_push);
-                command_buffer.cmd_draw_indexed({
-                    .index_count = draw_command.index_count,
-                    .instance_count = draw_command.instance_count,
-                    .first_index = draw_command.index_offset,
-                    .vertex_offset = 0,
-                    .first_instance = 0,
-                });
-            }
-            for (auto const & draw_command : draw_commands.alpha_discard_commands)
+            // Depth contains the instances of both occlusion culling phases
+            for (BufferId const draw_list : {buffers.draw_list, buffers.occlusion_draw_list})
             {
-                draw_push.mesh_index = draw_command.mesh_idx;
+                draw_push.visible_instances = get_visible_instances_address(draw_list);
                 command_buffer.cmd_set_push_constant(draw_push);
-                command_buffer.cmd_draw_indexed({
-                    .index_count = draw_command.index_count,
-                    .instance_count = draw_command.instance_count,
-                    .first_index = draw_command.index_offset,
-                    .vertex_offset = 0,
-                    .first_instance = 0,
-                });
+                record_indirect_draws(draw_list, DRAW_LIST_OPAQUE);
+                record_indirect_draws(draw_list, DRAW_LIST_ALPHA_DISCARD);
             }
             command_buffer.cmd_end_renderpass();
+            command_buffer.end_zone();
         }
 
         // offscreen        COLOR_ATTACHMENT_OPTIMAL -> GENERAL
@@ -1197,6 +2035,7 @@ namespace ff
         }
         // fog pass
         {
+            command_buffer.begin_zone("fog");
             command_buffer.cmd_set_compute_pipeline(pipelines.fog_pass);
             command_buffer.cmd_set_push_constant(FogPC{
                 .camera_info = context->device->get_buffer_device_address(buffers.camera_info),
@@ -1212,6 +2051,7 @@ namespace ff
                 .y = (render_resolution.height + FOG_PASS_X_TILE_SIZE - 1) / FOG_PASS_X_TILE_SIZE,
                 .z = 1,
             });
+            command_buffer.end_zone();
         }
 
         // offscreen        if fsr_on  = GENERAL -> SHADER_READ_ONLY_OPTIMAL
@@ -1270,6 +2110,7 @@ namespace ff
         {
             // FSR upscale
             {
+                command_buffer.begin_zone("fsr");
                 fsr.upscale({
                     .command_buffer = command_buffer,
                     .color_id = images.offscreen,
@@ -1283,6 +2124,7 @@ namespace ff
                     .sharpening = 0.0f,
                     .camera_info = camera_info.fsr_cam_info,
                 });
+                command_buffer.end_zone();
             }
             // fsr_taget GENERAL -> TRANSFER_SRC_OPTIMAL
             {
@@ -1329,7 +2171,8 @@ namespace ff
                 });
             }
         }
-        // swapchain TRANSFER_DST_OPTIMAL -> PRESENT_SRC
+        bool const headless = context->swapchain->is_headless();
+        // swapchain TRANSFER_DST_OPTIMAL -> PRESENT_SRC (TRANSFER_SRC_OPTIMAL when headless)
         {
             command_buffer.cmd_image_memory_transition_barrier({
                 .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
@@ -1337,11 +2180,12 @@ namespace ff
                 .dst_stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
                 .dst_access = VK_ACCESS_2_MEMORY_READ_BIT,
                 .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                .dst_layout = headless ? VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VkImageLayout::VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
                 .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
                 .image_id = swapchain_image,
             });
         }
+        command_buffer.end_zone();
         command_buffer.end();
 
         auto finished_command_buffer = command_buffer.get_recorded_command_buffer();
@@ -1352,19 +2196,49 @@ namespace ff
             .value = context->swapchain->get_timeline_cpu_value(),
         };
 
-        context->device->submit({
-            .command_buffers = {&finished_command_buffer, 1},
-            .wait_binary_semaphores = {&acquire_semaphore, 1},
-            .signal_binary_semaphores = {&present_semaphore, 1},
-            .signal_timeline_semaphores = {&swapchain_timeline_semaphore_info, 1},
-        });
-
-        context->device->destroy_buffer(camera_info_staging_buffer);
-        context->swapchain->present({.wait_semaphores = {&present_semaphore, 1}});
+        if (headless)
+        {
+            context->device->submit({
+                .command_buffers = {&finished_command_buffer, 1},
+                .signal_timeline_semaphores = {&swapchain_timeline_semaphore_info, 1},
+            });
+        }
+        else
+        {
+            context->device->submit({
+                .command_buffers = {&finished_command_buffer, 1},
+                .wait_binary_semaphores = {&acquire_semaphore, 1},
+                .signal_binary_semaphores = {&present_semaphore, 1},
+                .signal_timeline_semaphores = {&swapchain_timeline_semaphore_info, 1},
+            });
+            context->swapchain->present({.wait_semaphores = {&present_semaphore, 1}});
+        }
         context->device->cleanup_resources();
         prev_view_projection = curr_frame_camera.view_projection;
         frame_time = stopwatch.elapsed_time<f32, std::chrono::seconds>();
-        fmt::println("CPU frame time {}ms FPS {}", delta_time * 1000.0, 1.0 / (delta_time));
+        last_frame_allocation_statistics = context->device->reset_allocation_statistics();
+        // Headless benchmark runs time this function, console output would end up in every sample
+        if (!headless)
+        {
+            fmt::println("CPU frame time {}ms FPS {} allocations (buffers {} images {} staging {} - {}B command pools {} command buffers {})",
+                         delta_time * 1000.0, 1.0 / (delta_time),
+                         last_frame_allocation_statistics.buffer_allocations,
+                         last_frame_allocation_statistics.image_allocations,
+                         last_frame_allocation_statistics.staging_allocations,
+                         last_frame_allocation_statistics.staging_bytes,
+                         last_frame_allocation_statistics.command_pool_allocations,
+                         last_frame_allocation_statistics.command_buffer_allocations);
+        }
+        // Printed once per averaging window, headless benchmark runs write the zones of every frame into their results
+        if (!headless && frame_index % Device::GPU_PROFILER_WINDOW_SIZE == 0)
+        {
+            std::string gpu_zones = {};
+            for (GpuZoneTiming const & zone : context->device->get_gpu_zone_timings())
+            {
+                gpu_zones += fmt::format(" {} {:.3f}ms", zone.name, zone.average_ms);
+            }
+            fmt::println("GPU zones (average of the last {} frames){}", Device::GPU_PROFILER_WINDOW_SIZE, gpu_zones);
+        }
         frame_index += 1;
         accum += delta_time;
     }
@@ -1374,8 +2248,32 @@ namespace ff
         context->device->destroy_buffer(buffers.camera_info);
         context->device->destroy_buffer(buffers.ssao_kernel);
         context->device->destroy_buffer(buffers.cascade_data);
+        context->device->destroy_buffer(buffers.cascade_cache);
+        context->device->destroy_buffer(buffers.vsm_clip_levels);
+        context->device->destroy_buffer(buffers.vsm_page_table);
+        context->device->destroy_buffer(buffers.vsm_physical_pages);
+        context->device->destroy_buffer(buffers.vsm_physical_texels);
+        context->device->destroy_buffer(buffers.vsm_state);
         context->device->destroy_buffer(buffers.depth_limits);
+        context->device->destroy_buffer(buffers.hiz);
         context->device->destroy_buffer(buffers.lights_info);
+        if (texture_feedback_material_capacity > 0)
+        {
+            context->device->destroy_buffer(buffers.texture_feedback);
+        }
+        if (draw_list_mesh_capacity > 0)
+        {
+            context->device->destroy_buffer(buffers.draw_list);
+            context->device->destroy_buffer(buffers.occlusion_draw_list);
+            for (BufferId const shadow_draw_list : buffers.shadow_draw_lists)
+            {
+                context->device->destroy_buffer(shadow_draw_list);
+            }
+            for (BufferId const vsm_draw_list : buffers.vsm_draw_lists)
+            {
+                context->device->destroy_buffer(vsm_draw_list);
+            }
+        }
         context->device->destroy_image(images.ssao_kernel_noise);
         context->device->destroy_image(images.depth);
         context->device->destroy_image(images.ambient_occlusion);
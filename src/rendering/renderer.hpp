@@ -2,6 +2,7 @@
 #include "../backend/backend.hpp"
 #include "../context.hpp"
 #include "../scene/scene.hpp"
+#include "../shared/shared.inl"
 
 struct CameraInfo
 {
@@ -24,6 +25,8 @@ namespace ff
 		RasterPipeline prepass_discard = {};
 		RasterPipeline shadowmap_pass = {};
 		RasterPipeline shadowmap_pass_discard = {};
+		RasterPipeline vsm_pass = {};
+		RasterPipeline vsm_pass_discard = {};
 		RasterPipeline main_pass = {};
 
 		ComputePipeline first_depth_pass = {};
@@ -31,8 +34,15 @@ namespace ff
 		ComputePipeline write_shadow_matrices = {};
 		ComputePipeline first_esm_pass = {};
 		ComputePipeline second_esm_pass = {};
+		ComputePipeline esm_scroll = {};
+		ComputePipeline vsm_free_pages = {};
+		ComputePipeline vsm_mark_pages = {};
+		ComputePipeline vsm_allocate_pages = {};
+		ComputePipeline vsm_clear_pages = {};
 		ComputePipeline ssao_pass = {};
 		ComputePipeline fog_pass = {};
+		ComputePipeline generate_draws = {};
+		ComputePipeline hiz_generate = {};
 	};
 
 	struct Images
@@ -57,7 +67,19 @@ namespace ff
 		BufferId camera_info = {};
 		BufferId depth_limits = {};
 		BufferId cascade_data = {};
+		BufferId cascade_cache = {};
 		BufferId lights_info = {};
+		BufferId draw_list = {};
+		BufferId occlusion_draw_list = {};
+		std::array<BufferId, NUM_CASCADES> shadow_draw_lists = {};
+		BufferId vsm_clip_levels = {};
+		BufferId vsm_page_table = {};
+		BufferId vsm_physical_pages = {};
+		BufferId vsm_physical_texels = {};
+		BufferId vsm_state = {};
+		std::array<BufferId, VSM_CLIP_LEVEL_COUNT> vsm_draw_lists = {};
+		BufferId hiz = {};
+		BufferId texture_feedback = {};
 	};
 
     struct Renderer
@@ -70,11 +92,21 @@ namespace ff
         void draw_frame(SceneDrawCommands const & draw_commands, CameraInfo const & camera_info, f32 delta_time);
         void resize();
 		void change_fsr_scaling(f32 new_scaling);
+		// Lod bias of the material sampler, depends on the current fsr scaling
+		auto get_material_lod_bias() const -> f32;
+		// Device allocations made while recording and submitting the previous frame, zero in steady state.
+		auto get_last_frame_allocation_statistics() const -> AllocationStatistics const &;
+		// Texture feedback written by the frame which last used the slot of the previous frame, one entry per material
+		auto get_texture_feedback() const -> std::span<TextureFeedback const>;
+		// Shadow casters moved, the next frame renders every shadow cascade and virtual shadow page again instead of
+		// reusing their caches
+		void invalidate_shadow_cache();
 
       private:
 	  	void create_pipelines();
 		void create_resolution_indep_resources();
 		void create_resolution_dep_resources();
+		void create_repeat_sampler();
 
         std::shared_ptr<Context> context = {};
 		Pipelines pipelines = {};
@@ -93,6 +125,28 @@ namespace ff
 		u32 curr_num_lights = {};
 		f32vec2 jitter = {};
 		f32mat4x4 prev_view_projection = {};
+		AllocationStatistics last_frame_allocation_statistics = {};
+		// Number of meshes, instances, cluster culling work items and culled indices the draw list buffers can hold
+		u32 draw_list_mesh_capacity = {};
+		u32 draw_list_instance_capacity = {};
+		u32 draw_list_cluster_work_capacity = {};
+		u32 draw_list_culled_index_capacity = {};
+		// Hi-Z pyramid holds the depth of the previous frame, false after it was (re)created
+		bool hiz_valid = {};
+		// Shadow cascades hold the ones of the previous frame, false until first rendered or after an invalidation
+		bool shadow_cache_valid = {};
+		// Scene the shadow cascades were cached with, any change of it invalidates them
+		u32 shadow_cache_mesh_count = {};
+		u32 shadow_cache_instance_count = {};
+		// Virtual shadow pages hold the ones of the previous frame which used them, false until first used or after
+		// an invalidation
+		bool virtual_shadow_cache_valid = {};
+		// Origin pages of the clip levels and light space depth center the virtual shadow pages were cached with
+		std::array<i32vec2, VSM_CLIP_LEVEL_COUNT> vsm_origin_pages = {};
+		f32 vsm_depth_center = {};
+		// Number of materials every frame slot of the texture feedback buffer can hold
+		u32 texture_feedback_material_capacity = {};
+		std::vector<TextureFeedback> texture_feedback = {};
 
     	static constexpr std::array<u32vec2, 8> resolution_table{
         	u32vec2{1u,1u}, u32vec2{2u,1u}, u32vec2{2u,2u}, u32vec2{2u,2u},
@@ -1,16 +1,23 @@
 #include "asset_processor.hpp"
+#include "texture_compression.hpp"
 
 #include <fastgltf/tools.hpp>
 #include <fastgltf/types.hpp>
 #include <fstream>
 #include <cstring>
+#include <limits>
 #include <FreeImage.h>
+#include <glm/gtc/packing.hpp>
+#include <meshoptimizer.h>
+#include <type_traits>
 #include <variant>
 
 #pragma region IMAGE_RAW_DATA_LOADING_HELPERS
 struct RawImageData
 {
-    std::vector<std::byte> raw_data;
+    // Holds the bytes of images read from their own file, empty when raw_data views a mapped glTF buffer
+    std::vector<std::byte> owned_data;
+    std::span<std::byte const> raw_data;
     std::filesystem::path image_path;
     fastgltf::MimeType mime_type;
 };
@@ -23,6 +30,8 @@ struct RawImageDataFromURIInfo
     fastgltf::Asset const & asset;
     // Wihtout the scename.glb part
     std::filesystem::path const scene_dir_path;
+    // Contents of the file read ahead by the AsyncFileReader, the file is read here when not set
+    ff::FileReadResult * prefetched = {};
 };
 
 static auto raw_image_data_from_path(std::filesystem::path image_path) -> RawDataRet
@@ -40,10 +49,12 @@ static auto raw_image_data_from_path(std::filesystem::path image_path) -> RawDat
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_READ_TEXTURE_FILE;
     }
-    return RawImageData{
-        .raw_data = std::move(raw),
+    RawImageData ret = {
+        .owned_data = std::move(raw),
         .image_path = image_path,
         .mime_type = {}};
+    ret.raw_data = ret.owned_data;
+    return ret;
 }
 
 static auto raw_image_data_from_URI(RawImageDataFromURIInfo const & info) -> RawDataRet
@@ -62,68 +73,125 @@ static auto raw_image_data_from_URI(RawImageDataFromURIInfo const & info) -> Raw
         return AssetProcessor::AssetLoadResultCode::ERROR_URI_FILE_OFFSET_NOT_SUPPORTED;
     }
     std::filesystem::path const full_image_path = info.scene_dir_path / info.uri.uri.fspath();
-    APP_LOG(fmt::format("[AssetProcessor::raw_image_data_from_URI] Loading image {} ...", full_image_path.string()));
-    RawDataRet raw_image_data_ret = raw_image_data_from_path(full_image_path);
+    RawDataRet raw_image_data_ret = {};
+    if (info.prefetched != nullptr)
+    {
+        if (!info.prefetched->success)
+        {
+            return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_OPEN_TEXTURE_FILE;
+        }
+        RawImageData prefetched_data = {
+            .owned_data = std::move(info.prefetched->data),
+            .image_path = full_image_path,
+            .mime_type = {}};
+        prefetched_data.raw_data = prefetched_data.owned_data;
+        raw_image_data_ret = std::move(prefetched_data);
+    }
+    else
+    {
+        APP_LOG(fmt::format("[AssetProcessor::raw_image_data_from_URI] Loading image {} ...", full_image_path.string()));
+        raw_image_data_ret = raw_image_data_from_path(full_image_path);
+    }
     if (std::holds_alternative<AssetProcessor::AssetLoadResultCode>(raw_image_data_ret))
     {
         return raw_image_data_ret;
     }
     RawImageData & raw_data = std::get<RawImageData>(raw_image_data_ret);
     raw_data.mime_type = info.uri.mimeType;
-    return raw_data;
+    // Moving keeps the owned bytes at the address raw_data points to
+    return std::move(raw_data);
+}
+
+/// NOTE: Bytes of the glTF buffer inside its mapped file. The mapping is made once per scene file, the returned
+//        span stays valid for as long as the scene file manifest entry.
+static auto get_gltf_buffer_data(SceneFileManifestEntry const & scene_entry, usize buffer_index)
+    -> std::variant<std::span<std::byte const>, AssetProcessor::AssetLoadResultCode>
+{
+    fastgltf::Buffer const & gltf_buffer = scene_entry.gltf_asset.buffers.at(buffer_index);
+    auto const * uri = std::get_if<fastgltf::sources::URI>(&gltf_buffer.data);
+    if (uri == nullptr)
+    {
+        return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_BUFFER_VIEW;
+    }
+    ff::MappedFile const & buffer_file = scene_entry.buffer_files.at(buffer_index);
+    if (!buffer_file.is_open())
+    {
+        return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_OPEN_GLTF;
+    }
+    std::span<std::byte const> const file_data = buffer_file.get_data();
+    if (uri->fileByteOffset + gltf_buffer.byteLength > file_data.size())
+    {
+        return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_READ_BUFFER_IN_GLTF;
+    }
+    return file_data.subspan(uri->fileByteOffset, gltf_buffer.byteLength);
 }
 
 struct RawImageDataFromBufferViewInfo
 {
     fastgltf::sources::BufferView const & buffer_view;
-    fastgltf::Asset const & asset;
-    // Wihtout the scename.glb part
-    std::filesystem::path const scene_dir_path;
+    SceneFileManifestEntry const & scene_entry;
 };
 
 static auto raw_image_data_from_buffer_view(RawImageDataFromBufferViewInfo const & info) -> RawDataRet
 {
-    fastgltf::BufferView const & gltf_buffer_view = info.asset.bufferViews.at(info.buffer_view.bufferViewIndex);
-    fastgltf::Buffer const & gltf_buffer = info.asset.buffers.at(gltf_buffer_view.bufferIndex);
-
-    if (!std::holds_alternative<fastgltf::sources::URI>(gltf_buffer.data))
+    fastgltf::BufferView const & gltf_buffer_view = info.scene_entry.gltf_asset.bufferViews.at(info.buffer_view.bufferViewIndex);
+    auto buffer_data_ret = get_gltf_buffer_data(info.scene_entry, gltf_buffer_view.bufferIndex);
+    if (auto const * error = std::get_if<AssetProcessor::AssetLoadResultCode>(&buffer_data_ret))
     {
-        return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_BUFFER_VIEW;
-    }
-    fastgltf::sources::URI uri = std::get<fastgltf::sources::URI>(gltf_buffer.data);
-
-    /// NOTE: load the section of the file containing the buffer for the mesh index buffer.
-    std::filesystem::path const full_buffer_path = info.scene_dir_path / uri.uri.fspath();
-    std::ifstream ifs{full_buffer_path, std::ios::binary};
-    if (!ifs)
-    {
-        return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_OPEN_GLTF;
+        return *error;
     }
-    /// NOTE: Only load the relevant part of the file containing the view of the buffer we actually need.
-    ifs.seekg(gltf_buffer_view.byteOffset + uri.fileByteOffset);
-    std::vector<std::byte> raw = {};
-    raw.resize(gltf_buffer_view.byteLength);
-    /// NOTE: Only load the relevant part of the file containing the view of the buffer we actually need.
-    if (!ifs.read(reinterpret_cast<char *>(raw.data()), gltf_buffer_view.byteLength))
+    std::span<std::byte const> const buffer_data = std::get<std::span<std::byte const>>(buffer_data_ret);
+    if (gltf_buffer_view.byteOffset + gltf_buffer_view.byteLength > buffer_data.size())
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_READ_BUFFER_IN_GLTF;
     }
+    fastgltf::sources::URI const & uri = std::get<fastgltf::sources::URI>(info.scene_entry.gltf_asset.buffers.at(gltf_buffer_view.bufferIndex).data);
+    /// NOTE: The image is decoded straight out of the mapping, only the pages of the view are read from disk.
     return RawImageData{
-        .raw_data = std::move(raw),
-        .image_path = full_buffer_path,
+        .owned_data = {},
+        .raw_data = buffer_data.subspan(gltf_buffer_view.byteOffset, gltf_buffer_view.byteLength),
+        .image_path = std::filesystem::path(info.scene_entry.path).remove_filename() / uri.uri.fspath(),
         .mime_type = uri.mimeType};
 }
 #pragma engregion
 
 #pragma region IMAGE_RAW_DATA_PARSING_HELPERS
+struct DecodedImageData
+{
+    std::vector<std::byte> texels;
+    u32 width;
+    u32 height;
+    u32 mip_level_count;
+    // Number of mips tightly packed in texels, starting with mip 0
+    u32 stored_mip_count;
+    VkFormat format;
+    // Tangent space normal map, its mips are renormalized
+    bool is_normal;
+    std::string name;
+};
+
+/// NOTE: std::monostate signals that the texture was intentionally skipped.
+using DecodedImageRet = std::variant<std::monostate, AssetProcessor::AssetLoadResultCode, DecodedImageData>;
+
+struct ImageUploadInfo
+{
+    std::span<std::byte const> texels;
+    VkFormat format;
+    u32 width;
+    u32 height;
+    u32 mip_level_count;
+    u32 stored_mip_count;
+    // Mips before it are left to the texture streamer, the image only holds mips [base_mip, mip_level_count)
+    u32 base_mip = 0;
+    std::string name;
+};
+
 struct ParsedImageData
 {
-    ff::BufferId src_buffer;
     ff::ImageId dst_image;
+    std::vector<usize> stored_mip_offsets;
 };
 
-using ParsedImageRet = std::variant<std::monostate, AssetProcessor::AssetLoadResultCode, ParsedImageData>;
-
 enum struct ChannelDataType
 {
     SIGNED_INT,
@@ -313,11 +381,13 @@ constexpr static auto image_format_from_pixel_info(PixelInfo const & info) -> Vk
     return deduced_format;
 };
 
-static auto free_image_parse_raw_image_data(RawImageData && raw_data, std::shared_ptr<ff::Device> & device, bool is_normal) -> ParsedImageRet
+/// NOTE: Only touches CPU memory so it is safe to call from multiple threads at once.
+static auto free_image_parse_raw_image_data(RawImageData && raw_data, bool is_normal) -> DecodedImageRet
 {
     /// NOTE: Since we handle the image data loading ourselves we need to wrap the buffer with a FreeImage
     //        wrapper so that it can internally process the data
-    FIMEMORY * fif_memory_wrapper = FreeImage_OpenMemory(reinterpret_cast<BYTE *>(raw_data.raw_data.data()), raw_data.raw_data.size());
+    //        FreeImage only reads from memory opened this way, the cast is needed for its signature.
+    FIMEMORY * fif_memory_wrapper = FreeImage_OpenMemory(reinterpret_cast<BYTE *>(const_cast<std::byte *>(raw_data.raw_data.data())), raw_data.raw_data.size());
     defer { FreeImage_CloseMemory(fif_memory_wrapper); };
     FREE_IMAGE_FORMAT image_format = FreeImage_GetFileTypeFromMemory(fif_memory_wrapper, 0);
     // could not deduce filetype from metadata in memory try to guess the format from the file extension
@@ -389,42 +459,456 @@ static auto free_image_parse_raw_image_data(RawImageData && raw_data, std::share
     {
         if (channel_count == 3) FreeImage_Unload(modified_bitmap);
     };
-    ParsedImageData ret = {};
     u32 const total_image_byte_size = width * height * rounded_channel_count * channel_info.byte_size;
     FreeImage_FlipVertical(modified_bitmap);
-    ret.src_buffer = device->create_buffer({
-        .size = total_image_byte_size,
-        .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-        .name = raw_data.image_path.filename().string() + " staging",
-    });
-    std::byte * staging_dst_ptr = reinterpret_cast<std::byte *>(device->get_buffer_host_pointer(ret.src_buffer));
-    memcpy(staging_dst_ptr, reinterpret_cast<std::byte *>(FreeImage_GetBits(modified_bitmap)), total_image_byte_size);
-    u32 mip_levels = is_normal ? 1 : static_cast<u32>(std::floor(std::log2(std::max(width, height)))) + 1;
+    DecodedImageData ret = {
+        .texels = std::vector<std::byte>(total_image_byte_size),
+        .width = width,
+        .height = height,
+        .mip_level_count = static_cast<u32>(std::floor(std::log2(std::max(width, height)))) + 1,
+        .stored_mip_count = 1,
+        .format = vulkan_image_format,
+        .is_normal = is_normal,
+        .name = raw_data.image_path.filename().string(),
+    };
+    memcpy(ret.texels.data(), reinterpret_cast<std::byte *>(FreeImage_GetBits(modified_bitmap)), total_image_byte_size);
+    return ret;
+}
+
+static auto texel_byte_size(VkFormat format) -> u32
+{
+    switch (format)
+    {
+        case VkFormat::VK_FORMAT_R8_SRGB:
+        case VkFormat::VK_FORMAT_R8_UNORM:
+        case VkFormat::VK_FORMAT_R8_SINT:             return 1;
+        case VkFormat::VK_FORMAT_R8G8_SRGB:
+        case VkFormat::VK_FORMAT_R8G8_UNORM:
+        case VkFormat::VK_FORMAT_R8G8_SINT:
+        case VkFormat::VK_FORMAT_R16_UINT:
+        case VkFormat::VK_FORMAT_R16_SINT:
+        case VkFormat::VK_FORMAT_R16_SFLOAT:          return 2;
+        case VkFormat::VK_FORMAT_B8G8R8A8_SRGB:
+        case VkFormat::VK_FORMAT_B8G8R8A8_UNORM:
+        case VkFormat::VK_FORMAT_B8G8R8A8_SINT:
+        case VkFormat::VK_FORMAT_R16G16_UINT:
+        case VkFormat::VK_FORMAT_R16G16_SINT:
+        case VkFormat::VK_FORMAT_R16G16_SFLOAT:
+        case VkFormat::VK_FORMAT_R32_UINT:
+        case VkFormat::VK_FORMAT_R32_SINT:
+        case VkFormat::VK_FORMAT_R32_SFLOAT:          return 4;
+        case VkFormat::VK_FORMAT_R16G16B16A16_UINT:
+        case VkFormat::VK_FORMAT_R16G16B16A16_SINT:
+        case VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VkFormat::VK_FORMAT_R32G32_UINT:
+        case VkFormat::VK_FORMAT_R32G32_SINT:
+        case VkFormat::VK_FORMAT_R32G32_SFLOAT:       return 8;
+        case VkFormat::VK_FORMAT_R32G32B32_UINT:
+        case VkFormat::VK_FORMAT_R32G32B32_SINT:
+        case VkFormat::VK_FORMAT_R32G32B32_SFLOAT:    return 12;
+        case VkFormat::VK_FORMAT_R32G32B32A32_UINT:
+        case VkFormat::VK_FORMAT_R32G32B32A32_SINT:
+        case VkFormat::VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+        default:                                      return 0;
+    }
+}
+
+static auto mip_extent(u32 extent, u32 mip_level) -> u32
+{
+    return std::max(extent >> mip_level, 1u);
+}
+
+// Storage of a 16 bit float channel, converted through the glm half packing
+struct HalfChannel
+{
+    u16 bits;
+};
+
+// Channel layout of the formats image_format_from_pixel_info() produces, color channels come first
+struct MipTexelLayout
+{
+    u32 channel_count;
+    // The first srgb_channel_count channels are averaged in linear space
+    u32 srgb_channel_count;
+    u8 channel_byte_size;
+    ChannelDataType channel_data_type;
+};
+
+static auto get_mip_texel_layout(VkFormat format) -> std::optional<MipTexelLayout>
+{
+    using enum ChannelDataType;
+    switch (format)
+    {
+        case VkFormat::VK_FORMAT_R8_SRGB:             return MipTexelLayout{1, 1, 1, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R8_UNORM:            return MipTexelLayout{1, 0, 1, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R8_SINT:             return MipTexelLayout{1, 0, 1, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R8G8_SRGB:           return MipTexelLayout{2, 2, 1, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R8G8_UNORM:          return MipTexelLayout{2, 0, 1, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R8G8_SINT:           return MipTexelLayout{2, 0, 1, SIGNED_INT};
+        case VkFormat::VK_FORMAT_B8G8R8A8_SRGB:       return MipTexelLayout{4, 3, 1, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_B8G8R8A8_UNORM:      return MipTexelLayout{4, 0, 1, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_B8G8R8A8_SINT:       return MipTexelLayout{4, 0, 1, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R16_UINT:            return MipTexelLayout{1, 0, 2, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R16_SINT:            return MipTexelLayout{1, 0, 2, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R16_SFLOAT:          return MipTexelLayout{1, 0, 2, FLOATING_POINT};
+        case VkFormat::VK_FORMAT_R16G16_UINT:         return MipTexelLayout{2, 0, 2, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R16G16_SINT:         return MipTexelLayout{2, 0, 2, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R16G16_SFLOAT:       return MipTexelLayout{2, 0, 2, FLOATING_POINT};
+        case VkFormat::VK_FORMAT_R16G16B16A16_UINT:   return MipTexelLayout{4, 0, 2, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R16G16B16A16_SINT:   return MipTexelLayout{4, 0, 2, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT: return MipTexelLayout{4, 0, 2, FLOATING_POINT};
+        case VkFormat::VK_FORMAT_R32_UINT:            return MipTexelLayout{1, 0, 4, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R32_SINT:            return MipTexelLayout{1, 0, 4, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R32_SFLOAT:          return MipTexelLayout{1, 0, 4, FLOATING_POINT};
+        case VkFormat::VK_FORMAT_R32G32_UINT:         return MipTexelLayout{2, 0, 4, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R32G32_SINT:         return MipTexelLayout{2, 0, 4, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R32G32_SFLOAT:       return MipTexelLayout{2, 0, 4, FLOATING_POINT};
+        case VkFormat::VK_FORMAT_R32G32B32_UINT:      return MipTexelLayout{3, 0, 4, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R32G32B32_SINT:      return MipTexelLayout{3, 0, 4, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R32G32B32_SFLOAT:    return MipTexelLayout{3, 0, 4, FLOATING_POINT};
+        case VkFormat::VK_FORMAT_R32G32B32A32_UINT:   return MipTexelLayout{4, 0, 4, UNSIGNED_INT};
+        case VkFormat::VK_FORMAT_R32G32B32A32_SINT:   return MipTexelLayout{4, 0, 4, SIGNED_INT};
+        case VkFormat::VK_FORMAT_R32G32B32A32_SFLOAT: return MipTexelLayout{4, 0, 4, FLOATING_POINT};
+        default:                                      return std::nullopt;
+    }
+}
+
+static auto srgb_to_linear(u8 value) -> f64
+{
+    static std::array<f64, 256> const table = []()
+    {
+        std::array<f64, 256> ret = {};
+        for (u32 value = 0; value < 256; value++)
+        {
+            f64 const normalized = static_cast<f64>(value) / 255.0;
+            ret.at(value) = normalized <= 0.04045 ? normalized / 12.92 : std::pow((normalized + 0.055) / 1.055, 2.4);
+        }
+        return ret;
+    }();
+    return table[value];
+}
+
+static auto linear_to_srgb(f64 linear) -> f64
+{
+    return linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+}
+
+// Reads a channel as its stored value, sRGB channels are returned in linear space scaled to [0, 255]
+template <typename ChannelT>
+static auto load_mip_channel(u8 const * bytes, bool is_srgb) -> f64
+{
+    ChannelT value;
+    std::memcpy(&value, bytes, sizeof(ChannelT));
+    if constexpr (std::is_same_v<ChannelT, HalfChannel>)
+    {
+        return glm::unpackHalf1x16(value.bits);
+    }
+    else if constexpr (std::is_same_v<ChannelT, u8>)
+    {
+        return is_srgb ? srgb_to_linear(value) * 255.0 : static_cast<f64>(value);
+    }
+    else
+    {
+        return static_cast<f64>(value);
+    }
+}
+
+template <typename ChannelT>
+static void store_mip_channel(f64 value, u8 * bytes, bool is_srgb)
+{
+    ChannelT stored;
+    if constexpr (std::is_same_v<ChannelT, HalfChannel>)
+    {
+        stored = HalfChannel{glm::packHalf1x16(static_cast<f32>(value))};
+    }
+    else if constexpr (std::is_floating_point_v<ChannelT>)
+    {
+        stored = static_cast<ChannelT>(value);
+    }
+    else
+    {
+        if constexpr (std::is_same_v<ChannelT, u8>)
+        {
+            value = is_srgb ? linear_to_srgb(value / 255.0) * 255.0 : value;
+        }
+        f64 const min_value = static_cast<f64>(std::numeric_limits<ChannelT>::lowest());
+        f64 const max_value = static_cast<f64>(std::numeric_limits<ChannelT>::max());
+        stored = static_cast<ChannelT>(std::clamp(std::round(value), min_value, max_value));
+    }
+    std::memcpy(bytes, &stored, sizeof(ChannelT));
+}
+
+// Averages every 2x2 footprint of src into one dst texel, odd extents clamp the footprint to the last row/column
+template <typename ChannelT>
+static void downsample_mip(u8 const * src, u32 src_width, u32 src_height, u8 * dst, u32 dst_width, u32 dst_height, MipTexelLayout const & layout)
+{
+    usize const texel_byte_size = layout.channel_count * sizeof(ChannelT);
+    for (u32 y = 0; y < dst_height; y++)
+    {
+        u32 const src_y0 = std::min(y * 2, src_height - 1);
+        u32 const src_y1 = std::min(y * 2 + 1, src_height - 1);
+        for (u32 x = 0; x < dst_width; x++)
+        {
+            u32 const src_x0 = std::min(x * 2, src_width - 1);
+            u32 const src_x1 = std::min(x * 2 + 1, src_width - 1);
+            std::array<u8 const *, 4> const src_texels = {
+                src + (static_cast<usize>(src_y0) * src_width + src_x0) * texel_byte_size,
+                src + (static_cast<usize>(src_y0) * src_width + src_x1) * texel_byte_size,
+                src + (static_cast<usize>(src_y1) * src_width + src_x0) * texel_byte_size,
+                src + (static_cast<usize>(src_y1) * src_width + src_x1) * texel_byte_size,
+            };
+            u8 * dst_texel = dst + (static_cast<usize>(y) * dst_width + x) * texel_byte_size;
+            for (u32 channel = 0; channel < layout.channel_count; channel++)
+            {
+                bool const is_srgb = channel < layout.srgb_channel_count;
+                usize const channel_offset = channel * sizeof(ChannelT);
+                f64 sum = 0.0;
+                for (u8 const * src_texel : src_texels)
+                {
+                    sum += load_mip_channel<ChannelT>(src_texel + channel_offset, is_srgb);
+                }
+                store_mip_channel<ChannelT>(sum * 0.25, dst_texel + channel_offset, is_srgb);
+            }
+        }
+    }
+}
+
+/// NOTE: Normal maps store x in red and y in green remapped to [0, 255], the shaders reconstruct z from them.
+//        The 2x2 footprint is averaged as unit vectors and renormalized, a plain average would shorten the normals
+//        and the reconstructed z would tilt them. Blue, when present, gets the renormalized z, alpha is averaged.
+static void downsample_normal_mip(u8 const * src, u32 src_width, u32 src_height, u8 * dst, u32 dst_width, u32 dst_height, MipTexelLayout const & layout)
+{
+    // B8G8R8A8 stores red in byte 2, R8G8 in byte 0
+    bool const is_bgra = layout.channel_count == 4;
+    u32 const red = is_bgra ? 2 : 0;
+    u32 const green = 1;
+    usize const texel_byte_size = layout.channel_count;
+    auto const decode = [](u8 value) -> f32 { return static_cast<f32>(value) * (2.0f / 255.0f) - 1.0f; };
+    auto const encode = [](f32 value) -> u8 { return static_cast<u8>(std::clamp((value * 0.5f + 0.5f) * 255.0f + 0.5f, 0.0f, 255.0f)); };
+    for (u32 y = 0; y < dst_height; y++)
+    {
+        u32 const src_y0 = std::min(y * 2, src_height - 1);
+        u32 const src_y1 = std::min(y * 2 + 1, src_height - 1);
+        for (u32 x = 0; x < dst_width; x++)
+        {
+            u32 const src_x0 = std::min(x * 2, src_width - 1);
+            u32 const src_x1 = std::min(x * 2 + 1, src_width - 1);
+            std::array<u8 const *, 4> const src_texels = {
+                src + (static_cast<usize>(src_y0) * src_width + src_x0) * texel_byte_size,
+                src + (static_cast<usize>(src_y0) * src_width + src_x1) * texel_byte_size,
+                src + (static_cast<usize>(src_y1) * src_width + src_x0) * texel_byte_size,
+                src + (static_cast<usize>(src_y1) * src_width + src_x1) * texel_byte_size,
+            };
+            f32vec3 normal_sum = f32vec3(0.0f);
+            u32 alpha_sum = 0;
+            for (u8 const * src_texel : src_texels)
+            {
+                f32vec2 const normal_xy = f32vec2(decode(src_texel[red]), decode(src_texel[green]));
+                normal_sum += f32vec3(normal_xy, std::sqrt(std::max(1.0f - glm::dot(normal_xy, normal_xy), 0.0f)));
+                alpha_sum += is_bgra ? src_texel[3] : 0;
+            }
+            // Opposing normals cancel out, the footprint then points along the surface normal
+            f32 const normal_length = glm::length(normal_sum);
+            f32vec3 const normal = normal_length > 1e-6f ? normal_sum / normal_length : f32vec3(0.0f, 0.0f, 1.0f);
+            u8 * dst_texel = dst + (static_cast<usize>(y) * dst_width + x) * texel_byte_size;
+            dst_texel[red] = encode(normal.x);
+            dst_texel[green] = encode(normal.y);
+            if (is_bgra)
+            {
+                dst_texel[0] = encode(normal.z);
+                dst_texel[3] = static_cast<u8>((alpha_sum + 2) / 4);
+            }
+        }
+    }
+}
+
+/// NOTE: Generates the remaining mips with a 2x2 box filter. sRGB color channels are averaged in linear space,
+//        normal maps are renormalized, alpha and all other formats are averaged in their stored representation.
+//        Every decoded texture goes through this so that its whole mip chain is stored and copied on upload.
+static void generate_cpu_mip_chain(DecodedImageData & image)
+{
+    std::optional<MipTexelLayout> const layout = get_mip_texel_layout(image.format);
+    if (!layout.has_value())
+    {
+        // Unknown layout, only the decoded mip 0 is uploaded
+        image.mip_level_count = image.stored_mip_count;
+        return;
+    }
+    if (image.mip_level_count <= image.stored_mip_count)
+    {
+        return;
+    }
+    // Normal maps are always decoded into one of the 8 bit UNORM formats
+    bool const is_normal_map = image.is_normal && layout->channel_byte_size == 1 && layout->srgb_channel_count == 0 &&
+                               layout->channel_data_type == ChannelDataType::UNSIGNED_INT && layout->channel_count >= 2;
+    usize const texel_byte_size = layout->channel_count * layout->channel_byte_size;
+    usize total_byte_size = 0;
+    for (u32 mip_level = 0; mip_level < image.mip_level_count; mip_level++)
+    {
+        total_byte_size += static_cast<usize>(mip_extent(image.width, mip_level)) * mip_extent(image.height, mip_level) * texel_byte_size;
+    }
+    image.texels.resize(total_byte_size);
+
+    usize src_offset = 0;
+    for (u32 mip_level = 1; mip_level < image.mip_level_count; mip_level++)
+    {
+        u32 const src_width = mip_extent(image.width, mip_level - 1);
+        u32 const src_height = mip_extent(image.height, mip_level - 1);
+        u32 const dst_width = mip_extent(image.width, mip_level);
+        u32 const dst_height = mip_extent(image.height, mip_level);
+        usize const dst_offset = src_offset + static_cast<usize>(src_width) * src_height * texel_byte_size;
+        u8 const * src = reinterpret_cast<u8 const *>(image.texels.data() + src_offset);
+        u8 * dst = reinterpret_cast<u8 *>(image.texels.data() + dst_offset);
+        bool const is_float = layout->channel_data_type == ChannelDataType::FLOATING_POINT;
+        bool const is_signed = layout->channel_data_type == ChannelDataType::SIGNED_INT;
+        // Called with a value of the channel type, only its type is used
+        auto const downsample = [&](auto channel_type)
+        {
+            downsample_mip<decltype(channel_type)>(src, src_width, src_height, dst, dst_width, dst_height, *layout);
+        };
+        if (is_normal_map)
+        {
+            downsample_normal_mip(src, src_width, src_height, dst, dst_width, dst_height, *layout);
+            src_offset = dst_offset;
+            continue;
+        }
+        switch (layout->channel_byte_size)
+        {
+            case 1:
+            {
+                if (is_signed) { downsample(i8{}); }
+                else { downsample(u8{}); }
+                break;
+            }
+            case 2:
+            {
+                if (is_float) { downsample(HalfChannel{}); }
+                else if (is_signed) { downsample(i16{}); }
+                else { downsample(u16{}); }
+                break;
+            }
+            case 4:
+            {
+                if (is_float) { downsample(f32{}); }
+                else if (is_signed) { downsample(i32{}); }
+                else { downsample(u32{}); }
+                break;
+            }
+            default: break;
+        }
+        src_offset = dst_offset;
+    }
+    image.stored_mip_count = image.mip_level_count;
+}
+
+static auto mip_byte_size(VkFormat format, u32 width, u32 height) -> usize
+{
+    if (is_block_compressed_format(format))
+    {
+        return block_compressed_mip_byte_size(format, width, height);
+    }
+    return static_cast<usize>(width) * height * texel_byte_size(format);
+}
+
+/// NOTE: Replaces the stored mips with their block compressed version, needs the full mip chain on the CPU.
+//        Albedo keeps its alpha in BC3 only if mip 0 has a texel which is not fully opaque, otherwise it becomes BC1.
+static void compress_cpu_mip_chain(DecodedImageData & image)
+{
+    if (image.stored_mip_count < image.mip_level_count)
+    {
+        return;
+    }
+    bool has_alpha = false;
+    if (image.format == VkFormat::VK_FORMAT_B8G8R8A8_SRGB)
+    {
+        for (usize texel = 0; texel < static_cast<usize>(image.width) * image.height && !has_alpha; texel++)
+        {
+            has_alpha = static_cast<u8>(image.texels.at(texel * 4 + 3)) != 255;
+        }
+    }
+    VkFormat const compressed_format = get_block_compressed_format(image.format, has_alpha);
+    if (compressed_format == VkFormat::VK_FORMAT_UNDEFINED)
+    {
+        return;
+    }
+    usize compressed_byte_size = 0;
+    for (u32 mip_level = 0; mip_level < image.mip_level_count; mip_level++)
+    {
+        compressed_byte_size += mip_byte_size(compressed_format, mip_extent(image.width, mip_level), mip_extent(image.height, mip_level));
+    }
+    std::vector<std::byte> compressed_texels(compressed_byte_size);
+    usize src_offset = 0;
+    usize dst_offset = 0;
+    for (u32 mip_level = 0; mip_level < image.mip_level_count; mip_level++)
+    {
+        u32 const width = mip_extent(image.width, mip_level);
+        u32 const height = mip_extent(image.height, mip_level);
+        usize const src_size = mip_byte_size(image.format, width, height);
+        usize const dst_size = mip_byte_size(compressed_format, width, height);
+        compress_mip(image.format, compressed_format,
+                     std::span(image.texels).subspan(src_offset, src_size), width, height,
+                     std::span(compressed_texels).subspan(dst_offset, dst_size));
+        src_offset += src_size;
+        dst_offset += dst_size;
+    }
+    image.texels = std::move(compressed_texels);
+    image.format = compressed_format;
+}
+
+/// NOTE: Creates the GPU side resources, must be called from a single thread as the device is not thread safe.
+//        The texels themselves are copied into the staging ring when the upload commands are recorded.
+static auto create_image_upload_resources(ImageUploadInfo const & info, std::shared_ptr<ff::Device> & device) -> ParsedImageData
+{
+    ParsedImageData ret = {};
+    usize mip_offset = 0;
+    for (u32 mip_level = 0; mip_level < info.stored_mip_count; mip_level++)
+    {
+        ret.stored_mip_offsets.push_back(mip_offset);
+        mip_offset += mip_byte_size(info.format, mip_extent(info.width, mip_level), mip_extent(info.height, mip_level));
+    }
+    DBG_ASSERT_TRUE_M(mip_offset == info.texels.size(), "[ERROR][create_image_upload_resources()] Texel data size does not match the stored mips");
+    DBG_ASSERT_TRUE_M(info.stored_mip_count == info.mip_level_count, "[ERROR][create_image_upload_resources()] Textures must store their whole mip chain");
     VkImageUsageFlags usage_flags = VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_DST_BIT | VkImageUsageFlagBits::VK_IMAGE_USAGE_SAMPLED_BIT;
-    if (mip_levels > 1)
+    // Streamed textures get copied into a new image whenever their resident mips change
+    if (info.base_mip > 0)
     {
         usage_flags |= VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     }
     ret.dst_image = device->create_image({
         .dimensions = 2,
-        .format = vulkan_image_format,
-        .extent = {width, height, 1},
-        .mip_level_count = mip_levels,
+        .format = info.format,
+        .extent = {mip_extent(info.width, info.base_mip), mip_extent(info.height, info.base_mip), 1},
+        .mip_level_count = info.mip_level_count - info.base_mip,
         .array_layer_count = 1,
         .sample_count = 1,
         /// TODO: Potentially take more flags from the user here
         .usage = usage_flags,
         .alloc_flags = {},
         .aspect = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-        .name = raw_data.image_path.filename().string(),
+        .name = info.name,
     });
     return ret;
 }
 
+static auto image_upload_info_from_decoded(DecodedImageData const & decoded_data) -> ImageUploadInfo
+{
+    return ImageUploadInfo{
+        .texels = decoded_data.texels,
+        .format = decoded_data.format,
+        .width = decoded_data.width,
+        .height = decoded_data.height,
+        .mip_level_count = decoded_data.mip_level_count,
+        .stored_mip_count = decoded_data.stored_mip_count,
+        .name = decoded_data.name,
+    };
+}
+
 #pragma endregion
 
-AssetProcessor::AssetProcessor(std::shared_ptr<ff::Device> device)
-    : _device{device}
+AssetProcessor::AssetProcessor(std::shared_ptr<ff::Device> device, u32 worker_thread_count)
+    : _device{device},
+      _thread_pool{std::make_unique<ff::ThreadPool>(worker_thread_count)},
+      _file_reader{std::make_unique<ff::AsyncFileReader>()}
 {
 // call this ONLY when linking with FreeImage as a static library
 #ifdef FREEIMAGE_LIB
@@ -440,13 +924,14 @@ AssetProcessor::~AssetProcessor()
 #endif
 }
 
-auto AssetProcessor::load_texture(Scene & scene, u32 texture_manifest_index) -> AssetLoadResultCode
+/// NOTE: Reads and decodes the texture into CPU memory. Does not touch the device so it can run on worker threads.
+//        The file contents are taken from prefetched when the texture was read ahead.
+static auto decode_texture(Scene const & scene, u32 texture_manifest_index, ff::FileReadResult * prefetched = nullptr) -> DecodedImageRet
 {
     TextureManifestEntry const & texture_entry = scene._material_texture_manifest.at(texture_manifest_index);
     SceneFileManifestEntry const & scene_entry = scene._scene_file_manifest.at(texture_entry.scene_file_manifest_index);
     fastgltf::Asset const & gltf_asset = scene_entry.gltf_asset;
     fastgltf::Image const & image = gltf_asset.images.at(texture_entry.in_scene_file_index);
-    std::vector<std::byte> raw_data = {};
 
     RawDataRet ret = {};
     if (auto const * uri = std::get_if<fastgltf::sources::URI>(&image.data))
@@ -454,64 +939,97 @@ auto AssetProcessor::load_texture(Scene & scene, u32 texture_manifest_index) ->
         ret = std::move(raw_image_data_from_URI(RawImageDataFromURIInfo{
             .uri = *uri,
             .asset = gltf_asset,
-            .scene_dir_path = std::filesystem::path(scene_entry.path).remove_filename()}));
+            .scene_dir_path = std::filesystem::path(scene_entry.path).remove_filename(),
+            .prefetched = prefetched}));
     }
     else if (auto const * buffer_view = std::get_if<fastgltf::sources::BufferView>(&image.data))
     {
         ret = std::move(raw_image_data_from_buffer_view(RawImageDataFromBufferViewInfo{
             .buffer_view = *buffer_view,
-            .asset = gltf_asset,
-            .scene_dir_path = std::filesystem::path(scene_entry.path).remove_filename()}));
+            .scene_entry = scene_entry}));
     }
     else
     {
-        return AssetLoadResultCode::ERROR_FAULTY_BUFFER_VIEW;
+        return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_BUFFER_VIEW;
     }
 
-    if (auto const * error = std::get_if<AssetLoadResultCode>(&ret))
+    if (auto const * error = std::get_if<AssetProcessor::AssetLoadResultCode>(&ret))
     {
         return *error;
     }
     RawImageData & raw_image_data = std::get<RawImageData>(ret);
-    ParsedImageRet parsed_data_ret;
     if (raw_image_data.mime_type == fastgltf::MimeType::KTX2)
     {
         // KTX handles image loading
+        return std::monostate{};
     }
-    else
+    // FreeImage handles image loading
+    bool is_diffuse = false;
+    bool is_normal = false;
+    for (auto const & indices : texture_entry.material_manifest_indices)
     {
-        // FreeImage handles image loading
-        bool is_diffuse = false;
-        bool is_normal = false;
-        for (auto const & indices : texture_entry.material_manifest_indices)
-        {
-            is_diffuse |= indices.diffuse;
-            is_normal |= indices.normal;
-        }
-        if (!(is_diffuse || is_normal))
-        {
-            APP_LOG(fmt::format(
-                "[INFO][AssetProcessor::load_texture()] Skipping texture {} because"
-                "it is not referenced as normal or diffuse by any mesh",
-                texture_manifest_index));
-            return AssetLoadResultCode::SUCCESS;
-        }
-        DBG_ASSERT_TRUE_M(!(is_diffuse && is_normal),
-                          "[ERROR][AssetProcessor::load_texture()] Texture {} used both as normal map and diffuse map - not supported");
-        parsed_data_ret = free_image_parse_raw_image_data(std::move(raw_image_data), _device, is_normal);
+        is_diffuse |= indices.diffuse;
+        is_normal |= indices.normal;
+    }
+    if (!(is_diffuse || is_normal))
+    {
+        APP_LOG(fmt::format(
+            "[INFO][AssetProcessor::load_texture()] Skipping texture {} because"
+            "it is not referenced as normal or diffuse by any mesh",
+            texture_manifest_index));
+        return std::monostate{};
+    }
+    DBG_ASSERT_TRUE_M(!(is_diffuse && is_normal),
+                      "[ERROR][AssetProcessor::load_texture()] Texture {} used both as normal map and diffuse map - not supported");
+    return free_image_parse_raw_image_data(std::move(raw_image_data), is_normal);
+}
+
+void AssetProcessor::set_texture_streamer(TextureStreamer * texture_streamer)
+{
+    _texture_streamer = texture_streamer;
+}
+
+auto AssetProcessor::get_streamed_base_mip(u32 width, u32 height, u32 mip_level_count) const -> u32
+{
+    // The streamer loads the missing mips from the CPU side texels
+    if (_texture_streamer == nullptr)
+    {
+        return 0;
     }
-    if (auto const * error = std::get_if<AssetProcessor::AssetLoadResultCode>(&parsed_data_ret))
+    return _texture_streamer->get_mip_tail_start(width, height, mip_level_count);
+}
+
+auto AssetProcessor::load_texture(Scene & scene, u32 texture_manifest_index) -> AssetLoadResultCode
+{
+    DecodedImageRet decoded_data_ret = decode_texture(scene, texture_manifest_index);
+    if (auto const * error = std::get_if<AssetProcessor::AssetLoadResultCode>(&decoded_data_ret))
     {
         return *error;
     }
-    ParsedImageData const & parsed_data = std::get<ParsedImageData>(parsed_data_ret);
+    if (std::holds_alternative<std::monostate>(decoded_data_ret))
+    {
+        return AssetLoadResultCode::SUCCESS;
+    }
+    DecodedImageData & decoded_data = std::get<DecodedImageData>(decoded_data_ret);
+    generate_cpu_mip_chain(decoded_data);
+    compress_cpu_mip_chain(decoded_data);
+    ImageUploadInfo upload_info = image_upload_info_from_decoded(decoded_data);
+    upload_info.base_mip = get_streamed_base_mip(decoded_data.width, decoded_data.height, decoded_data.mip_level_count);
+    ParsedImageData parsed_data = create_image_upload_resources(upload_info, _device);
     /// NOTE: Append the processed texture to the upload queue.
     {
         _upload_texture_queue.push_back(TextureUpload{
             .scene = &scene,
-            .staging_buffer = parsed_data.src_buffer,
             .dst_image = parsed_data.dst_image,
-            .texture_manifest_index = texture_manifest_index});
+            .texture_manifest_index = texture_manifest_index,
+            .format = decoded_data.format,
+            .width = decoded_data.width,
+            .height = decoded_data.height,
+            .mip_level_count = decoded_data.mip_level_count,
+            .stored_mip_count = decoded_data.stored_mip_count,
+            .base_mip = upload_info.base_mip,
+            .stored_mip_offsets = std::move(parsed_data.stored_mip_offsets),
+            .texels = std::move(decoded_data.texels)});
     }
     return AssetLoadResultCode::SUCCESS;
 }
@@ -531,81 +1049,213 @@ struct fastgltf::ElementTraits<glm::vec2> : fastgltf::ElementTraitsBase<float, f
 {
 };
 
+/// NOTE: Accessors are read straight out of the mapped glTF buffers, fastgltf converts the components and
+//        applies the strides while copying into the returned vector. Index buffers are widened to 32 bits.
 template <typename ElemT, bool IS_INDEX_BUFFER>
-auto load_accessor_data_from_file(
-    std::filesystem::path const & root_path,
-    fastgltf::Asset const & gltf_asset,
+auto load_accessor_data(
+    SceneFileManifestEntry const & scene_entry,
     fastgltf::Accessor const & accesor)
     -> std::variant<std::vector<ElemT>, AssetProcessor::AssetLoadResultCode>
 {
     static_assert(!IS_INDEX_BUFFER || std::is_same_v<ElemT, u32>, "Index Buffer must be u32");
+    fastgltf::Asset const & gltf_asset = scene_entry.gltf_asset;
     fastgltf::BufferView const & gltf_buffer_view = gltf_asset.bufferViews.at(accesor.bufferViewIndex.value());
-    fastgltf::Buffer const & gltf_buffer = gltf_asset.buffers.at(gltf_buffer_view.bufferIndex);
-    if (!std::holds_alternative<fastgltf::sources::URI>(gltf_buffer.data))
-    {
-        return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_BUFFER_VIEW;
-    }
-    fastgltf::sources::URI uri = std::get<fastgltf::sources::URI>(gltf_buffer.data);
-
-    /// NOTE: load the section of the file containing the buffer for the mesh index buffer.
-    std::filesystem::path const full_buffer_path = root_path / uri.uri.fspath();
-    std::ifstream ifs{full_buffer_path, std::ios::binary};
-    if (!ifs)
+    auto buffer_data_ret = get_gltf_buffer_data(scene_entry, gltf_buffer_view.bufferIndex);
+    if (auto const * error = std::get_if<AssetProcessor::AssetLoadResultCode>(&buffer_data_ret))
     {
-        return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_OPEN_GLTF;
+        return *error;
     }
-    /// NOTE: Only load the relevant part of the file containing the view of the buffer we actually need.
-    ifs.seekg(gltf_buffer_view.byteOffset + accesor.byteOffset + uri.fileByteOffset);
-    std::vector<u16> raw = {};
-    raw.resize(gltf_buffer_view.byteLength / 2);
-    /// NOTE: Only load the relevant part of the file containing the view of the buffer we actually need.
+    std::span<std::byte const> const buffer_data = std::get<std::span<std::byte const>>(buffer_data_ret);
     auto const elem_byte_size = fastgltf::getElementByteSize(accesor.type, accesor.componentType);
-    if (!ifs.read(reinterpret_cast<char *>(raw.data()), accesor.count * elem_byte_size))
+    usize const elem_stride = gltf_buffer_view.byteStride.has_value() ? gltf_buffer_view.byteStride.value() : elem_byte_size;
+    usize const accessed_byte_size = accesor.count == 0 ? 0 : (accesor.count - 1) * elem_stride + elem_byte_size;
+    if (gltf_buffer_view.byteOffset + gltf_buffer_view.byteLength > buffer_data.size() ||
+        accesor.byteOffset + accessed_byte_size > gltf_buffer_view.byteLength)
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_COULD_NOT_READ_BUFFER_IN_GLTF;
     }
-    auto buffer_adapter = [&](fastgltf::Buffer const & buffer)
+    auto buffer_adapter = [&](fastgltf::Buffer const & buffer) -> std::byte const *
     {
-        /// NOTE:   We only have a ptr to the loaded data to the accessors section of the buffer.
-        ///         Fastgltf expects a ptr to the begin of the buffer, so we just subtract the offsets.
-        ///         Fastgltf adds these on in the accessor tool, so in the end it gets the right ptr.
-        auto const fastgltf_reverse_byte_offset = (gltf_buffer_view.byteOffset + accesor.byteOffset);
-        return reinterpret_cast<std::byte *>(raw.data()) - fastgltf_reverse_byte_offset;
+        /// NOTE: Sparse accessors may reference other buffers of the file, those are mapped as well.
+        usize const buffer_index = static_cast<usize>(&buffer - gltf_asset.buffers.data());
+        if (buffer_index == gltf_buffer_view.bufferIndex)
+        {
+            return buffer_data.data();
+        }
+        auto other_buffer_data_ret = get_gltf_buffer_data(scene_entry, buffer_index);
+        auto const * other_buffer_data = std::get_if<std::span<std::byte const>>(&other_buffer_data_ret);
+        return other_buffer_data != nullptr ? other_buffer_data->data() : nullptr;
     };
 
     std::vector<ElemT> ret(accesor.count);
     if constexpr (IS_INDEX_BUFFER)
     {
-        /// NOTE: Transform the loaded file section into a 32 bit index buffer.
-        if (accesor.componentType == fastgltf::ComponentType::UnsignedShort)
+        if (accesor.componentType != fastgltf::ComponentType::UnsignedShort &&
+            accesor.componentType != fastgltf::ComponentType::UnsignedInt)
         {
-            std::vector<u16> u16_index_buffer(accesor.count);
-            fastgltf::copyFromAccessor<u16>(gltf_asset, accesor, u16_index_buffer.data(), buffer_adapter);
-            for (size_t i = 0; i < u16_index_buffer.size(); ++i)
-            {
-                ret[i] = static_cast<u32>(u16_index_buffer[i]);
-            }
+            return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_INDEX_BUFFER_GLTF_ACCESSOR;
         }
-        else
+    }
+    fastgltf::copyFromAccessor<ElemT>(gltf_asset, accesor, ret.data(), buffer_adapter);
+    return {std::move(ret)};
+}
+
+/// NOTE: Every lod targets half the index count of the previous one. Each lod is simplified from the previous one, so
+//        its error is the sum of the errors of all simplification steps. The chain stops early once the simplifier
+//        can no longer meaningfully reduce the mesh without exceeding the error bound.
+static constexpr f32 LOD_SIMPLIFICATION_MAX_RELATIVE_ERROR = 0.05f;
+static constexpr f32 LOD_MIN_INDEX_REDUCTION = 0.85f;
+static auto generate_lod_chain(std::vector<u32> & indices, std::vector<f32vec3> const & positions, std::array<MeshLod, MAX_MESH_LODS> & lods) -> u32
+{
+    lods.at(0) = MeshLod{.index_count = static_cast<u32>(indices.size()), .first_index = 0, .error = 0.0f};
+    u32 lod_count = 1;
+    f32 const error_scale = meshopt_simplifyScale(&positions.at(0).x, positions.size(), sizeof(f32vec3));
+    std::vector<u32> lod_indices = {};
+    for (; lod_count < MAX_MESH_LODS; ++lod_count)
+    {
+        MeshLod const & prev_lod = lods.at(lod_count - 1);
+        usize const target_index_count = (prev_lod.index_count / 2 / 3) * 3;
+        if (target_index_count < 3) { break; }
+        lod_indices.resize(prev_lod.index_count);
+        f32 result_error = 0.0f;
+        usize const lod_index_count = meshopt_simplify(
+            lod_indices.data(),
+            indices.data() + prev_lod.first_index,
+            prev_lod.index_count,
+            &positions.at(0).x,
+            positions.size(),
+            sizeof(f32vec3),
+            target_index_count,
+            LOD_SIMPLIFICATION_MAX_RELATIVE_ERROR,
+            0,
+            &result_error);
+        if (lod_index_count == 0 || static_cast<f32>(lod_index_count) > static_cast<f32>(prev_lod.index_count) * LOD_MIN_INDEX_REDUCTION)
         {
-            fastgltf::copyFromAccessor<u32>(gltf_asset, accesor, ret.data(), buffer_adapter);
+            break;
         }
+        lods.at(lod_count) = MeshLod{
+            .index_count = static_cast<u32>(lod_index_count),
+            .first_index = static_cast<u32>(indices.size()),
+            .error = prev_lod.error + result_error * error_scale,
+        };
+        indices.insert(indices.end(), lod_indices.begin(), lod_indices.begin() + lod_index_count);
     }
-    else
+    return lod_count;
+}
+
+/// NOTE: ACMR is the average number of vertex shader invocations per triangle, 0.5 is the lower bound for a regular
+//        grid and 3 means no reuse at all. ATVR is invocations per vertex, 1 is ideal. Both are measured against a
+//        simulated fifo cache of VERTEX_CACHE_SIZE entries.
+static constexpr u32 VERTEX_CACHE_SIZE = 16;
+static auto analyze_vertex_cache(std::span<u32 const> indices, usize vertex_count) -> AssetProcessor::VertexCacheStatistics
+{
+    meshopt_VertexCacheStatistics const statistics = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertex_count, VERTEX_CACHE_SIZE, 0, 0);
+    return AssetProcessor::VertexCacheStatistics{.acmr = statistics.acmr, .atvr = statistics.atvr};
+}
+
+/// NOTE: Every lod is first reordered for the post transform cache and then clustered for overdraw. The overdraw pass
+//        may only worsen the cache efficiency by OVERDRAW_MAX_CACHE_DEGRADATION relative to the cache optimized order.
+static constexpr f32 OVERDRAW_MAX_CACHE_DEGRADATION = 1.05f;
+static void optimize_lod_triangle_order(std::vector<u32> & indices, std::vector<f32vec3> const & positions, std::span<MeshLod const> lods)
+{
+    for (MeshLod const & lod : lods)
     {
-        fastgltf::copyFromAccessor<ElemT>(gltf_asset, accesor, ret.data(), buffer_adapter);
+        u32 * const lod_indices = indices.data() + lod.first_index;
+        meshopt_optimizeVertexCache(lod_indices, lod_indices, lod.index_count, positions.size());
+        meshopt_optimizeOverdraw(lod_indices, lod_indices, lod.index_count, &positions.at(0).x, positions.size(), sizeof(f32vec3), OVERDRAW_MAX_CACHE_DEGRADATION);
     }
-    return {std::move(ret)};
 }
 
-auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetProcessor::AssetLoadResultCode
+/// NOTE: Reorders the vertices in the order they are first referenced by the indices of all lods, vertices no lod
+//        references are dropped. All four attribute streams are remapped with the same table.
+static void optimize_vertex_fetch(
+    std::vector<u32> & indices,
+    std::vector<f32vec3> & positions,
+    std::vector<f32vec2> & uvs,
+    std::vector<f32vec4> & tangents,
+    std::vector<f32vec3> & normals)
 {
-    MeshManifestEntry & mesh_data = scene._mesh_manifest.at(mesh_manifest_index);
-    SceneFileManifestEntry & gltf_scene = scene._scene_file_manifest.at(mesh_data.scene_file_manifest_index);
-    fastgltf::Asset & gltf_asset = gltf_scene.gltf_asset;
+    std::vector<u32> remap(positions.size());
+    usize const vertex_count = meshopt_optimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), positions.size());
+    meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+    auto remap_stream = [&]<typename T>(std::vector<T> & stream)
+    {
+        meshopt_remapVertexBuffer(stream.data(), stream.data(), stream.size(), sizeof(T), remap.data());
+        stream.resize(vertex_count);
+    };
+    remap_stream(positions);
+    remap_stream(uvs);
+    remap_stream(tangents);
+    remap_stream(normals);
+}
 
-    fastgltf::Mesh & gltf_mesh = gltf_asset.meshes[mesh_data.scene_file_mesh_index];
-    fastgltf::Primitive & gltf_prim = gltf_mesh.primitives[mesh_data.scene_file_primitive_index];
+/// NOTE: Reorders the indices of every lod so that the triangles of each meshlet are contiguous. The meshlet builder
+//        walks the triangles in the order optimize_lod_triangle_order() left them in, so the meshlets stay tight and
+//        the order inside each meshlet keeps most of the vertex reuse.
+static constexpr f32 MESHLET_CONE_WEIGHT = 0.25f;
+static void build_lod_meshlets(std::vector<u32> & indices, std::vector<f32vec3> const & positions, std::span<MeshLod> lods, std::vector<Meshlet> & meshlets)
+{
+    std::vector<meshopt_Meshlet> lod_meshlets = {};
+    std::vector<u32> meshlet_vertices = {};
+    std::vector<u8> meshlet_triangles = {};
+    for (MeshLod & lod : lods)
+    {
+        u32 * const lod_indices = indices.data() + lod.first_index;
+        usize const max_meshlet_count = meshopt_buildMeshletsBound(lod.index_count, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+        lod_meshlets.resize(max_meshlet_count);
+        meshlet_vertices.resize(max_meshlet_count * MESHLET_MAX_VERTICES);
+        meshlet_triangles.resize(max_meshlet_count * MESHLET_MAX_TRIANGLES * 3);
+        usize const meshlet_count = meshopt_buildMeshlets(
+            lod_meshlets.data(),
+            meshlet_vertices.data(),
+            meshlet_triangles.data(),
+            lod_indices,
+            lod.index_count,
+            &positions.at(0).x,
+            positions.size(),
+            sizeof(f32vec3),
+            MESHLET_MAX_VERTICES,
+            MESHLET_MAX_TRIANGLES,
+            MESHLET_CONE_WEIGHT);
+
+        lod.first_meshlet = static_cast<u32>(meshlets.size());
+        lod.meshlet_count = static_cast<u32>(meshlet_count);
+        u32 lod_index = 0;
+        for (usize meshlet_index = 0; meshlet_index < meshlet_count; meshlet_index++)
+        {
+            meshopt_Meshlet const & meshlet = lod_meshlets.at(meshlet_index);
+            meshopt_Bounds const bounds = meshopt_computeMeshletBounds(
+                &meshlet_vertices.at(meshlet.vertex_offset),
+                &meshlet_triangles.at(meshlet.triangle_offset),
+                meshlet.triangle_count,
+                &positions.at(0).x,
+                positions.size(),
+                sizeof(f32vec3));
+            meshlets.push_back(Meshlet{
+                .center = f32vec3(bounds.center[0], bounds.center[1], bounds.center[2]),
+                .radius = bounds.radius,
+                .cone_axis = f32vec3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]),
+                .cone_cutoff = bounds.cone_cutoff,
+                .first_index = lod.first_index + lod_index,
+                .triangle_count = meshlet.triangle_count,
+            });
+            for (u32 triangle_index = 0; triangle_index < meshlet.triangle_count * 3; triangle_index++)
+            {
+                lod_indices[lod_index++] = meshlet_vertices.at(meshlet.vertex_offset + meshlet_triangles.at(meshlet.triangle_offset + triangle_index));
+            }
+        }
+        DBG_ASSERT_TRUE_M(lod_index == lod.index_count, "[AssetProcessor::build_lod_meshlets()] Meshlets do not cover all triangles");
+    }
+}
+
+auto AssetProcessor::read_mesh_data(Scene const & scene, u32 mesh_manifest_index) -> std::variant<MeshData, AssetProcessor::AssetLoadResultCode>
+{
+    MeshManifestEntry const & mesh_data = scene._mesh_manifest.at(mesh_manifest_index);
+    SceneFileManifestEntry const & gltf_scene = scene._scene_file_manifest.at(mesh_data.scene_file_manifest_index);
+    fastgltf::Asset const & gltf_asset = gltf_scene.gltf_asset;
+
+    fastgltf::Mesh const & gltf_mesh = gltf_asset.meshes[mesh_data.scene_file_mesh_index];
+    fastgltf::Primitive const & gltf_prim = gltf_mesh.primitives[mesh_data.scene_file_primitive_index];
 
 /// NOTE: Process indices (they are required)
 #pragma region INDICES
@@ -613,7 +1263,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_MISSING_INDEX_BUFFER;
     }
-    fastgltf::Accessor & index_buffer_gltf_accessor = gltf_asset.accessors.at(gltf_prim.indicesAccessor.value());
+    fastgltf::Accessor const & index_buffer_gltf_accessor = gltf_asset.accessors.at(gltf_prim.indicesAccessor.value());
     bool const index_buffer_accessor_valid =
         (index_buffer_gltf_accessor.componentType == fastgltf::ComponentType::UnsignedInt ||
          index_buffer_gltf_accessor.componentType == fastgltf::ComponentType::UnsignedShort) &&
@@ -623,7 +1273,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_INDEX_BUFFER_GLTF_ACCESSOR;
     }
-    auto index_buffer_data = load_accessor_data_from_file<u32, true>(std::filesystem::path{gltf_scene.path}.remove_filename(), gltf_asset, index_buffer_gltf_accessor);
+    auto index_buffer_data = load_accessor_data<u32, true>(gltf_scene, index_buffer_gltf_accessor);
     if (auto const * err = std::get_if<AssetProcessor::AssetLoadResultCode>(&index_buffer_data))
     {
         return *err;
@@ -638,7 +1288,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_MISSING_VERTEX_POSITIONS;
     }
-    fastgltf::Accessor & gltf_vertex_pos_accessor = gltf_asset.accessors.at(vert_attrib_iter->second);
+    fastgltf::Accessor const & gltf_vertex_pos_accessor = gltf_asset.accessors.at(vert_attrib_iter->second);
     bool const gltf_vertex_pos_accessor_valid =
         gltf_vertex_pos_accessor.componentType == fastgltf::ComponentType::Float &&
         gltf_vertex_pos_accessor.type == fastgltf::AccessorType::Vec3;
@@ -646,14 +1296,14 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_GLTF_VERTEX_POSITIONS;
     }
-    // TODO: we can probably load this directly into the staging buffer.
-    auto vertex_pos_result = load_accessor_data_from_file<glm::vec3, false>(std::filesystem::path{gltf_scene.path}.remove_filename(), gltf_asset, gltf_vertex_pos_accessor);
+    /// NOTE: The attributes are copied out of the mapping once, the lod, cache and meshlet passes below reorder
+    //        them in place so they can not be written into the staging memory before the whole scene is read.
+    auto vertex_pos_result = load_accessor_data<glm::vec3, false>(gltf_scene, gltf_vertex_pos_accessor);
     if (auto const * err = std::get_if<AssetProcessor::AssetLoadResultCode>(&vertex_pos_result))
     {
         return *err;
     }
     std::vector<glm::vec3> vert_positions = std::get<std::vector<glm::vec3>>(std::move(vertex_pos_result));
-    u32 const vertex_count = static_cast<u32>(vert_positions.size());
 #pragma endregion
 
 /// NOTE: Load vertex UVs
@@ -663,7 +1313,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_MISSING_VERTEX_TEXCOORD_0;
     }
-    fastgltf::Accessor & gltf_vertex_texcoord0_accessor = gltf_asset.accessors.at(texcoord0_attrib_iter->second);
+    fastgltf::Accessor const & gltf_vertex_texcoord0_accessor = gltf_asset.accessors.at(texcoord0_attrib_iter->second);
     bool const gltf_vertex_texcoord0_accessor_valid =
         gltf_vertex_texcoord0_accessor.componentType == fastgltf::ComponentType::Float &&
         gltf_vertex_texcoord0_accessor.type == fastgltf::AccessorType::Vec2;
@@ -671,7 +1321,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_GLTF_VERTEX_TEXCOORD_0;
     }
-    auto vertex_texcoord0_pos_result = load_accessor_data_from_file<glm::vec2, false>(std::filesystem::path{gltf_scene.path}.remove_filename(), gltf_asset, gltf_vertex_texcoord0_accessor);
+    auto vertex_texcoord0_pos_result = load_accessor_data<glm::vec2, false>(gltf_scene, gltf_vertex_texcoord0_accessor);
     if (auto const * err = std::get_if<AssetProcessor::AssetLoadResultCode>(&vertex_texcoord0_pos_result))
     {
         return *err;
@@ -685,7 +1335,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_MISSING_VERTEX_TANGENT;
     }
-    fastgltf::Accessor & gltf_vertex_tangent_accessor = gltf_asset.accessors.at(tangent_attrib_iter->second);
+    fastgltf::Accessor const & gltf_vertex_tangent_accessor = gltf_asset.accessors.at(tangent_attrib_iter->second);
     bool const gltf_vertex_tangent_accessor_valid =
         gltf_vertex_tangent_accessor.componentType == fastgltf::ComponentType::Float &&
         gltf_vertex_tangent_accessor.type == fastgltf::AccessorType::Vec4;
@@ -693,7 +1343,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_GLTF_VERTEX_TANGENT;
     }
-    auto vertex_tangent_pos_result = load_accessor_data_from_file<glm::vec4, false>(std::filesystem::path{gltf_scene.path}.remove_filename(), gltf_asset, gltf_vertex_tangent_accessor);
+    auto vertex_tangent_pos_result = load_accessor_data<glm::vec4, false>(gltf_scene, gltf_vertex_tangent_accessor);
     if (auto const * err = std::get_if<AssetProcessor::AssetLoadResultCode>(&vertex_tangent_pos_result))
     {
         return *err;
@@ -708,7 +1358,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_MISSING_VERTEX_NORMAL;
     }
-    fastgltf::Accessor & gltf_vertex_normal_accessor = gltf_asset.accessors.at(normal_attrib_iter->second);
+    fastgltf::Accessor const & gltf_vertex_normal_accessor = gltf_asset.accessors.at(normal_attrib_iter->second);
     bool const gltf_vertex_normal_accessor_valid =
         gltf_vertex_normal_accessor.componentType == fastgltf::ComponentType::Float &&
         gltf_vertex_normal_accessor.type == fastgltf::AccessorType::Vec3;
@@ -716,7 +1366,7 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     {
         return AssetProcessor::AssetLoadResultCode::ERROR_FAULTY_GLTF_VERTEX_NORMAL;
     }
-    auto vertex_normal_pos_result = load_accessor_data_from_file<glm::vec3, false>(std::filesystem::path{gltf_scene.path}.remove_filename(), gltf_asset, gltf_vertex_normal_accessor);
+    auto vertex_normal_pos_result = load_accessor_data<glm::vec3, false>(gltf_scene, gltf_vertex_normal_accessor);
     if (auto const * err = std::get_if<AssetProcessor::AssetLoadResultCode>(&vertex_normal_pos_result))
     {
         return *err;
@@ -725,33 +1375,105 @@ auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetP
     DBG_ASSERT_TRUE_M(vert_normals.size() == vert_positions.size(), "[AssetProcessor::load_mesh()] Mismatched normal and uv count");
 #pragma endregion
 
-    u32 const positions_offset = positions.size();
-    u32 const uvs_offset = uvs.size();
-    u32 const indices_offset = indices.size();
-    u32 const tangents_offset = tangents.size();
-    u32 const normals_offset = normals.size();
-
-    positions.reserve(positions.size() + vert_positions.size());
-    uvs.reserve(uvs.size() + vert_texcoord0.size());
-    tangents.reserve(tangents.size() + vert_tangent.size());
-    normals.reserve(normals.size() + vert_normals.size());
-    indices.reserve(indices.size() + index_buffer.size());
-
-    positions.insert(positions.end(), vert_positions.begin(), vert_positions.end());
-    uvs.insert(uvs.end(), vert_texcoord0.begin(), vert_texcoord0.end());
-    tangents.insert(tangents.end(), vert_tangent.begin(), vert_tangent.end());
-    normals.insert(normals.end(), vert_normals.begin(), vert_normals.end());
-    indices.insert(indices.end(), index_buffer.begin(), index_buffer.end());
-
-    mesh_data.cpu_runtime = MeshDescriptorCpu{
-        .vertex_count = static_cast<u32>(vert_positions.size()),
+/// NOTE: Simplified lods are appended after the original indices
+    VertexCacheStatistics const cache_statistics_before = analyze_vertex_cache(index_buffer, vert_positions.size());
+    std::array<MeshLod, MAX_MESH_LODS> lods = {};
+    u32 const lod_count = generate_lod_chain(index_buffer, vert_positions, lods);
+    optimize_lod_triangle_order(index_buffer, vert_positions, std::span(lods.data(), lod_count));
+    optimize_vertex_fetch(index_buffer, vert_positions, vert_texcoord0, vert_tangent, vert_normals);
+    std::vector<Meshlet> mesh_meshlets = {};
+    build_lod_meshlets(index_buffer, vert_positions, std::span(lods.data(), lod_count), mesh_meshlets);
+    VertexCacheStatistics const cache_statistics_after = analyze_vertex_cache(
+        std::span(index_buffer.data(), lods.at(0).index_count), vert_positions.size());
+
+    f32vec3 aabb_min = f32vec3(std::numeric_limits<f32>::max());
+    f32vec3 aabb_max = f32vec3(std::numeric_limits<f32>::lowest());
+    for (glm::vec3 const & position : vert_positions)
+    {
+        aabb_min = glm::min(aabb_min, position);
+        aabb_max = glm::max(aabb_max, position);
+    }
+
+    return MeshData{
+        .indices = std::move(index_buffer),
+        .positions = std::move(vert_positions),
+        .uvs = std::move(vert_texcoord0),
+        .tangents = std::move(vert_tangent),
+        .normals = std::move(vert_normals),
+        .aabb_min = aabb_min,
+        .aabb_max = aabb_max,
+        .lod_count = lod_count,
+        .lods = lods,
+        .meshlets = std::move(mesh_meshlets),
+        .cache_statistics_before = cache_statistics_before,
+        .cache_statistics_after = cache_statistics_after,
+    };
+}
+
+void AssetProcessor::append_mesh_data(Scene & scene, u32 mesh_manifest_index, MeshData const & mesh_data)
+{
+    APP_LOG(fmt::format("[INFO][AssetProcessor::append_mesh_data()] Mesh {} ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                        mesh_manifest_index,
+                        mesh_data.cache_statistics_before.acmr, mesh_data.cache_statistics_after.acmr,
+                        mesh_data.cache_statistics_before.atvr, mesh_data.cache_statistics_after.atvr));
+    u32 const positions_offset = static_cast<u32>(positions.size());
+    u32 const uvs_offset = static_cast<u32>(uvs.size());
+    bool const use_16_bit_indices = mesh_data.positions.size() <= MESH_INDEX_16_MAX_VERTEX_COUNT;
+    u32 const indices_offset = static_cast<u32>(use_16_bit_indices ? indices_16.size() : indices.size());
+    u32 const tangents_offset = static_cast<u32>(tangents.size());
+    u32 const normals_offset = static_cast<u32>(normals.size());
+    u32 const meshlets_offset = static_cast<u32>(meshlets.size());
+
+    positions.insert(positions.end(), mesh_data.positions.begin(), mesh_data.positions.end());
+    uvs.insert(uvs.end(), mesh_data.uvs.begin(), mesh_data.uvs.end());
+    tangents.insert(tangents.end(), mesh_data.tangents.begin(), mesh_data.tangents.end());
+    normals.insert(normals.end(), mesh_data.normals.begin(), mesh_data.normals.end());
+    if (use_16_bit_indices)
+    {
+        for (u32 const index : mesh_data.indices)
+        {
+            indices_16.push_back(static_cast<u16>(index));
+        }
+    }
+    else
+    {
+        indices.insert(indices.end(), mesh_data.indices.begin(), mesh_data.indices.end());
+    }
+    for (Meshlet meshlet : mesh_data.meshlets)
+    {
+        meshlet.first_index += indices_offset;
+        meshlets.push_back(meshlet);
+    }
+
+    scene._mesh_manifest.at(mesh_manifest_index).cpu_runtime = MeshDescriptorCpu{
+        .vertex_count = static_cast<u32>(mesh_data.positions.size()),
         .positions_offset = positions_offset,
         .uvs_offset = uvs_offset,
         .tangents_offset = tangents_offset,
         .normals_offset = normals_offset,
-        .index_count = static_cast<u32>(index_buffer.size()),
+        .index_count = static_cast<u32>(mesh_data.indices.size()),
         .indices_offset = indices_offset,
+        .index_format = use_16_bit_indices ? u32(MESH_INDEX_FORMAT_U16) : u32(MESH_INDEX_FORMAT_U32),
+        .aabb_min = mesh_data.aabb_min,
+        .aabb_max = mesh_data.aabb_max,
+        .lod_count = mesh_data.lod_count,
+        .lods = mesh_data.lods,
     };
+    for (MeshLod & lod : scene._mesh_manifest.at(mesh_manifest_index).cpu_runtime->lods)
+    {
+        lod.first_index += indices_offset;
+        lod.first_meshlet += meshlets_offset;
+    }
+}
+
+auto AssetProcessor::load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetProcessor::AssetLoadResultCode
+{
+    auto mesh_data_result = read_mesh_data(scene, mesh_manifest_index);
+    if (auto const * err = std::get_if<AssetProcessor::AssetLoadResultCode>(&mesh_data_result))
+    {
+        return *err;
+    }
+    append_mesh_data(scene, mesh_manifest_index, std::get<MeshData>(mesh_data_result));
     return AssetProcessor::AssetLoadResultCode::SUCCESS;
 }
 
@@ -810,176 +1532,168 @@ void process_node(Scene & scene, RenderEntity const * node, f32mat4x3 curr_trans
     }
 }
 
-void AssetProcessor::record_gpu_load_processing_commands(Scene & scene)
+#pragma region VERTEX_COMPRESSION_HELPERS
+// Mirrors octahedral_32() in normals_compress.glsl
+static auto encode_octahedral(f32vec3 normal) -> u32
 {
-#pragma region RECORD_MESH_UPLOAD_COMMANDS
+    f32 const l1_norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1_norm == 0.0f)
     {
-        auto indices_command_buffer = ff::CommandBuffer(_device);
-        indices_command_buffer.begin();
-        scene._gpu_mesh_indices = _device->create_buffer({
-            .size = indices.size() * sizeof(u32),
-            .flags = {},
-            .name = "gpu_mesh_indices",
-        });
-
-        auto indices_staging = _device->create_buffer({
-            .size = indices.size() * sizeof(u32),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_indices staging",
-        });
-
-        void * staging_ptr = _device->get_buffer_host_pointer(indices_staging);
-        std::memcpy(staging_ptr, indices.data(), sizeof(u32) * indices.size());
-        indices_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = indices_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_indices,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(u32) * indices.size()),
-        });
-        indices_command_buffer.end();
-        auto recorded_command_buffer = indices_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(indices_staging);
-        indices.clear();
-        _device->wait_idle();
-        _device->cleanup_resources();
+        return glm::packSnorm2x16(f32vec2(0.0f));
     }
-
+    normal /= l1_norm;
+    f32vec2 folded = f32vec2(normal.x, normal.y);
+    if (normal.z < 0.0f)
     {
-        auto positions_command_buffer = ff::CommandBuffer(_device);
-        positions_command_buffer.begin();
-        scene._gpu_mesh_positions = _device->create_buffer({
-            .size = positions.size() * sizeof(f32vec3),
-            .flags = {},
-            .name = "gpu_mesh_positions",
-        });
-
-        auto positions_staging = _device->create_buffer({
-            .size = positions.size() * sizeof(f32vec3),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_positions staging",
-        });
-
-        void * staging_ptr = _device->get_buffer_host_pointer(positions_staging);
-        std::memcpy(staging_ptr, positions.data(), sizeof(f32vec3) * positions.size());
-        positions_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = positions_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_positions,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(f32vec3) * positions.size()),
-        });
-        positions_command_buffer.end();
-        auto recorded_command_buffer = positions_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(positions_staging);
-        positions.clear();
-        _device->wait_idle();
-        _device->cleanup_resources();
+        f32vec2 const sign = f32vec2(normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f);
+        folded = (f32vec2(1.0f) - glm::abs(f32vec2(normal.y, normal.x))) * sign;
     }
+    return glm::packSnorm2x16(folded);
+}
 
-    {
-        auto uvs_command_buffer = ff::CommandBuffer(_device);
-        uvs_command_buffer.begin();
-        scene._gpu_mesh_uvs = _device->create_buffer({
-            .size = uvs.size() * sizeof(f32vec2),
-            .flags = {},
-            .name = "gpu_mesh_uvs",
-        });
+/// NOTE: Positions are stored as three unorm16 values relative to the mesh bounding box, the shaders rebuild them
+//        from MeshDescriptor::position_min and position_extent.
+static auto encode_position(f32vec3 position, f32vec3 position_min, f32vec3 position_extent) -> u32vec2
+{
+    f32vec3 const safe_extent = glm::mix(position_extent, f32vec3(1.0f), glm::equal(position_extent, f32vec3(0.0f)));
+    f32vec3 const normalized = glm::clamp((position - position_min) / safe_extent, f32vec3(0.0f), f32vec3(1.0f));
+    return u32vec2(glm::packUnorm2x16(f32vec2(normalized.x, normalized.y)), glm::packUnorm2x16(f32vec2(normalized.z, 0.0f)));
+}
 
-        auto uvs_staging = _device->create_buffer({
-            .size = uvs.size() * sizeof(f32vec2),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_uvs staging",
-        });
+// The lowest bit of the octahedral encoding is replaced by the sign of the bitangent, set means negative
+static auto encode_tangent(f32vec4 tangent) -> u32
+{
+    return (encode_octahedral(f32vec3(tangent)) & ~1u) | (tangent.w < 0.0f ? 1u : 0u);
+}
+#pragma endregion
 
-        void * staging_ptr = _device->get_buffer_host_pointer(uvs_staging);
-        std::memcpy(staging_ptr, uvs.data(), sizeof(f32vec2) * uvs.size());
-        uvs_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = uvs_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_uvs,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(f32vec2) * uvs.size()),
-        });
-        uvs_command_buffer.end();
-        auto recorded_command_buffer = uvs_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(uvs_staging);
-        uvs.clear();
-        _device->wait_idle();
-        _device->cleanup_resources();
-    }
-    {
-        auto tangents_command_buffer = ff::CommandBuffer(_device);
-        tangents_command_buffer.begin();
-        scene._gpu_mesh_tangents = _device->create_buffer({
-            .size = tangents.size() * sizeof(f32vec4),
-            .flags = {},
-            .name = "gpu_mesh_tangents",
+auto AssetProcessor::record_gpu_load_processing_commands(Scene & scene, u32 vertex_format) -> ff::UploadStatistics
+{
+    /// NOTE: All uploads are recorded through a single batcher, the CPU only waits for the GPU once at the very end.
+    ff::UploadBatcher upload_batcher = ff::UploadBatcher(_device);
+#pragma region RECORD_MESH_UPLOAD_COMMANDS
+    /// NOTE: When loading from the scene cache the streams are copied straight from the mapped file.
+    bool const from_cache = _scene_cache != nullptr;
+    std::span<u32 const> const upload_indices = from_cache ? _scene_cache->indices : std::span<u32 const>(indices);
+    std::span<u16 const> const upload_indices_16 = from_cache ? _scene_cache->indices_16 : std::span<u16 const>(indices_16);
+    std::span<f32vec3 const> const upload_positions = from_cache ? _scene_cache->positions : std::span<f32vec3 const>(positions);
+    std::span<f32vec2 const> const upload_uvs = from_cache ? _scene_cache->uvs : std::span<f32vec2 const>(uvs);
+    std::span<f32vec4 const> const upload_tangents = from_cache ? _scene_cache->tangents : std::span<f32vec4 const>(tangents);
+    std::span<f32vec3 const> const upload_normals = from_cache ? _scene_cache->normals : std::span<f32vec3 const>(normals);
+    std::span<Meshlet const> const upload_meshlets = from_cache ? _scene_cache->meshlets : std::span<Meshlet const>(meshlets);
+
+    /// NOTE: The compressed streams are encoded per mesh on the worker pool, every mesh writes only its own ranges.
+    //        Each mesh quantizes its positions against its own bounding box.
+    bool const compress_vertices = vertex_format == VERTEX_FORMAT_COMPRESSED;
+    std::vector<u32vec2> compressed_positions = {};
+    std::vector<u32> compressed_uvs = {};
+    std::vector<u32> compressed_tangents = {};
+    std::vector<u32> compressed_normals = {};
+    if (compress_vertices)
+    {
+        compressed_positions.resize(upload_positions.size());
+        compressed_uvs.resize(upload_uvs.size());
+        compressed_tangents.resize(upload_tangents.size());
+        compressed_normals.resize(upload_normals.size());
+        std::vector<MeshDescriptorCpu const *> meshes = {};
+        for (auto const & mesh : scene._mesh_manifest)
+        {
+            if (mesh.cpu_runtime.has_value())
+            {
+                meshes.push_back(&mesh.cpu_runtime.value());
+            }
+        }
+        _thread_pool->parallel_for(static_cast<u32>(meshes.size()), [&](u32 task_index, u32 thread_index)
+        {
+            MeshDescriptorCpu const & mesh = *meshes.at(task_index);
+            f32vec3 const position_extent = mesh.aabb_max - mesh.aabb_min;
+            for (u32 vertex_index = 0; vertex_index < mesh.vertex_count; vertex_index++)
+            {
+                compressed_positions.at(mesh.positions_offset + vertex_index) =
+                    encode_position(upload_positions[mesh.positions_offset + vertex_index], mesh.aabb_min, position_extent);
+                compressed_uvs.at(mesh.uvs_offset + vertex_index) = glm::packHalf2x16(upload_uvs[mesh.uvs_offset + vertex_index]);
+                compressed_tangents.at(mesh.tangents_offset + vertex_index) = encode_tangent(upload_tangents[mesh.tangents_offset + vertex_index]);
+                compressed_normals.at(mesh.normals_offset + vertex_index) = encode_octahedral(upload_normals[mesh.normals_offset + vertex_index]);
+            }
         });
+    }
+    std::span<std::byte const> const position_bytes = compress_vertices ? std::as_bytes(std::span(compressed_positions)) : std::as_bytes(upload_positions);
+    std::span<std::byte const> const uv_bytes = compress_vertices ? std::as_bytes(std::span(compressed_uvs)) : std::as_bytes(upload_uvs);
+    std::span<std::byte const> const tangent_bytes = compress_vertices ? std::as_bytes(std::span(compressed_tangents)) : std::as_bytes(upload_tangents);
+    std::span<std::byte const> const normal_bytes = compress_vertices ? std::as_bytes(std::span(compressed_normals)) : std::as_bytes(upload_normals);
+    APP_LOG(fmt::format("[INFO][AssetProcessor::record_gpu_load_processing_commands()] Vertex streams {:.2f} MiB in {} format",
+                        static_cast<f32>(position_bytes.size() + uv_bytes.size() + tangent_bytes.size() + normal_bytes.size()) / (1024.0f * 1024.0f),
+                        compress_vertices ? "compressed" : "full"));
+
+    /// NOTE: Either pool can be empty, buffers are never created empty. The 16 bit pool is rounded up to whole 32 bit
+    //        words as the cluster culling reads it as pairs of indices.
+    scene._gpu_mesh_indices = _device->create_buffer({
+        .size = std::max(upload_indices.size_bytes(), sizeof(u32)),
+        .flags = {},
+        .name = "gpu_mesh_indices",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_indices, 0, std::as_bytes(upload_indices));
+    indices.clear();
 
-        auto tangents_staging = _device->create_buffer({
-            .size = tangents.size() * sizeof(f32vec4),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_tangents staging",
-        });
+    scene._gpu_mesh_indices_16 = _device->create_buffer({
+        .size = std::max((upload_indices_16.size_bytes() + sizeof(u32) - 1) / sizeof(u32) * sizeof(u32), sizeof(u32)),
+        .flags = {},
+        .name = "gpu_mesh_indices_16",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_indices_16, 0, std::as_bytes(upload_indices_16));
+    indices_16.clear();
+    APP_LOG(fmt::format("[INFO][AssetProcessor::record_gpu_load_processing_commands()] Indices {:.2f} MiB, {} of them 16 bit, {:.2f} MiB with 32 bit indices only",
+                        static_cast<f32>(upload_indices.size_bytes() + upload_indices_16.size_bytes()) / (1024.0f * 1024.0f),
+                        upload_indices_16.size(),
+                        static_cast<f32>((upload_indices.size() + upload_indices_16.size()) * sizeof(u32)) / (1024.0f * 1024.0f)));
+
+    scene._gpu_mesh_positions = _device->create_buffer({
+        .size = position_bytes.size(),
+        .flags = {},
+        .name = "gpu_mesh_positions",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_positions, 0, position_bytes);
+    positions.clear();
 
-        void * staging_ptr = _device->get_buffer_host_pointer(tangents_staging);
-        std::memcpy(staging_ptr, tangents.data(), sizeof(f32vec4) * tangents.size());
-        tangents_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = tangents_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_tangents,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(f32vec4) * tangents.size()),
-        });
-        tangents_command_buffer.end();
-        auto recorded_command_buffer = tangents_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(tangents_staging);
-        tangents.clear();
-        _device->wait_idle();
-        _device->cleanup_resources();
-    }
-    {
-        auto normals_command_buffer = ff::CommandBuffer(_device);
-        normals_command_buffer.begin();
-        scene._gpu_mesh_normals = _device->create_buffer({
-            .size = normals.size() * sizeof(f32vec3),
-            .flags = {},
-            .name = "gpu_mesh_normals",
-        });
+    scene._gpu_mesh_uvs = _device->create_buffer({
+        .size = uv_bytes.size(),
+        .flags = {},
+        .name = "gpu_mesh_uvs",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_uvs, 0, uv_bytes);
+    uvs.clear();
 
-        auto normals_staging = _device->create_buffer({
-            .size = normals.size() * sizeof(f32vec3),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_normals staging",
-        });
+    scene._gpu_mesh_tangents = _device->create_buffer({
+        .size = tangent_bytes.size(),
+        .flags = {},
+        .name = "gpu_mesh_tangents",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_tangents, 0, tangent_bytes);
+    tangents.clear();
 
-        void * staging_ptr = _device->get_buffer_host_pointer(normals_staging);
-        std::memcpy(staging_ptr, normals.data(), sizeof(f32vec3) * normals.size());
-        normals_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = normals_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_normals,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(f32vec3) * normals.size()),
-        });
-        normals_command_buffer.end();
-        auto recorded_command_buffer = normals_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(normals_staging);
-        normals.clear();
-        _device->wait_idle();
-        _device->cleanup_resources();
-    }
+    scene._gpu_mesh_normals = _device->create_buffer({
+        .size = normal_bytes.size(),
+        .flags = {},
+        .name = "gpu_mesh_normals",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_normals, 0, normal_bytes);
+    normals.clear();
+
+    scene._gpu_meshlets = _device->create_buffer({
+        .size = upload_meshlets.size_bytes(),
+        .flags = {},
+        .name = "gpu_meshlets",
+    });
+    upload_batcher.upload_buffer(scene._gpu_meshlets, 0, std::as_bytes(upload_meshlets));
+    meshlets.clear();
 
     auto const * root_node = scene._render_entities.slot(scene._scene_file_manifest.at(0).root_render_entity);
     process_node(scene, root_node, f32mat4x3(glm::identity<glm::mat4x4>()));
     std::vector<f32mat4x3> transforms = {};
     std::vector<MeshDescriptor> mesh_descriptors = {};
+    std::vector<MeshDrawInfo> mesh_draw_infos = {};
+    // Each mesh owns a range of the visible instance buffer large enough to hold all of its instances
+    u32 instance_offset = 0;
     for (auto const & meshgroup : scene._mesh_group_manifest)
     {
         for (i32 mesh_idx = 0; mesh_idx < meshgroup.mesh_count; mesh_idx++)
@@ -994,195 +1708,81 @@ void AssetProcessor::record_gpu_load_processing_commands(Scene & scene)
                 .normals_offset = mesh.cpu_runtime->normals_offset,
                 .indices_offset = mesh.cpu_runtime->indices_offset,
                 .material_index = mesh.material_manifest_index.value_or(0),
+                .position_min = mesh.cpu_runtime->aabb_min,
+                .position_extent = mesh.cpu_runtime->aabb_max - mesh.cpu_runtime->aabb_min,
             });
+            mesh_draw_infos.push_back({
+                .aabb_min = mesh.cpu_runtime->aabb_min,
+                .aabb_max = mesh.cpu_runtime->aabb_max,
+                .lod_count = mesh.cpu_runtime->lod_count,
+                .instance_count = static_cast<u32>(meshgroup.instance_transforms.size()),
+                .instance_offset = instance_offset,
+                .transforms_offset = mesh.cpu_runtime->transforms_offset,
+                .mesh_index = static_cast<u32>(mesh_descriptors.size() - 1),
+                .draw_list_index = scene.is_alpha_discard_mesh(mesh) ? u32(DRAW_LIST_ALPHA_DISCARD) : u32(DRAW_LIST_OPAQUE),
+                .index_format = mesh.cpu_runtime->index_format,
+            });
+            std::copy(mesh.cpu_runtime->lods.begin(), mesh.cpu_runtime->lods.end(), std::begin(mesh_draw_infos.back().lods));
+            instance_offset += static_cast<u32>(meshgroup.instance_transforms.size());
         }
         transforms.insert(transforms.end(), meshgroup.instance_transforms.begin(), meshgroup.instance_transforms.end());
     }
-    {
-        auto transforms_command_buffer = ff::CommandBuffer(_device);
-        transforms_command_buffer.begin();
-        scene._gpu_mesh_transforms = _device->create_buffer({
-            .size = transforms.size() * sizeof(f32mat4x3),
-            .flags = {},
-            .name = "gpu_mesh_transforms",
-        });
-
-        auto transforms_staging = _device->create_buffer({
-            .size = transforms.size() * sizeof(f32mat4x3),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_transforms staging",
-        });
-
-        void * staging_ptr = _device->get_buffer_host_pointer(transforms_staging);
-        std::memcpy(staging_ptr, transforms.data(), sizeof(f32mat4x3) * transforms.size());
-        transforms_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = transforms_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_transforms,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(f32mat4x3) * transforms.size()),
-        });
-        transforms_command_buffer.end();
-        auto recorded_command_buffer = transforms_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(transforms_staging);
-        _device->wait_idle();
-        _device->cleanup_resources();
-    }
-    {
-        auto mesh_descriptors_command_buffer = ff::CommandBuffer(_device);
-        mesh_descriptors_command_buffer.begin();
-        scene._gpu_mesh_descriptors = _device->create_buffer({
-            .size = mesh_descriptors.size() * sizeof(MeshDescriptor),
-            .flags = {},
-            .name = "gpu_mesh_descriptors",
-        });
-
-        auto mesh_descriptors_staging = _device->create_buffer({
-            .size = mesh_descriptors.size() * sizeof(MeshDescriptor),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_mesh_descriptors staging",
-        });
+    scene._gpu_mesh_transforms = _device->create_buffer({
+        .size = transforms.size() * sizeof(f32mat4x3),
+        .flags = {},
+        .name = "gpu_mesh_transforms",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_transforms, 0, std::as_bytes(std::span(transforms)));
 
-        void * staging_ptr = _device->get_buffer_host_pointer(mesh_descriptors_staging);
-        std::memcpy(staging_ptr, mesh_descriptors.data(), sizeof(MeshDescriptor) * mesh_descriptors.size());
-        mesh_descriptors_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = mesh_descriptors_staging,
-            .src_offset = 0,
-            .dst_buffer = scene._gpu_mesh_descriptors,
-            .dst_offset = 0,
-            .size = static_cast<u32>(sizeof(MeshDescriptor) * mesh_descriptors.size()),
-        });
-        mesh_descriptors_command_buffer.end();
-        auto recorded_command_buffer = mesh_descriptors_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(mesh_descriptors_staging);
-        _device->wait_idle();
-        _device->cleanup_resources();
-    }
+    scene._gpu_mesh_descriptors = _device->create_buffer({
+        .size = mesh_descriptors.size() * sizeof(MeshDescriptor),
+        .flags = {},
+        .name = "gpu_mesh_descriptors",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_descriptors, 0, std::as_bytes(std::span(mesh_descriptors)));
 
+    scene._gpu_mesh_draw_infos = _device->create_buffer({
+        .size = mesh_draw_infos.size() * sizeof(MeshDrawInfo),
+        .flags = {},
+        .name = "gpu_mesh_draw_infos",
+    });
+    upload_batcher.upload_buffer(scene._gpu_mesh_draw_infos, 0, std::as_bytes(std::span(mesh_draw_infos)));
 #pragma endregion
 
 #pragma region RECORD_TEXTURE_UPLOAD_COMMANDS
-    auto upload_textures_command_buffer = ff::CommandBuffer(_device);
-    upload_textures_command_buffer.begin();
-    // Transition texture from UNDEFINED -> VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    for (TextureUpload const & texture_upload : _upload_texture_queue)
-    {
+    usize streamed_texture_byte_size = 0;
+    u32 streamed_texture_count = 0;
+    for (TextureUpload & texture_upload : _upload_texture_queue)
+    {
+        // Only the mips from base_mip on are uploaded, the streamer keeps the texels of the rest
+        usize const resident_offset = texture_upload.stored_mip_offsets.at(texture_upload.base_mip);
+        std::span<std::byte const> const texels = texture_upload.get_texels().subspan(resident_offset);
+        ff::StagingAllocation const staging = upload_batcher.allocate_staging(texels.size());
+        std::memcpy(staging.host_address, texels.data(), texels.size());
         texture_upload.scene->_material_texture_manifest.at(texture_upload.texture_manifest_index).runtime = texture_upload.dst_image;
-        upload_textures_command_buffer.cmd_image_memory_transition_barrier({
-            .src_stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-            .src_access = VK_ACCESS_2_NONE_KHR,
-            .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-            .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED,
-            .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            .level_count = _device->info_image(texture_upload.dst_image).mip_level_count,
-            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-            .image_id = texture_upload.dst_image,
-        });
-    }
-    // Upload texture data into the texture (mip 0)
-    for (TextureUpload const & texture_upload : _upload_texture_queue)
-    {
-        auto const image_extent = _device->info_image(texture_upload.dst_image).extent;
-        upload_textures_command_buffer.cmd_copy_buffer_to_image({
-            .buffer_id = texture_upload.staging_buffer,
-            .image_id = texture_upload.dst_image,
-            .image_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-            .image_offset = {0, 0, 0},
-            .image_extent = _device->info_image(texture_upload.dst_image).extent,
-        });
-    }
-    // Generate mips
-    for (TextureUpload const & texture_upload : _upload_texture_queue)
-    {
-        auto const mip_count = _device->info_image(texture_upload.dst_image).mip_level_count;
-        if (mip_count == 1)
-        {
-            continue;
-        }
-        auto const extent = _device->info_image(texture_upload.dst_image).extent;
-        auto mip_src_end_offset = VkOffset3D{static_cast<i32>(extent.width), static_cast<i32>(extent.height), 1};
-        for (i32 mip_level = 1; mip_level < mip_count; mip_level++)
+        record_texture_upload(upload_batcher.get_command_buffer(), texture_upload, staging);
+        if (texture_upload.base_mip > 0)
         {
-            // mip_level - 1 TRANSFER_DST_OPTIMAL -> TRANSFER_SRC_OPTIMAL
-            upload_textures_command_buffer.cmd_image_memory_transition_barrier({
-                .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                .dst_access = VK_ACCESS_2_TRANSFER_READ_BIT,
-                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                .base_mip_level = static_cast<u32>(mip_level - 1),
-                .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-                .image_id = texture_upload.dst_image,
+            streamed_texture_byte_size += texture_upload.get_texels().size();
+            streamed_texture_count += 1;
+            _texture_streamer->add_texture({
+                .texture_manifest_index = texture_upload.texture_manifest_index,
+                .format = texture_upload.format,
+                .width = texture_upload.width,
+                .height = texture_upload.height,
+                .mip_level_count = texture_upload.mip_level_count,
+                .resident_mip = texture_upload.base_mip,
+                .texels = std::move(texture_upload.texels),
+                .mapped_texels = texture_upload.mapped_texels,
+                .mip_offsets = std::move(texture_upload.stored_mip_offsets),
             });
-
-            upload_textures_command_buffer.cmd_blit_image({
-                .src_image = texture_upload.dst_image,
-                .dst_image = texture_upload.dst_image,
-                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                .src_aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-                .dst_aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-                .src_mip_level = static_cast<u32>(mip_level - 1),
-                .dst_mip_level = static_cast<u32>(mip_level),
-                .src_start_offset = {0, 0, 0},
-                .src_end_offset = mip_src_end_offset,
-                .dst_start_offset = {0, 0, 0},
-                .dst_end_offset = {
-                    mip_src_end_offset.x > 1 ? mip_src_end_offset.x / 2 : 1,
-                    mip_src_end_offset.y > 1 ? mip_src_end_offset.y / 2 : 1,
-                    1,
-                },
-            });
-            mip_src_end_offset.x = mip_src_end_offset.x > 1 ? mip_src_end_offset.x / 2 : 1;
-            mip_src_end_offset.y = mip_src_end_offset.y > 1 ? mip_src_end_offset.y / 2 : 1;
         }
-        /// NOTE: We need to transfer the last mip separately because it is in TRANSFER DST layout as opposed
-        /// to all other mips which are in TRANSFER_SRC_OPTIMAL
-        // Last mip TRANSFER_DST_OPTIMAL -> SHADER_READ_ONLY_OPTIMAL
-        upload_textures_command_buffer.cmd_image_memory_transition_barrier({
-            .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-            .dst_stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            .dst_access = VK_ACCESS_2_NONE,
-            .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            .base_mip_level = mip_count - 1,
-            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-            .image_id = texture_upload.dst_image,
-        });
-    }
-
-    for (TextureUpload const & texture_upload : _upload_texture_queue)
-    {
-        auto const mipmap_count = _device->info_image(texture_upload.dst_image).mip_level_count;
-        auto src_access = mipmap_count == 1 ? VK_ACCESS_2_TRANSFER_WRITE_BIT : VK_ACCESS_2_TRANSFER_READ_BIT;
-        auto src_layout = mipmap_count == 1 ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        upload_textures_command_buffer.cmd_image_memory_transition_barrier({
-            .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .src_access = src_access,
-            .dst_stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            .dst_access = VK_ACCESS_2_NONE,
-            .src_layout = src_layout,
-            .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            .level_count = std::max(mipmap_count - 1, 1u),
-            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
-            .image_id = texture_upload.dst_image,
-        });
     }
-    upload_textures_command_buffer.end();
-    auto recorded_command_buffer = upload_textures_command_buffer.get_recorded_command_buffer();
-    _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-    for (TextureUpload const & texture_upload : _upload_texture_queue)
+    if (streamed_texture_count > 0)
     {
-        _device->destroy_buffer(texture_upload.staging_buffer);
+        APP_LOG(fmt::format("[INFO][AssetProcessor::record_gpu_load_processing_commands()] Uploaded the mip tails of {} streamed textures, {:.2f} MiB left to stream",
+                            streamed_texture_count, static_cast<f32>(streamed_texture_byte_size) / (1024.0f * 1024.0f)));
     }
-    _device->wait_idle();
-    _device->cleanup_resources();
 #pragma endregion
 #pragma region RECORD_MATERIAL_UPLOAD_COMMANDS
     /// NOTE: We need to propagate each loaded texture image ID into the material manifest This will be done in two steps:
@@ -1231,70 +1831,19 @@ void AssetProcessor::record_gpu_load_processing_commands(Scene & scene)
             dirty_material_entry_indices.push_back(i);
         }
     }
-    auto upload_manifest_command_buffer = ff::CommandBuffer(_device);
-    upload_manifest_command_buffer.begin();
-    auto const materials_update_staging_buffer = _device->create_buffer({
-        .size = sizeof(MaterialDescriptor) * dirty_material_entry_indices.size(),
-        .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-        .name = "gpu materials update",
-    });
-    MaterialDescriptor * const staging_origin_ptr = reinterpret_cast<MaterialDescriptor *>(_device->get_buffer_host_pointer(materials_update_staging_buffer));
-    for (u32 dirty_materials_index = 0; dirty_materials_index < dirty_material_entry_indices.size(); dirty_materials_index++)
-    {
-        auto const & texture_manifest = scene._material_texture_manifest;
-        auto const & material_manifest = scene._material_manifest;
-        MaterialManifestEntry const & material = material_manifest.at(dirty_material_entry_indices.at(dirty_materials_index));
-
-        if (material.diffuse_tex_index.has_value())
-        {
-            staging_origin_ptr[dirty_materials_index].albedo_index = texture_manifest.at(material.diffuse_tex_index.value()).runtime.value().index;
-        }
-        else
-        {
-            staging_origin_ptr[dirty_materials_index].albedo_index = -1;
-        }
-        if (material.normal_tex_index.has_value())
-        {
-            staging_origin_ptr[dirty_materials_index].normal_index = texture_manifest.at(material.normal_tex_index.value()).runtime.value().index;
-        }
-        else
-        {
-            staging_origin_ptr[dirty_materials_index].normal_index = -1;
-        }
-
-        upload_manifest_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = materials_update_staging_buffer,
-            .src_offset = static_cast<u32>(sizeof(MaterialDescriptor) * dirty_materials_index),
-            .dst_buffer = scene._gpu_material_descriptors,
-            .dst_offset = static_cast<u32>(sizeof(MaterialDescriptor) * dirty_material_entry_indices.at(dirty_materials_index)),
-            .size = sizeof(MaterialDescriptor),
-        });
-    }
-    {
-        upload_manifest_command_buffer.end();
-        auto recorded_command_buffer = upload_manifest_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(materials_update_staging_buffer);
-        _device->wait_idle();
-        _device->cleanup_resources();
-    }
+    ff::StagingAllocation const materials_update_staging = upload_batcher.allocate_staging(sizeof(MaterialDescriptor) * dirty_material_entry_indices.size());
+    scene.record_material_descriptor_updates(upload_batcher.get_command_buffer(), materials_update_staging, dirty_material_entry_indices);
     _upload_texture_queue.clear();
 #pragma endregion
 #pragma region RECORD_SCENE_DESCRIPTOR_UPLOAD_COMMANDS
     {
-        auto scene_descriptor_command_buffer = ff::CommandBuffer(_device);
-        scene_descriptor_command_buffer.begin();
         scene._gpu_scene_descriptor = _device->create_buffer({
             .size = sizeof(SceneDescriptor),
             .flags = {},
             .name = "gpu_scene_descriptor",
         });
-        auto scene_descriptor_staging = _device->create_buffer({
-            .size = sizeof(SceneDescriptor),
-            .flags = VmaAllocationCreateFlagBits::VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-            .name = "gpu_scene_descriptor staging",
-        });
-        SceneDescriptor * staging_ptr = reinterpret_cast<SceneDescriptor *>(_device->get_buffer_host_pointer(scene_descriptor_staging));
+        ff::StagingAllocation const scene_descriptor_staging = upload_batcher.allocate_staging(sizeof(SceneDescriptor));
+        SceneDescriptor * staging_ptr = reinterpret_cast<SceneDescriptor *>(scene_descriptor_staging.host_address);
         *staging_ptr = {
             .mesh_descriptors_start = _device->get_buffer_device_address(scene._gpu_mesh_descriptors),
             .material_descriptors_start = _device->get_buffer_device_address(scene._gpu_material_descriptors),
@@ -1304,46 +1853,308 @@ void AssetProcessor::record_gpu_load_processing_commands(Scene & scene)
             .normals_start = _device->get_buffer_device_address(scene._gpu_mesh_normals),
             .tangents_start = _device->get_buffer_device_address(scene._gpu_mesh_tangents),
             .indices_start = _device->get_buffer_device_address(scene._gpu_mesh_indices),
+            .indices_16_start = _device->get_buffer_device_address(scene._gpu_mesh_indices_16),
+            .meshlets_start = _device->get_buffer_device_address(scene._gpu_meshlets),
+            .vertex_format = vertex_format,
         };
-        scene_descriptor_command_buffer.cmd_copy_buffer_to_buffer({
-            .src_buffer = scene_descriptor_staging,
-            .src_offset = 0,
+        upload_batcher.get_command_buffer().cmd_copy_buffer_to_buffer({
+            .src_buffer = scene_descriptor_staging.buffer_id,
+            .src_offset = static_cast<u32>(scene_descriptor_staging.offset),
             .dst_buffer = scene._gpu_scene_descriptor,
             .dst_offset = 0,
             .size = static_cast<u32>(sizeof(SceneDescriptor)),
         });
-        scene_descriptor_command_buffer.end();
-        auto recorded_command_buffer = scene_descriptor_command_buffer.get_recorded_command_buffer();
-        _device->submit({.command_buffers = {&recorded_command_buffer, 1}});
-        _device->destroy_buffer(scene_descriptor_staging);
-        _device->wait_idle();
-        _device->cleanup_resources();
     }
 #pragma endregion
+    ff::UploadStatistics const upload_statistics = upload_batcher.finish();
+    _scene_cache = nullptr;
+    return upload_statistics;
 }
 
 auto AssetProcessor::load_all(Scene & scene) -> AssetProcessor::AssetLoadResultCode
 {
-    std::optional<AssetProcessor::AssetLoadResultCode> err = {};
-    for (u32 i = 0; i < scene._material_texture_manifest.size(); ++i)
+    ff::PreciseStopwatch stopwatch = {};
+#pragma region LOAD_TEXTURES
+    /// NOTE: Textures are decoded in batches on the worker threads. The GPU resources are then created serially
+    //        in manifest order which keeps the upload queue (and thus the bindless image indices) deterministic.
+    //        Batching bounds the amount of decoded CPU side texel memory alive at any given time.
+    u32 const texture_count = static_cast<u32>(scene._material_texture_manifest.size());
+    /// NOTE: The files of all textures are read at once so that the decode of the first batch overlaps with the
+    //        reads of the later ones. Images stored in glTF buffers are already mapped and need no read.
+    std::vector<ff::FileReadRequest> texture_read_requests = {};
+    std::vector<std::optional<u32>> texture_read_indices(texture_count);
+    for (u32 texture_manifest_index = 0; texture_manifest_index < texture_count; texture_manifest_index++)
+    {
+        TextureManifestEntry const & texture_entry = scene._material_texture_manifest.at(texture_manifest_index);
+        SceneFileManifestEntry const & scene_entry = scene._scene_file_manifest.at(texture_entry.scene_file_manifest_index);
+        fastgltf::Image const & image = scene_entry.gltf_asset.images.at(texture_entry.in_scene_file_index);
+        auto const * uri = std::get_if<fastgltf::sources::URI>(&image.data);
+        // Unsupported URIs are left to decode_texture() which reports the error
+        if (uri == nullptr || !uri->uri.isLocalPath() || uri->fileByteOffset != 0)
+        {
+            continue;
+        }
+        texture_read_indices.at(texture_manifest_index) = static_cast<u32>(texture_read_requests.size());
+        texture_read_requests.push_back(ff::FileReadRequest{
+            .path = std::filesystem::path(scene_entry.path).remove_filename() / uri->uri.fspath(),
+        });
+    }
+    _file_reader->submit(texture_read_requests);
+    APP_LOG(fmt::format("[INFO][AssetProcessor::load_all()] Reading {} texture files through {}", texture_read_requests.size(), _file_reader->get_backend_name()));
+    u32 const texture_batch_size = _thread_pool->get_thread_count() * 2;
+    std::vector<DecodedImageRet> decoded_textures(texture_batch_size);
+    // Stored mips before and after the block compression, summed up for the statistics
+    std::vector<usize> uncompressed_byte_sizes(texture_batch_size);
+    usize total_uncompressed_byte_size = 0;
+    usize total_stored_byte_size = 0;
+    for (u32 batch_start = 0; batch_start < texture_count; batch_start += texture_batch_size)
+    {
+        u32 const batch_texture_count = std::min(texture_batch_size, texture_count - batch_start);
+        _thread_pool->parallel_for(batch_texture_count, [&](u32 task_index, u32 thread_index)
+        {
+            u32 const texture_manifest_index = batch_start + task_index;
+            APP_LOG(fmt::format("[INFO][AssetProcessor::load_all] Loading texture {}", scene._material_texture_manifest.at(texture_manifest_index).name));
+            std::optional<u32> const read_index = texture_read_indices.at(texture_manifest_index);
+            if (read_index.has_value())
+            {
+                ff::FileReadResult file_contents = _file_reader->wait(read_index.value());
+                decoded_textures.at(task_index) = decode_texture(scene, texture_manifest_index, &file_contents);
+            }
+            else
+            {
+                decoded_textures.at(task_index) = decode_texture(scene, texture_manifest_index);
+            }
+            if (auto * decoded_data = std::get_if<DecodedImageData>(&decoded_textures.at(task_index)); decoded_data)
+            {
+                generate_cpu_mip_chain(*decoded_data);
+                uncompressed_byte_sizes.at(task_index) = decoded_data->texels.size();
+                compress_cpu_mip_chain(*decoded_data);
+            }
+        });
+        for (u32 task_index = 0; task_index < batch_texture_count; task_index++)
+        {
+            DecodedImageRet & decoded_texture = decoded_textures.at(task_index);
+            if (std::holds_alternative<AssetProcessor::AssetLoadResultCode>(decoded_texture))
+            {
+                APP_LOG("[ERROR][Scene::Scene()] Error loading texture");
+                throw std::runtime_error("[ERROR][Scene::Scene()] Error loading texture");
+            }
+            if (auto * decoded_data = std::get_if<DecodedImageData>(&decoded_texture))
+            {
+                total_uncompressed_byte_size += uncompressed_byte_sizes.at(task_index);
+                total_stored_byte_size += decoded_data->texels.size();
+                ImageUploadInfo upload_info = image_upload_info_from_decoded(*decoded_data);
+                upload_info.base_mip = get_streamed_base_mip(decoded_data->width, decoded_data->height, decoded_data->mip_level_count);
+                ParsedImageData parsed_data = create_image_upload_resources(upload_info, _device);
+                _upload_texture_queue.push_back(TextureUpload{
+                    .scene = &scene,
+                    .dst_image = parsed_data.dst_image,
+                    .texture_manifest_index = batch_start + task_index,
+                    .format = decoded_data->format,
+                    .width = decoded_data->width,
+                    .height = decoded_data->height,
+                    .mip_level_count = decoded_data->mip_level_count,
+                    .stored_mip_count = decoded_data->stored_mip_count,
+                    .base_mip = upload_info.base_mip,
+                    .stored_mip_offsets = std::move(parsed_data.stored_mip_offsets),
+                    .texels = std::move(decoded_data->texels)});
+            }
+            decoded_texture = std::monostate{};
+        }
+    }
+    f32 const texture_load_time = stopwatch.elapsed_time<f32, std::chrono::milliseconds>();
+    APP_LOG(fmt::format("[INFO][AssetProcessor::load_all()] Textures take {:.2f} MiB block compressed, {:.2f} MiB uncompressed",
+                        static_cast<f32>(total_stored_byte_size) / (1024.0f * 1024.0f), static_cast<f32>(total_uncompressed_byte_size) / (1024.0f * 1024.0f)));
+#pragma endregion
+
+#pragma region LOAD_MESHES
+    /// NOTE: Mesh accessors are read in parallel into per mesh storage. Appending into the shared attribute vectors
+    //        is done afterwards in the same order the serial path would use, so all offsets stay deterministic.
+    std::vector<u32> mesh_manifest_indices = {};
+    for (u32 mesh_group_index = 0; mesh_group_index < scene._mesh_group_manifest.size(); ++mesh_group_index)
     {
-        APP_LOG(fmt::format("[INFO][AssetProcessor::load_all] Loading texture {}", scene._material_texture_manifest.at(i).name));
-        auto result = load_texture(scene, i);
-        if (result != AssetProcessor::AssetLoadResultCode::SUCCESS)
+        MeshGroupManifestEntry const & mesh_group_data = scene._mesh_group_manifest.at(mesh_group_index);
+        for (u32 mesh_in_meshgroup_index = 0; mesh_in_meshgroup_index < mesh_group_data.mesh_count; mesh_in_meshgroup_index++)
         {
-            APP_LOG("[ERROR][Scene::Scene()] Error loading texture");
-            throw std::runtime_error("[ERROR][Scene::Scene()] Error loading texture");
+            mesh_manifest_indices.push_back(mesh_group_data.mesh_manifest_indices.at(mesh_in_meshgroup_index));
         }
     }
-    for (u32 i = 0; i < scene._mesh_group_manifest.size(); ++i)
+    std::vector<std::variant<MeshData, AssetProcessor::AssetLoadResultCode>> loaded_meshes(mesh_manifest_indices.size());
+    _thread_pool->parallel_for(static_cast<u32>(mesh_manifest_indices.size()), [&](u32 task_index, u32 thread_index)
+    {
+        loaded_meshes.at(task_index) = read_mesh_data(scene, mesh_manifest_indices.at(task_index));
+    });
+
+    usize total_vertex_count = 0;
+    usize total_index_count = 0;
+    usize total_index_16_count = 0;
+    for (auto const & loaded_mesh : loaded_meshes)
     {
-        APP_LOG(fmt::format("[INFO][AssetProcessor::load_all] Loading meshgroup {} of {}", i, scene._mesh_group_manifest.size()));
-        auto result = load_mesh_group(scene, i);
-        if (result != AssetProcessor::AssetLoadResultCode::SUCCESS)
+        if (std::holds_alternative<AssetProcessor::AssetLoadResultCode>(loaded_mesh))
         {
             APP_LOG("[ERROR][Scene::Scene()] Error loading mesh group");
             throw std::runtime_error("[ERROR][Scene::Scene()] Error loading mesh group");
         }
+        total_vertex_count += std::get<MeshData>(loaded_mesh).positions.size();
+        MeshData const & mesh_data = std::get<MeshData>(loaded_mesh);
+        bool const use_16_bit_indices = mesh_data.positions.size() <= MESH_INDEX_16_MAX_VERTEX_COUNT;
+        (use_16_bit_indices ? total_index_16_count : total_index_count) += mesh_data.indices.size();
+    }
+    positions.reserve(positions.size() + total_vertex_count);
+    uvs.reserve(uvs.size() + total_vertex_count);
+    tangents.reserve(tangents.size() + total_vertex_count);
+    normals.reserve(normals.size() + total_vertex_count);
+    indices.reserve(indices.size() + total_index_count);
+    indices_16.reserve(indices_16.size() + total_index_16_count);
+    f32 acmr_before_sum = 0.0f;
+    f32 acmr_after_sum = 0.0f;
+    f32 atvr_before_sum = 0.0f;
+    f32 atvr_after_sum = 0.0f;
+    for (u32 task_index = 0; task_index < loaded_meshes.size(); task_index++)
+    {
+        MeshData const & mesh_data = std::get<MeshData>(loaded_meshes.at(task_index));
+        acmr_before_sum += mesh_data.cache_statistics_before.acmr;
+        acmr_after_sum += mesh_data.cache_statistics_after.acmr;
+        atvr_before_sum += mesh_data.cache_statistics_before.atvr;
+        atvr_after_sum += mesh_data.cache_statistics_after.atvr;
+        append_mesh_data(scene, mesh_manifest_indices.at(task_index), mesh_data);
+        loaded_meshes.at(task_index) = MeshData{};
+    }
+    f32 const mesh_load_time = stopwatch.elapsed_time<f32, std::chrono::milliseconds>() - texture_load_time;
+#pragma endregion
+    APP_LOG(fmt::format("[INFO][AssetProcessor::load_all()] Loaded {} textures in {}ms and {} meshes in {}ms using {} threads",
+                        _upload_texture_queue.size(), texture_load_time, mesh_manifest_indices.size(), mesh_load_time, _thread_pool->get_thread_count()));
+    f32 const mesh_count = static_cast<f32>(std::max(mesh_manifest_indices.size(), usize(1)));
+    APP_LOG(fmt::format("[INFO][AssetProcessor::load_all()] Average ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                        acmr_before_sum / mesh_count, acmr_after_sum / mesh_count, atvr_before_sum / mesh_count, atvr_after_sum / mesh_count));
+    return AssetProcessor::AssetLoadResultCode::SUCCESS;
+}
+
+auto AssetProcessor::cook_scene_cache(Scene const & scene, std::filesystem::path const & cache_path) -> std::optional<SceneCache::ErrorCode>
+{
+    ff::PreciseStopwatch stopwatch = {};
+    std::vector<CookedTexture> cooked_textures = {};
+    for (TextureUpload const & texture_upload : _upload_texture_queue)
+    {
+        // The image only holds the resident mips of streamed textures, the cache always stores the full chain
+        cooked_textures.push_back(CookedTexture{
+            .info = {
+                .texture_manifest_index = texture_upload.texture_manifest_index,
+                .format = texture_upload.format,
+                .width = texture_upload.width,
+                .height = texture_upload.height,
+                .mip_level_count = texture_upload.mip_level_count,
+                .stored_mip_count = texture_upload.stored_mip_count,
+            },
+            .texels = texture_upload.get_texels(),
+        });
+    }
+    auto const result = SceneCache::write({
+        .scene = scene,
+        .cache_path = cache_path,
+        .indices = indices,
+        .indices_16 = indices_16,
+        .positions = positions,
+        .uvs = uvs,
+        .tangents = tangents,
+        .normals = normals,
+        .meshlets = meshlets,
+        .textures = cooked_textures,
+    });
+    if (!result.has_value())
+    {
+        APP_LOG(fmt::format("[INFO][AssetProcessor::cook_scene_cache()] Cooked scene cache {} in {}ms",
+                            cache_path.string(), stopwatch.elapsed_time<f32, std::chrono::milliseconds>()));
     }
+    return result;
+}
+
+auto AssetProcessor::load_all_from_cache(Scene & scene, SceneCache const & cache) -> AssetProcessor::AssetLoadResultCode
+{
+    ff::PreciseStopwatch stopwatch = {};
+    /// NOTE: Texels are already decoded and mipped, they are copied from the mapped file into the staging ring on upload.
+    for (CookedTextureInfo const & texture : cache.textures)
+    {
+        std::span<std::byte const> const texels = cache.get_texels(texture);
+        u32 const base_mip = get_streamed_base_mip(texture.width, texture.height, texture.mip_level_count);
+        ParsedImageData parsed_data = create_image_upload_resources({
+            .texels = texels,
+            .format = texture.format,
+            .width = texture.width,
+            .height = texture.height,
+            .mip_level_count = texture.mip_level_count,
+            .stored_mip_count = texture.stored_mip_count,
+            .base_mip = base_mip,
+            .name = scene._material_texture_manifest.at(texture.texture_manifest_index).name,
+        }, _device);
+        _upload_texture_queue.push_back(TextureUpload{
+            .scene = &scene,
+            .dst_image = parsed_data.dst_image,
+            .texture_manifest_index = texture.texture_manifest_index,
+            .format = texture.format,
+            .width = texture.width,
+            .height = texture.height,
+            .mip_level_count = texture.mip_level_count,
+            .stored_mip_count = texture.stored_mip_count,
+            .base_mip = base_mip,
+            .stored_mip_offsets = std::move(parsed_data.stored_mip_offsets),
+            .mapped_texels = texels});
+    }
+    _scene_cache = &cache;
+    APP_LOG(fmt::format("[INFO][AssetProcessor::load_all_from_cache()] Loaded {} textures and {} vertices from cache in {}ms",
+                        cache.textures.size(), cache.positions.size(), stopwatch.elapsed_time<f32, std::chrono::milliseconds>()));
     return AssetProcessor::AssetLoadResultCode::SUCCESS;
-}
\ No newline at end of file
+}
+
+void AssetProcessor::record_texture_upload(ff::CommandBuffer & command_buffer, TextureUpload const & texture_upload, ff::StagingAllocation const & staging)
+{
+    auto const & image_info = _device->info_image(texture_upload.dst_image);
+    u32 const mip_count = image_info.mip_level_count;
+    auto const extent = image_info.extent;
+    // Transition texture from UNDEFINED -> VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    command_buffer.cmd_image_memory_transition_barrier({
+        .src_stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+        .src_access = VK_ACCESS_2_NONE_KHR,
+        .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED,
+        .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .level_count = mip_count,
+        .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+        .image_id = texture_upload.dst_image,
+    });
+    /// NOTE: The image starts at base_mip, so does the staging memory. Every mip of the image is stored.
+    DBG_ASSERT_TRUE_M(texture_upload.stored_mip_count == texture_upload.mip_level_count,
+                      "[ERROR][AssetProcessor::record_texture_upload()] Textures must be uploaded with their whole mip chain");
+    usize const resident_offset = texture_upload.stored_mip_offsets.at(texture_upload.base_mip);
+    // Upload texture data into the texture (all mips stored in the staging buffer)
+    for (u32 mip_level = 0; mip_level < mip_count; mip_level++)
+    {
+        command_buffer.cmd_copy_buffer_to_image({
+            .buffer_id = staging.buffer_id,
+            .buffer_offset = staging.offset + texture_upload.stored_mip_offsets.at(texture_upload.base_mip + mip_level) - resident_offset,
+            .image_id = texture_upload.dst_image,
+            .image_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .base_mip_level = mip_level,
+            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+            .image_offset = {0, 0, 0},
+            .image_extent = {
+                std::max(extent.width >> mip_level, 1u),
+                std::max(extent.height >> mip_level, 1u),
+                1,
+            },
+        });
+    }
+    // All mips TRANSFER_DST_OPTIMAL -> SHADER_READ_ONLY_OPTIMAL
+    command_buffer.cmd_image_memory_transition_barrier({
+        .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dst_stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        .dst_access = VK_ACCESS_2_NONE,
+        .src_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .level_count = mip_count,
+        .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+        .image_id = texture_upload.dst_image,
+    });
+}
@@ -5,7 +5,11 @@
 #include "../fairy_forest.hpp"
 #include "../context.hpp"
 #include "../backend/backend.hpp"
+#include "../thread_pool.hpp"
+#include "../async_file_reader.hpp"
 #include "scene.hpp"
+#include "scene_cache.hpp"
+#include "texture_streamer.hpp"
 
 using namespace ff::types;
 
@@ -81,23 +85,44 @@ struct AssetProcessor
             default:                                                                    return "UNKNOWN";
         }
     }
-    AssetProcessor(std::shared_ptr<ff::Device> device);
+    // Simulated post transform cache efficiency of an index buffer
+    struct VertexCacheStatistics
+    {
+        f32 acmr = {};
+        f32 atvr = {};
+    };
+    // worker_thread_count == 0 uses all hardware threads, 1 loads everything serially on the calling thread
+    AssetProcessor(std::shared_ptr<ff::Device> device, u32 worker_thread_count = 0);
     AssetProcessor(AssetProcessor &&) = default;
     ~AssetProcessor();
 
     auto load_texture(Scene & scene, u32 texture_manifest_index) -> AssetLoadResultCode;
     auto load_mesh_group(Scene & scene, u32 mesh_group_manifest_index) -> AssetLoadResultCode;
 
+    /// NOTE: Decodes textures and reads mesh accessors on the worker pool, results are merged in manifest order.
+    //        The full mip chain of every texture is generated and block compressed on the CPU, so that the upload
+    //        only copies it and cook_scene_cache() can store it.
     auto load_all(Scene & scene) -> AssetLoadResultCode;
+    // Must be called after load_all() and before record_gpu_load_processing_commands().
+    auto cook_scene_cache(Scene const & scene, std::filesystem::path const & cache_path) -> std::optional<SceneCache::ErrorCode>;
+    // The cache must stay alive until record_gpu_load_processing_commands() returns.
+    auto load_all_from_cache(Scene & scene, SceneCache const & cache) -> AssetLoadResultCode;
 
-    void record_gpu_load_processing_commands(Scene & scene);
+    // Uploads everything that was loaded through the batcher and waits for the GPU once at the end.
+    // vertex_format is VERTEX_FORMAT_FULL or VERTEX_FORMAT_COMPRESSED, the streams are encoded while uploading.
+    auto record_gpu_load_processing_commands(Scene & scene, u32 vertex_format = VERTEX_FORMAT_COMPRESSED) -> ff::UploadStatistics;
+    // Textures with their full mip chain on the CPU then only upload the mip tail and are handed to the streamer by
+    // record_gpu_load_processing_commands(). Must be set before loading, nullptr uploads every mip.
+    void set_texture_streamer(TextureStreamer * texture_streamer);
 
   private:
     std::vector<u32> indices = {};
+    std::vector<u16> indices_16 = {};
     std::vector<f32vec3> positions = {};
     std::vector<f32vec2> uvs = {};
     std::vector<f32vec4> tangents = {};
     std::vector<f32vec3> normals = {};
+    std::vector<Meshlet> meshlets = {};
     static inline std::string const VERT_ATTRIB_POSITION_NAME = "POSITION";
     static inline std::string const VERT_ATTRIB_NORMAL_NAME = "NORMAL";
     static inline std::string const VERT_ATTRIB_TEXCOORD0_NAME = "TEXCOORD_0";
@@ -106,9 +131,26 @@ struct AssetProcessor
     struct TextureUpload
     {
         Scene * scene = {};
-        ff::BufferId staging_buffer = {};
         ff::ImageId dst_image = {};
         u32 texture_manifest_index = {};
+        // Full texture, dst_image holds only mips [base_mip, mip_level_count) of it.
+        VkFormat format = {};
+        u32 width = {};
+        u32 height = {};
+        u32 mip_level_count = {};
+        // Mips [0, stored_mip_count) are copied from the staging ring, always the whole chain.
+        u32 stored_mip_count = 1;
+        // Streamed textures only upload their mip tail, base_mip is 0 for everything else.
+        u32 base_mip = 0;
+        std::vector<usize> stored_mip_offsets = {};
+        // Either owns the decoded texels or points into the mapped scene cache.
+        std::vector<std::byte> texels = {};
+        std::span<std::byte const> mapped_texels = {};
+
+        auto get_texels() const -> std::span<std::byte const>
+        {
+            return texels.empty() ? mapped_texels : std::span<std::byte const>(texels);
+        }
     };
 
     struct MeshUpload
@@ -118,10 +160,41 @@ struct AssetProcessor
         ff::BufferId staging_buffer = {};
         u32 mesh_manifest_index = {};
     };
+    struct MeshData
+    {
+        std::vector<u32> indices = {};
+        std::vector<f32vec3> positions = {};
+        std::vector<f32vec2> uvs = {};
+        std::vector<f32vec4> tangents = {};
+        std::vector<f32vec3> normals = {};
+        f32vec3 aabb_min = {};
+        f32vec3 aabb_max = {};
+        u32 lod_count = {};
+        // First indices are relative to the start of indices, first meshlets to the start of meshlets
+        std::array<MeshLod, MAX_MESH_LODS> lods = {};
+        std::vector<Meshlet> meshlets = {};
+        // Lod 0 as read from the file and after the triangle and vertex reordering
+        VertexCacheStatistics cache_statistics_before = {};
+        VertexCacheStatistics cache_statistics_after = {};
+    };
+
     std::shared_ptr<ff::Device> _device = {};
+    std::unique_ptr<ff::ThreadPool> _thread_pool = {};
+    // Reads the texture files ahead of the decode on the worker threads
+    std::unique_ptr<ff::AsyncFileReader> _file_reader = {};
     // TODO: Replace with lockless queue.
     std::vector<MeshUpload> _upload_mesh_queue = {};
     std::vector<TextureUpload> _upload_texture_queue = {};
+    // When set the geometry streams are uploaded directly from the mapped cache instead of the vectors above.
+    SceneCache const * _scene_cache = {};
+    TextureStreamer * _texture_streamer = {};
 
     auto load_mesh(Scene & scene, u32 mesh_manifest_index) -> AssetProcessor::AssetLoadResultCode;
+    // First mip uploaded with the scene, 0 unless the texture is streamed.
+    auto get_streamed_base_mip(u32 width, u32 height, u32 mip_level_count) const -> u32;
+    // Only reads from the scene, safe to call from multiple threads at once.
+    static auto read_mesh_data(Scene const & scene, u32 mesh_manifest_index) -> std::variant<MeshData, AssetLoadResultCode>;
+    void append_mesh_data(Scene & scene, u32 mesh_manifest_index, MeshData const & mesh_data);
+    // Records the layout transitions and the copies of the stored mips.
+    void record_texture_upload(ff::CommandBuffer & command_buffer, TextureUpload const & texture_upload, ff::StagingAllocation const & staging);
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "scene.hpp"
 
 #include <fastgltf/parser.hpp>
+#include <algorithm>
 #include <fstream>
 
 #include <fmt/format.h>
@@ -19,9 +20,12 @@ Scene::~Scene()
     _device->destroy_buffer(_gpu_mesh_tangents);
     _device->destroy_buffer(_gpu_mesh_normals);
     _device->destroy_buffer(_gpu_mesh_indices);
+    _device->destroy_buffer(_gpu_mesh_indices_16);
+    _device->destroy_buffer(_gpu_meshlets);
     _device->destroy_buffer(_gpu_mesh_descriptors);
     _device->destroy_buffer(_gpu_scene_descriptor);
     _device->destroy_buffer(_gpu_material_descriptors);
+    _device->destroy_buffer(_gpu_mesh_draw_infos);
     for (auto & texture : _material_texture_manifest)
     {
         if (texture.runtime.has_value())
@@ -78,6 +82,24 @@ auto Scene::load_manifest_from_gltf(std::filesystem::path const & root_path, std
             return LoadManifestErrorCode::INVALID_GLTF_FILE_TYPE;
     }
 
+    std::vector<ff::MappedFile> buffer_files = {};
+    buffer_files.reserve(asset.buffers.size());
+    for (fastgltf::Buffer const & buffer : asset.buffers)
+    {
+        auto const * uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+        if (uri == nullptr || !uri->uri.isLocalPath())
+        {
+            buffer_files.emplace_back();
+            continue;
+        }
+        std::filesystem::path const buffer_path = file_path.parent_path() / uri->uri.fspath();
+        buffer_files.emplace_back(buffer_path);
+        if (!buffer_files.back().is_open())
+        {
+            APP_LOG(fmt::format("[WARN][Scene::load_manifest_from_gltf()] Could not map glTF buffer \"{}\"", buffer_path.string()));
+        }
+    }
+
     u32 const scene_file_manifest_index = static_cast<u32>(_scene_file_manifest.size());
     u32 const texture_manifest_offset = static_cast<u32>(_material_texture_manifest.size());
     u32 const material_manifest_offset = static_cast<u32>(_material_manifest.size());
@@ -306,6 +328,7 @@ auto Scene::load_manifest_from_gltf(std::filesystem::path const & root_path, std
     _scene_file_manifest.push_back(SceneFileManifestEntry{
         .path = file_path,
         .gltf_asset = std::move(asset),
+        .buffer_files = std::move(buffer_files),
         .texture_manifest_offset = texture_manifest_offset,
         .material_manifest_offset = material_manifest_offset,
         .mesh_group_manifest_offset = mesh_group_manifest_offset,
@@ -320,47 +343,82 @@ auto Scene::record_scene_draw_commands() -> SceneDrawCommands
     SceneDrawCommands commands = {};
     commands.scene_descriptor = _device->get_buffer_device_address(_gpu_scene_descriptor);
     commands.index_buffer_id = _gpu_mesh_indices;
-    u32 global_mesh_idx = 0;
+    commands.index_buffer_16_id = _gpu_mesh_indices_16;
+    commands.mesh_draw_infos = _gpu_mesh_draw_infos;
+    commands.material_count = static_cast<u32>(_material_manifest.size());
     for (auto const & mesh_group : _mesh_group_manifest)
     {
+        commands.mesh_count += mesh_group.mesh_count;
+        commands.instance_count += mesh_group.mesh_count * static_cast<u32>(mesh_group.instance_transforms.size());
         for (u32 mesh_index = 0; mesh_index < mesh_group.mesh_count; mesh_index++)
         {
-            auto const & mesh = _mesh_manifest.at(mesh_group.mesh_manifest_indices.at(mesh_index));
-            // TODO(msakmary) Another hack not enough time to fix this properly
-            bool is_discard_material = false;
-            if (mesh.material_manifest_index.has_value())
+            MeshManifestEntry const & mesh = _mesh_manifest.at(mesh_group.mesh_manifest_indices.at(mesh_index));
+            if (!mesh.cpu_runtime.has_value())
             {
-                for (auto const & discard_mat_name : alpha_discard_materials)
-                {
-                    if (_material_manifest.at(mesh.material_manifest_index.value()).name == discard_mat_name)
-                    {
-                        is_discard_material = true;
-                        break;
-                    }
-                }
+                continue;
             }
-            if (is_discard_material)
-            {
-                commands.alpha_discard_commands.push_back({
-                    .mesh_idx = global_mesh_idx,
-                    .vertex_count = mesh.cpu_runtime->vertex_count,
-                    .index_count = mesh.cpu_runtime->index_count,
-                    .index_offset = mesh.cpu_runtime->indices_offset,
-                    .instance_count = static_cast<u32>(mesh_group.instance_transforms.size()),
-                });
-            }
-            else
+            u32 batch_count = 0;
+            u32 index_count = 0;
+            for (u32 lod = 0; lod < mesh.cpu_runtime->lod_count; lod++)
             {
-                commands.draw_commands.push_back({
-                    .mesh_idx = global_mesh_idx,
-                    .vertex_count = mesh.cpu_runtime->vertex_count,
-                    .index_count = mesh.cpu_runtime->index_count,
-                    .index_offset = mesh.cpu_runtime->indices_offset,
-                    .instance_count = static_cast<u32>(mesh_group.instance_transforms.size()),
-                });
+                MeshLod const & mesh_lod = mesh.cpu_runtime->lods.at(lod);
+                batch_count = std::max(batch_count, (mesh_lod.meshlet_count + CLUSTER_CULL_BATCH_SIZE - 1) / CLUSTER_CULL_BATCH_SIZE);
+                index_count = std::max(index_count, mesh_lod.index_count);
             }
-            global_mesh_idx += 1;
+            commands.cluster_batch_count += batch_count * static_cast<u32>(mesh_group.instance_transforms.size());
+            commands.cluster_index_count += static_cast<usize>(index_count) * mesh_group.instance_transforms.size();
         }
     }
     return commands;
+}
+
+void Scene::record_material_descriptor_updates(ff::CommandBuffer & command_buffer, ff::StagingAllocation const & staging, std::span<u32 const> material_manifest_indices)
+{
+    MaterialDescriptor * const staging_origin_ptr = reinterpret_cast<MaterialDescriptor *>(staging.host_address);
+    for (u32 dirty_materials_index = 0; dirty_materials_index < material_manifest_indices.size(); dirty_materials_index++)
+    {
+        MaterialManifestEntry const & material = _material_manifest.at(material_manifest_indices[dirty_materials_index]);
+
+        if (material.diffuse_tex_index.has_value())
+        {
+            staging_origin_ptr[dirty_materials_index].albedo_index = _material_texture_manifest.at(material.diffuse_tex_index.value()).runtime.value().index;
+        }
+        else
+        {
+            staging_origin_ptr[dirty_materials_index].albedo_index = -1;
+        }
+        if (material.normal_tex_index.has_value())
+        {
+            staging_origin_ptr[dirty_materials_index].normal_index = _material_texture_manifest.at(material.normal_tex_index.value()).runtime.value().index;
+        }
+        else
+        {
+            staging_origin_ptr[dirty_materials_index].normal_index = -1;
+        }
+
+        command_buffer.cmd_copy_buffer_to_buffer({
+            .src_buffer = staging.buffer_id,
+            .src_offset = static_cast<u32>(staging.offset + sizeof(MaterialDescriptor) * dirty_materials_index),
+            .dst_buffer = _gpu_material_descriptors,
+            .dst_offset = static_cast<u32>(sizeof(MaterialDescriptor) * material_manifest_indices[dirty_materials_index]),
+            .size = sizeof(MaterialDescriptor),
+        });
+    }
+}
+
+auto Scene::is_alpha_discard_mesh(MeshManifestEntry const & mesh) const -> bool
+{
+    // TODO(msakmary) Another hack not enough time to fix this properly
+    if (!mesh.material_manifest_index.has_value())
+    {
+        return false;
+    }
+    for (auto const & discard_mat_name : alpha_discard_materials)
+    {
+        if (_material_manifest.at(mesh.material_manifest_index.value()).name == discard_mat_name)
+        {
+            return true;
+        }
+    }
+    return false;
 }
\ No newline at end of file
@@ -6,9 +6,11 @@
 #include <fastgltf/parser.hpp>
 #include <fastgltf/types.hpp>
 #include "../fairy_forest.hpp"
+#include "../mapped_file.hpp"
 
 #include "../shared/shared.inl"
 #include "../backend/slotmap.hpp"
+#include "../backend/command_buffer.hpp"
 using namespace ff::types;
 #define MAX_MESHES_PER_MESHGROUP 105
 
@@ -48,9 +50,17 @@ struct MeshDescriptorCpu
     u32 uvs_offset = {};
     u32 tangents_offset = {};
     u32 normals_offset = {};
+    // Covers the indices of all lods
     u32 index_count = {};
     u32 indices_offset = {};
+    // MESH_INDEX_FORMAT_U16 meshes store their indices in the 16 bit pool, indices_offset points into it
+    u32 index_format = MESH_INDEX_FORMAT_U32;
     u32 transforms_offset = {};
+    // Mesh space bounding box of the vertex positions
+    f32vec3 aabb_min = {};
+    f32vec3 aabb_max = {};
+    u32 lod_count = {};
+    std::array<MeshLod, MAX_MESH_LODS> lods = {};
 };
 
 struct MeshManifestEntry
@@ -101,6 +111,9 @@ struct SceneFileManifestEntry
 {
     std::filesystem::path path = {};
     fastgltf::Asset gltf_asset{};
+    /// NOTE: One read only mapping per entry of gltf_asset.buffers, made once when the manifest is loaded and
+    //        shared by all accessors and images of the file. Stays closed for buffers that are not in a local file.
+    std::vector<ff::MappedFile> buffer_files = {};
     u32 texture_manifest_offset = {};
     u32 material_manifest_offset = {};
     u32 mesh_group_manifest_offset = {};
@@ -110,14 +123,6 @@ struct SceneFileManifestEntry
 
 using RenderEntitySlotMap = ff::SlotMap<RenderEntity>;
 
-struct DrawCommand
-{
-    u32 mesh_idx = {};
-    u32 vertex_count = {};
-    u32 index_count = {};
-    u32 index_offset = {};
-    u32 instance_count = {};
-};
 struct SceneDrawCommands
 {
     u32 no_albedo = {};
@@ -125,13 +130,25 @@ struct SceneDrawCommands
     u32 no_ao = {};
     u32 force_ao = {};
     u32 no_normal_maps = {};
+    // Sun shadows from the virtual shadow map instead of the esm cascades
+    u32 virtual_shadows = {};
     bool reset_fsr = {};
     bool no_fog = {};
     bool no_fsr = {};
     VkDeviceAddress scene_descriptor = {};
     ff::BufferId index_buffer_id = {};
-    std::vector<DrawCommand> draw_commands = {};
-    std::vector<DrawCommand> alpha_discard_commands = {};
+    // Indices of the meshes with MESH_INDEX_FORMAT_U16
+    ff::BufferId index_buffer_16_id = {};
+    // One MeshDrawInfo per mesh, the renderer expands them into indirect draws on the GPU
+    ff::BufferId mesh_draw_infos = {};
+    u32 mesh_count = {};
+    // Sum of the instance counts of all meshes
+    u32 instance_count = {};
+    // Sum over all instances of the cluster culling batches and indices of their largest lod, see ClusterCullWork
+    u32 cluster_batch_count = {};
+    usize cluster_index_count = {};
+    // Size of the texture feedback the renderer has to provide, see TextureFeedback
+    u32 material_count = {};
 };
 
 struct Scene
@@ -143,11 +160,14 @@ struct Scene
     ff::BufferId _gpu_mesh_normals = {};
     ff::BufferId _gpu_mesh_uvs = {};
     ff::BufferId _gpu_mesh_indices = {};
+    ff::BufferId _gpu_mesh_indices_16 = {};
+    ff::BufferId _gpu_meshlets = {};
 
     ff::BufferId _gpu_mesh_descriptors = {};
     ff::BufferId _gpu_material_descriptors = {};
 
     ff::BufferId _gpu_scene_descriptor = {};
+    ff::BufferId _gpu_mesh_draw_infos = {};
 
     RenderEntitySlotMap _render_entities = {};
     std::vector<RenderEntityId> _dirty_render_entities = {};
@@ -197,6 +217,10 @@ struct Scene
     auto load_manifest_from_gltf(std::filesystem::path const & root_path, std::filesystem::path const & glb_name) -> std::variant<RenderEntityId, LoadManifestErrorCode>;
 
     auto record_scene_draw_commands() -> SceneDrawCommands;
+    /// NOTE: Copies the current texture image indices of the materials into _gpu_material_descriptors. The staging
+    //        allocation must hold one MaterialDescriptor per material, the caller makes the copies visible to the shaders.
+    void record_material_descriptor_updates(ff::CommandBuffer & command_buffer, ff::StagingAllocation const & staging, std::span<u32 const> material_manifest_indices);
+    auto is_alpha_discard_mesh(MeshManifestEntry const & mesh) const -> bool;
 
     std::shared_ptr<ff::Device> _device = {};
 };
\ No newline at end of file
@@ -0,0 +1,629 @@
+#include "scene_cache.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <type_traits>
+
+#pragma region BINARY_IO_HELPERS
+/// NOTE: All bulk arrays are aligned so that spans into the mapped file can be used directly.
+static constexpr u64 CACHE_ALIGNMENT = 16;
+static constexpr u32 INVALID_INDEX = ~0u;
+
+struct CacheWriter
+{
+    std::ofstream ofs;
+    u64 position = {};
+
+    void write_bytes(void const * data, usize size)
+    {
+        ofs.write(reinterpret_cast<char const *>(data), static_cast<std::streamsize>(size));
+        position += size;
+    }
+    template <typename T>
+    void write(T const & value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written directly");
+        write_bytes(&value, sizeof(T));
+    }
+    void write_optional_index(std::optional<u32> const & value)
+    {
+        write<u32>(value.value_or(INVALID_INDEX));
+    }
+    void write_string(std::string const & value)
+    {
+        write<u32>(static_cast<u32>(value.size()));
+        write_bytes(value.data(), value.size());
+    }
+    void align(u64 alignment)
+    {
+        std::array<std::byte, CACHE_ALIGNMENT> const zeros = {};
+        u64 const padding = (alignment - (position % alignment)) % alignment;
+        write_bytes(zeros.data(), padding);
+    }
+    template <typename T>
+    void write_array(std::span<T const> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written directly");
+        write<u64>(values.size());
+        align(CACHE_ALIGNMENT);
+        write_bytes(values.data(), values.size_bytes());
+    }
+};
+
+struct CacheReader
+{
+    std::span<std::byte const> data = {};
+    u64 position = {};
+    bool failed = {};
+
+    auto read_bytes(u64 size) -> std::byte const *
+    {
+        if (failed || position + size > data.size())
+        {
+            failed = true;
+            return nullptr;
+        }
+        std::byte const * ret = data.data() + position;
+        position += size;
+        return ret;
+    }
+    template <typename T>
+    auto read() -> T
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read directly");
+        T value = {};
+        if (std::byte const * src = read_bytes(sizeof(T)))
+        {
+            std::memcpy(&value, src, sizeof(T));
+        }
+        return value;
+    }
+    auto read_optional_index() -> std::optional<u32>
+    {
+        u32 const value = read<u32>();
+        return value == INVALID_INDEX ? std::nullopt : std::optional<u32>{value};
+    }
+    auto read_string() -> std::string
+    {
+        u32 const size = read<u32>();
+        std::byte const * src = read_bytes(size);
+        return src != nullptr ? std::string(reinterpret_cast<char const *>(src), size) : std::string{};
+    }
+    void align(u64 alignment)
+    {
+        read_bytes((alignment - (position % alignment)) % alignment);
+    }
+    template <typename T>
+    auto read_array() -> std::span<T const>
+    {
+        u64 const count = read<u64>();
+        align(CACHE_ALIGNMENT);
+        std::byte const * src = read_bytes(count * sizeof(T));
+        if (src == nullptr)
+        {
+            return {};
+        }
+        return {reinterpret_cast<T const *>(src), static_cast<usize>(count)};
+    }
+};
+#pragma endregion
+
+#pragma region SOURCE_DEPENDENCIES
+struct SourceDependency
+{
+    std::string path = {};
+    u64 size = {};
+    i64 modification_time = {};
+};
+
+static auto query_source_dependency(std::filesystem::path const & path) -> std::optional<SourceDependency>
+{
+    std::error_code error = {};
+    u64 const size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    auto const modification_time = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    return SourceDependency{
+        .path = path.string(),
+        .size = size,
+        .modification_time = static_cast<i64>(modification_time.time_since_epoch().count()),
+    };
+}
+
+/// NOTE: FNV-1a, the gltf file itself is small so hashing its content is cheap. All other sources (buffers, images)
+//        are only compared by size and modification time.
+static auto hash_file_content(std::filesystem::path const & path) -> std::optional<u64>
+{
+    ff::MappedFile const file = ff::MappedFile(path);
+    if (!file.is_open())
+    {
+        return std::nullopt;
+    }
+    u64 hash = 14695981039346656037ull;
+    for (std::byte const byte : file.get_data())
+    {
+        hash ^= static_cast<u64>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+#pragma endregion
+
+auto SceneCache::write(SceneCacheWriteInfo const & info) -> std::optional<ErrorCode>
+{
+    Scene const & scene = info.scene;
+    if (scene._scene_file_manifest.size() != 1)
+    {
+        return ErrorCode::UNSUPPORTED_SCENE;
+    }
+    SceneFileManifestEntry const & scene_file = scene._scene_file_manifest.at(0);
+    std::filesystem::path const scene_dir_path = std::filesystem::path(scene_file.path).remove_filename();
+
+    std::vector<SourceDependency> dependencies = {};
+    auto add_dependency = [&](std::filesystem::path const & path) -> bool
+    {
+        auto dependency = query_source_dependency(path);
+        if (dependency.has_value())
+        {
+            dependencies.push_back(std::move(dependency.value()));
+        }
+        return dependency.has_value();
+    };
+    if (!add_dependency(scene_file.path))
+    {
+        return ErrorCode::UNSUPPORTED_SCENE;
+    }
+    for (fastgltf::Buffer const & buffer : scene_file.gltf_asset.buffers)
+    {
+        if (auto const * uri = std::get_if<fastgltf::sources::URI>(&buffer.data))
+        {
+            add_dependency(scene_dir_path / uri->uri.fspath());
+        }
+    }
+    for (fastgltf::Image const & image : scene_file.gltf_asset.images)
+    {
+        if (auto const * uri = std::get_if<fastgltf::sources::URI>(&image.data))
+        {
+            add_dependency(scene_dir_path / uri->uri.fspath());
+        }
+    }
+    std::optional<u64> const source_hash = hash_file_content(scene_file.path);
+    if (!source_hash.has_value())
+    {
+        return ErrorCode::UNSUPPORTED_SCENE;
+    }
+
+    /// NOTE: Write into a temporary file first so that a crash mid write never leaves a valid looking cache behind.
+    std::filesystem::path temp_path = info.cache_path;
+    temp_path += ".tmp";
+    {
+        CacheWriter writer = {.ofs = std::ofstream(temp_path, std::ios::binary | std::ios::trunc)};
+        if (!writer.ofs)
+        {
+            return ErrorCode::COULD_NOT_WRITE_CACHE_FILE;
+        }
+#pragma region HEADER
+        writer.write<u32>(MAGIC);
+        writer.write<u32>(VERSION);
+        writer.write_string(scene_file.path.string());
+        writer.write<u64>(source_hash.value());
+        writer.write<u32>(static_cast<u32>(dependencies.size()));
+        for (SourceDependency const & dependency : dependencies)
+        {
+            writer.write_string(dependency.path);
+            writer.write<u64>(dependency.size);
+            writer.write<i64>(dependency.modification_time);
+        }
+#pragma endregion
+
+#pragma region MANIFESTS
+        writer.write<u32>(static_cast<u32>(scene._material_texture_manifest.size()));
+        for (TextureManifestEntry const & texture : scene._material_texture_manifest)
+        {
+            writer.write<u32>(texture.in_scene_file_index);
+            writer.write<u32>(static_cast<u32>(texture.material_manifest_indices.size()));
+            for (auto const & material_index : texture.material_manifest_indices)
+            {
+                writer.write(material_index);
+            }
+            writer.write_string(texture.name);
+        }
+
+        writer.write<u32>(static_cast<u32>(scene._material_manifest.size()));
+        for (MaterialManifestEntry const & material : scene._material_manifest)
+        {
+            writer.write_optional_index(material.diffuse_tex_index);
+            writer.write_optional_index(material.normal_tex_index);
+            writer.write<u32>(material.in_scene_file_index);
+            writer.write_string(material.name);
+        }
+
+        writer.write<u32>(static_cast<u32>(scene._mesh_manifest.size()));
+        for (MeshManifestEntry const & mesh : scene._mesh_manifest)
+        {
+            writer.write_optional_index(mesh.material_manifest_index);
+            writer.write<u32>(mesh.scene_file_mesh_index);
+            writer.write<u32>(mesh.scene_file_primitive_index);
+            writer.write<u32>(mesh.cpu_runtime.has_value() ? 1u : 0u);
+            writer.write(mesh.cpu_runtime.value_or(MeshDescriptorCpu{}));
+        }
+
+        writer.write<u32>(static_cast<u32>(scene._mesh_group_manifest.size()));
+        for (MeshGroupManifestEntry const & mesh_group : scene._mesh_group_manifest)
+        {
+            writer.write<u32>(mesh_group.mesh_count);
+            writer.write_bytes(mesh_group.mesh_manifest_indices.data(), sizeof(u32) * mesh_group.mesh_count);
+            writer.write<u32>(mesh_group.in_scene_file_index);
+            writer.write_string(mesh_group.name);
+        }
+
+        /// NOTE: Render entities were created in order without any deletions, so the slot index fully identifies them.
+        u32 const render_entity_count = static_cast<u32>(scene._render_entities.capacity());
+        writer.write<u32>(render_entity_count);
+        for (u32 render_entity_index = 0; render_entity_index < render_entity_count; render_entity_index++)
+        {
+            RenderEntity const * render_entity = scene._render_entities.slot(scene._render_entities.id_from_index(render_entity_index));
+            auto optional_entity_index = [](std::optional<RenderEntityId> const & id) -> std::optional<u32>
+            {
+                return id.has_value() ? std::optional<u32>{id->index} : std::nullopt;
+            };
+            writer.write(render_entity->transform);
+            writer.write_optional_index(optional_entity_index(render_entity->first_child));
+            writer.write_optional_index(optional_entity_index(render_entity->next_sibling));
+            writer.write_optional_index(optional_entity_index(render_entity->parent));
+            writer.write_optional_index(render_entity->mesh_group_manifest_index);
+            writer.write<u32>(static_cast<u32>(render_entity->type));
+            writer.write_string(render_entity->name);
+        }
+        writer.write<u32>(scene_file.root_render_entity.index);
+#pragma endregion
+
+#pragma region BULK_DATA
+        writer.write_array(info.indices);
+        writer.write_array(info.indices_16);
+        writer.write_array(info.positions);
+        writer.write_array(info.uvs);
+        writer.write_array(info.tangents);
+        writer.write_array(info.normals);
+        writer.write_array(info.meshlets);
+
+        std::vector<CookedTextureInfo> texture_infos = {};
+        u64 texel_blob_size = 0;
+        for (CookedTexture const & texture : info.textures)
+        {
+            texel_blob_size = (texel_blob_size + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+            CookedTextureInfo texture_info = texture.info;
+            texture_info.texels_offset = texel_blob_size;
+            texture_info.texels_size = texture.texels.size();
+            texture_infos.push_back(texture_info);
+            texel_blob_size += texture.texels.size();
+        }
+        writer.write_array(std::span<CookedTextureInfo const>(texture_infos));
+        writer.write<u64>(texel_blob_size);
+        writer.align(CACHE_ALIGNMENT);
+        u64 const texel_blob_start = writer.position;
+        for (u32 texture_index = 0; texture_index < info.textures.size(); texture_index++)
+        {
+            writer.align(CACHE_ALIGNMENT);
+            DBG_ASSERT_TRUE_M(writer.position - texel_blob_start == texture_infos.at(texture_index).texels_offset,
+                              "[ERROR][SceneCache::write()] Texel blob offset mismatch");
+            writer.write_bytes(info.textures[texture_index].texels.data(), info.textures[texture_index].texels.size());
+        }
+#pragma endregion
+        if (!writer.ofs)
+        {
+            return ErrorCode::COULD_NOT_WRITE_CACHE_FILE;
+        }
+    }
+    std::error_code error = {};
+    std::filesystem::rename(temp_path, info.cache_path, error);
+    if (error)
+    {
+        return ErrorCode::COULD_NOT_WRITE_CACHE_FILE;
+    }
+    return std::nullopt;
+}
+
+auto SceneCache::open(std::filesystem::path const & cache_path, std::filesystem::path const & source_path) -> std::variant<SceneCache, ErrorCode>
+{
+    SceneCache cache = {};
+    cache.file = ff::MappedFile(cache_path);
+    if (!cache.file.is_open())
+    {
+        return ErrorCode::CACHE_FILE_NOT_FOUND;
+    }
+    CacheReader reader = {.data = cache.file.get_data()};
+
+#pragma region HEADER
+    if (reader.read<u32>() != MAGIC)
+    {
+        return ErrorCode::INVALID_CACHE_FILE;
+    }
+    if (reader.read<u32>() != VERSION)
+    {
+        return ErrorCode::CACHE_VERSION_MISMATCH;
+    }
+    cache.source_path = reader.read_string();
+    if (cache.source_path != source_path)
+    {
+        return ErrorCode::SOURCE_PATH_MISMATCH;
+    }
+    u64 const source_hash = reader.read<u64>();
+    u32 const dependency_count = reader.read<u32>();
+    for (u32 dependency_index = 0; dependency_index < dependency_count && !reader.failed; dependency_index++)
+    {
+        SourceDependency stored_dependency = {};
+        stored_dependency.path = reader.read_string();
+        stored_dependency.size = reader.read<u64>();
+        stored_dependency.modification_time = reader.read<i64>();
+        auto const current_dependency = query_source_dependency(stored_dependency.path);
+        if (!current_dependency.has_value() ||
+            current_dependency->size != stored_dependency.size ||
+            current_dependency->modification_time != stored_dependency.modification_time)
+        {
+            return ErrorCode::SOURCE_FILE_CHANGED;
+        }
+    }
+    if (hash_file_content(source_path) != source_hash)
+    {
+        return ErrorCode::SOURCE_FILE_CHANGED;
+    }
+#pragma endregion
+
+#pragma region MANIFESTS
+    u32 const texture_count = reader.read<u32>();
+    for (u32 texture_index = 0; texture_index < texture_count && !reader.failed; texture_index++)
+    {
+        TextureManifestEntry texture = {};
+        texture.in_scene_file_index = reader.read<u32>();
+        u32 const usage_count = reader.read<u32>();
+        for (u32 usage_index = 0; usage_index < usage_count && !reader.failed; usage_index++)
+        {
+            texture.material_manifest_indices.push_back(reader.read<TextureManifestEntry::MaterialManifestIndex>());
+        }
+        texture.name = reader.read_string();
+        cache.texture_manifest.push_back(std::move(texture));
+    }
+
+    u32 const material_count = reader.read<u32>();
+    for (u32 material_index = 0; material_index < material_count && !reader.failed; material_index++)
+    {
+        MaterialManifestEntry material = {};
+        material.diffuse_tex_index = reader.read_optional_index();
+        material.normal_tex_index = reader.read_optional_index();
+        material.in_scene_file_index = reader.read<u32>();
+        material.name = reader.read_string();
+        cache.material_manifest.push_back(std::move(material));
+    }
+
+    u32 const mesh_count = reader.read<u32>();
+    for (u32 mesh_index = 0; mesh_index < mesh_count && !reader.failed; mesh_index++)
+    {
+        MeshManifestEntry mesh = {};
+        mesh.material_manifest_index = reader.read_optional_index();
+        mesh.scene_file_mesh_index = reader.read<u32>();
+        mesh.scene_file_primitive_index = reader.read<u32>();
+        bool const has_cpu_runtime = reader.read<u32>() != 0;
+        MeshDescriptorCpu const cpu_runtime = reader.read<MeshDescriptorCpu>();
+        if (has_cpu_runtime)
+        {
+            mesh.cpu_runtime = cpu_runtime;
+        }
+        cache.mesh_manifest.push_back(std::move(mesh));
+    }
+
+    u32 const mesh_group_count = reader.read<u32>();
+    for (u32 mesh_group_index = 0; mesh_group_index < mesh_group_count && !reader.failed; mesh_group_index++)
+    {
+        MeshGroupManifestEntry mesh_group = {};
+        mesh_group.mesh_count = reader.read<u32>();
+        if (mesh_group.mesh_count > MAX_MESHES_PER_MESHGROUP)
+        {
+            return ErrorCode::INVALID_CACHE_FILE;
+        }
+        for (u32 mesh_in_meshgroup_index = 0; mesh_in_meshgroup_index < mesh_group.mesh_count; mesh_in_meshgroup_index++)
+        {
+            mesh_group.mesh_manifest_indices.at(mesh_in_meshgroup_index) = reader.read<u32>();
+        }
+        mesh_group.in_scene_file_index = reader.read<u32>();
+        mesh_group.name = reader.read_string();
+        cache.mesh_group_manifest.push_back(std::move(mesh_group));
+    }
+
+    u32 const render_entity_count = reader.read<u32>();
+    for (u32 render_entity_index = 0; render_entity_index < render_entity_count && !reader.failed; render_entity_index++)
+    {
+        CachedRenderEntity cached_entity = {};
+        cached_entity.entity.transform = reader.read<glm::mat4x3>();
+        cached_entity.first_child_index = reader.read_optional_index();
+        cached_entity.next_sibling_index = reader.read_optional_index();
+        cached_entity.parent_index = reader.read_optional_index();
+        cached_entity.entity.mesh_group_manifest_index = reader.read_optional_index();
+        cached_entity.entity.type = static_cast<EntityType>(reader.read<u32>());
+        cached_entity.entity.name = reader.read_string();
+        cache.render_entities.push_back(std::move(cached_entity));
+    }
+    cache.root_render_entity_index = reader.read<u32>();
+#pragma endregion
+
+#pragma region BULK_DATA
+    cache.indices = reader.read_array<u32>();
+    cache.indices_16 = reader.read_array<u16>();
+    cache.positions = reader.read_array<f32vec3>();
+    cache.uvs = reader.read_array<f32vec2>();
+    cache.tangents = reader.read_array<f32vec4>();
+    cache.normals = reader.read_array<f32vec3>();
+    cache.meshlets = reader.read_array<Meshlet>();
+    cache.textures = reader.read_array<CookedTextureInfo>();
+    u64 const texel_blob_size = reader.read<u64>();
+    reader.align(CACHE_ALIGNMENT);
+    std::byte const * texel_blob_start = reader.read_bytes(texel_blob_size);
+    if (reader.failed || cache.root_render_entity_index >= cache.render_entities.size())
+    {
+        return ErrorCode::INVALID_CACHE_FILE;
+    }
+    cache.texel_blob = {texel_blob_start, static_cast<usize>(texel_blob_size)};
+    for (CookedTextureInfo const & texture : cache.textures)
+    {
+        if (texture.texels_offset + texture.texels_size > texel_blob_size)
+        {
+            return ErrorCode::INVALID_CACHE_FILE;
+        }
+    }
+    if (!cache.has_valid_indices())
+    {
+        return ErrorCode::INVALID_CACHE_FILE;
+    }
+#pragma endregion
+    return cache;
+}
+
+auto SceneCache::has_valid_indices() const -> bool
+{
+    auto is_valid = [](std::optional<u32> const & index, usize count) -> bool
+    {
+        return !index.has_value() || index.value() < count;
+    };
+    for (TextureManifestEntry const & texture : texture_manifest)
+    {
+        for (auto const & usage : texture.material_manifest_indices)
+        {
+            if (usage.material_manifest_index >= material_manifest.size())
+            {
+                return false;
+            }
+        }
+    }
+    for (MaterialManifestEntry const & material : material_manifest)
+    {
+        if (!is_valid(material.diffuse_tex_index, texture_manifest.size()) || !is_valid(material.normal_tex_index, texture_manifest.size()))
+        {
+            return false;
+        }
+    }
+    for (MeshManifestEntry const & mesh : mesh_manifest)
+    {
+        if (!is_valid(mesh.material_manifest_index, material_manifest.size()))
+        {
+            return false;
+        }
+        if (mesh.cpu_runtime.has_value())
+        {
+            MeshDescriptorCpu const & runtime = mesh.cpu_runtime.value();
+            usize const index_pool_size = runtime.index_format == MESH_INDEX_FORMAT_U16 ? indices_16.size() : indices.size();
+            if (static_cast<u64>(runtime.positions_offset) + runtime.vertex_count > positions.size() ||
+                static_cast<u64>(runtime.uvs_offset) + runtime.vertex_count > uvs.size() ||
+                static_cast<u64>(runtime.tangents_offset) + runtime.vertex_count > tangents.size() ||
+                static_cast<u64>(runtime.normals_offset) + runtime.vertex_count > normals.size() ||
+                static_cast<u64>(runtime.indices_offset) + runtime.index_count > index_pool_size ||
+                runtime.lod_count > MAX_MESH_LODS)
+            {
+                return false;
+            }
+        }
+    }
+    for (MeshGroupManifestEntry const & mesh_group : mesh_group_manifest)
+    {
+        for (u32 mesh_in_meshgroup_index = 0; mesh_in_meshgroup_index < mesh_group.mesh_count; mesh_in_meshgroup_index++)
+        {
+            if (mesh_group.mesh_manifest_indices.at(mesh_in_meshgroup_index) >= mesh_manifest.size())
+            {
+                return false;
+            }
+        }
+    }
+    for (CachedRenderEntity const & cached_entity : render_entities)
+    {
+        if (!is_valid(cached_entity.first_child_index, render_entities.size()) ||
+            !is_valid(cached_entity.next_sibling_index, render_entities.size()) ||
+            !is_valid(cached_entity.parent_index, render_entities.size()) ||
+            !is_valid(cached_entity.entity.mesh_group_manifest_index, mesh_group_manifest.size()) ||
+            static_cast<u32>(cached_entity.entity.type) > static_cast<u32>(EntityType::UNKNOWN))
+        {
+            return false;
+        }
+    }
+    for (CookedTextureInfo const & texture : textures)
+    {
+        // Every texture is cooked with its whole mip chain
+        if (texture.texture_manifest_index >= texture_manifest.size() ||
+            texture.mip_level_count == 0 || texture.mip_level_count > 32 ||
+            texture.stored_mip_count != texture.mip_level_count)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto SceneCache::load_manifest(Scene & scene) const -> RenderEntityId
+{
+    DBG_ASSERT_TRUE_M(scene._scene_file_manifest.empty() && scene._render_entities.capacity() == 0,
+                      "[ERROR][SceneCache::load_manifest()] Scene cache can only be loaded into an empty scene");
+    u32 const scene_file_manifest_index = 0;
+
+    for (TextureManifestEntry texture : texture_manifest)
+    {
+        texture.scene_file_manifest_index = scene_file_manifest_index;
+        scene._material_texture_manifest.push_back(std::move(texture));
+    }
+    for (MaterialManifestEntry material : material_manifest)
+    {
+        material.scene_file_manifest_index = scene_file_manifest_index;
+        scene._material_manifest.push_back(std::move(material));
+        scene._new_material_manifest_entries += 1;
+    }
+    for (MeshManifestEntry mesh : mesh_manifest)
+    {
+        mesh.scene_file_manifest_index = scene_file_manifest_index;
+        scene._mesh_manifest.push_back(std::move(mesh));
+        scene._new_mesh_manifest_entries += 1;
+    }
+    for (MeshGroupManifestEntry mesh_group : mesh_group_manifest)
+    {
+        mesh_group.scene_file_manifest_index = scene_file_manifest_index;
+        scene._mesh_group_manifest.push_back(std::move(mesh_group));
+        scene._new_mesh_group_manifest_entries += 1;
+    }
+
+    /// NOTE: First allocate all the slots so that the stored indices can be translated into ids.
+    for (u32 render_entity_index = 0; render_entity_index < render_entities.size(); render_entity_index++)
+    {
+        scene._dirty_render_entities.push_back(scene._render_entities.create_slot());
+    }
+    auto index_to_entity_id = [&](std::optional<u32> const & index) -> std::optional<RenderEntityId>
+    {
+        return index.has_value() ? std::optional<RenderEntityId>{scene._render_entities.id_from_index(index.value())} : std::nullopt;
+    };
+    for (u32 render_entity_index = 0; render_entity_index < render_entities.size(); render_entity_index++)
+    {
+        CachedRenderEntity const & cached_entity = render_entities.at(render_entity_index);
+        RenderEntity & render_entity = *scene._render_entities.slot(scene._render_entities.id_from_index(render_entity_index));
+        render_entity = cached_entity.entity;
+        render_entity.first_child = index_to_entity_id(cached_entity.first_child_index);
+        render_entity.next_sibling = index_to_entity_id(cached_entity.next_sibling_index);
+        render_entity.parent = index_to_entity_id(cached_entity.parent_index);
+    }
+
+    RenderEntityId const root_render_entity = scene._render_entities.id_from_index(root_render_entity_index);
+    scene._scene_file_manifest.push_back(SceneFileManifestEntry{
+        .path = source_path,
+        .texture_manifest_offset = 0,
+        .material_manifest_offset = 0,
+        .mesh_group_manifest_offset = 0,
+        .mesh_manifest_offset = 0,
+        .root_render_entity = root_render_entity,
+    });
+    return root_render_entity;
+}
+
+auto SceneCache::get_texels(CookedTextureInfo const & info) const -> std::span<std::byte const>
+{
+    return texel_blob.subspan(info.texels_offset, info.texels_size);
+}
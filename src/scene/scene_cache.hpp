@@ -0,0 +1,126 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <variant>
+
+#include "../fairy_forest.hpp"
+#include "../mapped_file.hpp"
+#include "scene.hpp"
+
+using namespace ff::types;
+
+/// NOTE: Describes a single texture stored in the scene cache. Mips [0, stored_mip_count) are tightly packed
+//        one after another starting at texels_offset. Textures are cooked with their whole mip chain, so
+//        stored_mip_count always equals mip_level_count.
+struct CookedTextureInfo
+{
+    u32 texture_manifest_index = {};
+    VkFormat format = {};
+    u32 width = {};
+    u32 height = {};
+    u32 mip_level_count = {};
+    u32 stored_mip_count = {};
+    // Relative to the start of the texel blob section
+    u64 texels_offset = {};
+    u64 texels_size = {};
+};
+
+struct CookedTexture
+{
+    CookedTextureInfo info = {};
+    std::span<std::byte const> texels = {};
+};
+
+struct SceneCacheWriteInfo
+{
+    Scene const & scene;
+    std::filesystem::path cache_path = {};
+    std::span<u32 const> indices = {};
+    std::span<u16 const> indices_16 = {};
+    std::span<f32vec3 const> positions = {};
+    std::span<f32vec2 const> uvs = {};
+    std::span<f32vec4 const> tangents = {};
+    std::span<f32vec3 const> normals = {};
+    std::span<Meshlet const> meshlets = {};
+    std::span<CookedTexture const> textures = {};
+};
+
+/// NOTE: Cooked, memory mapped version of a single gltf scene file. Contains the scene manifests, the concatenated
+//        vertex and index streams and pre-mipped texel data, so loading it skips both gltf parsing and image decoding.
+//        The cache stores the size and modification time of every file the gltf references and a hash of the gltf itself,
+//        any mismatch invalidates the cache.
+struct SceneCache
+{
+  public:
+    static constexpr u32 MAGIC = 0x43534646; // FFSC
+    static constexpr u32 VERSION = 8;
+
+    enum struct ErrorCode
+    {
+        CACHE_FILE_NOT_FOUND,
+        INVALID_CACHE_FILE,
+        CACHE_VERSION_MISMATCH,
+        SOURCE_PATH_MISMATCH,
+        SOURCE_FILE_CHANGED,
+        UNSUPPORTED_SCENE,
+        COULD_NOT_WRITE_CACHE_FILE,
+    };
+    static auto to_string(ErrorCode code) -> std::string_view
+    {
+        switch (code)
+        {
+            case ErrorCode::CACHE_FILE_NOT_FOUND:       return "CACHE_FILE_NOT_FOUND";
+            case ErrorCode::INVALID_CACHE_FILE:         return "INVALID_CACHE_FILE";
+            case ErrorCode::CACHE_VERSION_MISMATCH:     return "CACHE_VERSION_MISMATCH";
+            case ErrorCode::SOURCE_PATH_MISMATCH:       return "SOURCE_PATH_MISMATCH";
+            case ErrorCode::SOURCE_FILE_CHANGED:        return "SOURCE_FILE_CHANGED";
+            case ErrorCode::UNSUPPORTED_SCENE:          return "UNSUPPORTED_SCENE";
+            case ErrorCode::COULD_NOT_WRITE_CACHE_FILE: return "COULD_NOT_WRITE_CACHE_FILE";
+            default:                                    return "UNKNOWN";
+        }
+    }
+
+    SceneCache() = default;
+    SceneCache(SceneCache &&) = default;
+    SceneCache & operator=(SceneCache &&) = default;
+
+    static auto open(std::filesystem::path const & cache_path, std::filesystem::path const & source_path) -> std::variant<SceneCache, ErrorCode>;
+    static auto write(SceneCacheWriteInfo const & info) -> std::optional<ErrorCode>;
+
+    // Scene must be empty, the cache restores the manifests exactly as they were when cooked.
+    auto load_manifest(Scene & scene) const -> RenderEntityId;
+    auto get_texels(CookedTextureInfo const & info) const -> std::span<std::byte const>;
+
+    /// NOTE: All spans point directly into the mapped file.
+    std::span<CookedTextureInfo const> textures = {};
+    std::span<u32 const> indices = {};
+    std::span<u16 const> indices_16 = {};
+    std::span<f32vec3 const> positions = {};
+    std::span<f32vec2 const> uvs = {};
+    std::span<f32vec4 const> tangents = {};
+    std::span<f32vec3 const> normals = {};
+    std::span<Meshlet const> meshlets = {};
+
+  private:
+    struct CachedRenderEntity
+    {
+        RenderEntity entity = {};
+        std::optional<u32> first_child_index = {};
+        std::optional<u32> next_sibling_index = {};
+        std::optional<u32> parent_index = {};
+    };
+
+    ff::MappedFile file = {};
+    std::filesystem::path source_path = {};
+    std::vector<TextureManifestEntry> texture_manifest = {};
+    std::vector<MaterialManifestEntry> material_manifest = {};
+    std::vector<MeshManifestEntry> mesh_manifest = {};
+    std::vector<MeshGroupManifestEntry> mesh_group_manifest = {};
+    std::vector<CachedRenderEntity> render_entities = {};
+    u32 root_render_entity_index = {};
+    std::span<std::byte const> texel_blob = {};
+
+    // Every index stored in the manifests and texture infos points into the arrays read with it
+    auto has_valid_indices() const -> bool;
+};
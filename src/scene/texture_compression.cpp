@@ -0,0 +1,410 @@
+#include "texture_compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+/// NOTE: The palette searches test four texels at once with SSE2, which every x86-64 target has. Other targets
+//        use the scalar loops, both pick the same indices.
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BC_ENCODER_SSE2 1
+#else
+#define BC_ENCODER_SSE2 0
+#endif
+
+// Texels of one 4x4 block, edge texels are replicated for blocks crossing the border of the mip
+struct BlockTexels
+{
+    std::array<f32vec3, 16> colors = {};
+    std::array<f32, 16> alphas = {};
+    // Channels of colors, one array each so the palette search can load four texels at once
+    alignas(16) std::array<f32, 16> reds = {};
+    alignas(16) std::array<f32, 16> greens = {};
+    alignas(16) std::array<f32, 16> blues = {};
+};
+
+// Source texel byte offsets of the channels, B8G8R8A8 stores red in byte 2. Two channel sources have no blue or alpha.
+struct SourceLayout
+{
+    u32 texel_byte_size = {};
+    u32 red = {};
+    u32 green = {};
+    u32 blue = {};
+    u32 alpha = {};
+};
+
+static auto get_source_layout(VkFormat source_format) -> SourceLayout
+{
+    switch (source_format)
+    {
+        case VkFormat::VK_FORMAT_B8G8R8A8_SRGB:
+        case VkFormat::VK_FORMAT_B8G8R8A8_UNORM: return SourceLayout{.texel_byte_size = 4, .red = 2, .green = 1, .blue = 0, .alpha = 3};
+        case VkFormat::VK_FORMAT_R8G8_UNORM:     return SourceLayout{.texel_byte_size = 2, .red = 0, .green = 1, .blue = 0, .alpha = 0};
+        default:                                 return SourceLayout{};
+    }
+}
+
+static void gather_block(std::span<std::byte const> src, SourceLayout const & layout, u32 width, u32 height, u32 block_x, u32 block_y, BlockTexels & block)
+{
+    u8 const * texels = reinterpret_cast<u8 const *>(src.data());
+    for (u32 texel = 0; texel < 16; texel++)
+    {
+        u32 const x = std::min(block_x * BC_BLOCK_EXTENT + texel % BC_BLOCK_EXTENT, width - 1);
+        u32 const y = std::min(block_y * BC_BLOCK_EXTENT + texel / BC_BLOCK_EXTENT, height - 1);
+        u8 const * texel_bytes = texels + (static_cast<usize>(y) * width + x) * layout.texel_byte_size;
+        block.colors[texel] = f32vec3(texel_bytes[layout.red], texel_bytes[layout.green], texel_bytes[layout.blue]);
+        block.alphas[texel] = texel_bytes[layout.alpha];
+        block.reds[texel] = block.colors[texel].r;
+        block.greens[texel] = block.colors[texel].g;
+        block.blues[texel] = block.colors[texel].b;
+    }
+}
+
+static auto pack_565(f32vec3 color) -> u16
+{
+    f32vec3 const clamped = glm::clamp(color, f32vec3(0.0f), f32vec3(255.0f));
+    u32 const r = static_cast<u32>(clamped.r * (31.0f / 255.0f) + 0.5f);
+    u32 const g = static_cast<u32>(clamped.g * (63.0f / 255.0f) + 0.5f);
+    u32 const b = static_cast<u32>(clamped.b * (31.0f / 255.0f) + 0.5f);
+    return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+
+static auto unpack_565(u16 packed) -> f32vec3
+{
+    u32 const r = (packed >> 11) & 31;
+    u32 const g = (packed >> 5) & 63;
+    u32 const b = packed & 31;
+    return f32vec3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+}
+
+// Picks the closest of the four palette entries for every texel, returns the packed indices and the squared error
+static auto select_color_indices(BlockTexels const & block, u16 endpoint_0, u16 endpoint_1, u32 & indices) -> f32
+{
+    f32vec3 const color_0 = unpack_565(endpoint_0);
+    f32vec3 const color_1 = unpack_565(endpoint_1);
+    std::array<f32vec3, 4> const palette = {
+        color_0,
+        color_1,
+        (color_0 * 2.0f + color_1) * (1.0f / 3.0f),
+        (color_0 + color_1 * 2.0f) * (1.0f / 3.0f),
+    };
+    indices = 0;
+#if BC_ENCODER_SSE2
+    __m128 total_error = _mm_setzero_ps();
+    for (u32 texel = 0; texel < 16; texel += 4)
+    {
+        __m128 const reds = _mm_load_ps(&block.reds[texel]);
+        __m128 const greens = _mm_load_ps(&block.greens[texel]);
+        __m128 const blues = _mm_load_ps(&block.blues[texel]);
+        __m128 best_error = _mm_set1_ps(std::numeric_limits<f32>::max());
+        __m128i best_index = _mm_setzero_si128();
+        for (u32 palette_index = 0; palette_index < 4; palette_index++)
+        {
+            __m128 const red_difference = _mm_sub_ps(reds, _mm_set1_ps(palette[palette_index].r));
+            __m128 const green_difference = _mm_sub_ps(greens, _mm_set1_ps(palette[palette_index].g));
+            __m128 const blue_difference = _mm_sub_ps(blues, _mm_set1_ps(palette[palette_index].b));
+            __m128 const error = _mm_add_ps(_mm_add_ps(_mm_mul_ps(red_difference, red_difference), _mm_mul_ps(green_difference, green_difference)),
+                                            _mm_mul_ps(blue_difference, blue_difference));
+            __m128i const is_better = _mm_castps_si128(_mm_cmplt_ps(error, best_error));
+            best_error = _mm_min_ps(error, best_error);
+            best_index = _mm_or_si128(_mm_and_si128(is_better, _mm_set1_epi32(static_cast<i32>(palette_index))), _mm_andnot_si128(is_better, best_index));
+        }
+        alignas(16) std::array<u32, 4> texel_indices = {};
+        _mm_store_si128(reinterpret_cast<__m128i *>(texel_indices.data()), best_index);
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            indices |= texel_indices[lane] << ((texel + lane) * 2);
+        }
+        total_error = _mm_add_ps(total_error, best_error);
+    }
+    alignas(16) std::array<f32, 4> lane_errors = {};
+    _mm_store_ps(lane_errors.data(), total_error);
+    return lane_errors[0] + lane_errors[1] + lane_errors[2] + lane_errors[3];
+#else
+    f32 total_error = 0.0f;
+    for (u32 texel = 0; texel < 16; texel++)
+    {
+        u32 best_index = 0;
+        f32 best_error = std::numeric_limits<f32>::max();
+        for (u32 palette_index = 0; palette_index < 4; palette_index++)
+        {
+            f32vec3 const difference = block.colors[texel] - palette[palette_index];
+            f32 const error = glm::dot(difference, difference);
+            if (error < best_error)
+            {
+                best_error = error;
+                best_index = palette_index;
+            }
+        }
+        indices |= best_index << (texel * 2);
+        total_error += best_error;
+    }
+    return total_error;
+#endif
+}
+
+/// NOTE: Four color mode needs endpoint_0 > endpoint_1, swapping the endpoints maps index 0 <-> 1 and 2 <-> 3.
+//        Equal endpoints fall back to three color mode, the block is then a single color and all indices are 0.
+static auto order_color_endpoints(u16 & endpoint_0, u16 & endpoint_1) -> bool
+{
+    if (endpoint_0 < endpoint_1)
+    {
+        std::swap(endpoint_0, endpoint_1);
+    }
+    return endpoint_0 != endpoint_1;
+}
+
+// Endpoints along the principal axis of the block colors, inset by 1/16 of the range to reduce the rounding error
+static void fit_color_endpoints(BlockTexels const & block, f32vec3 & endpoint_0, f32vec3 & endpoint_1)
+{
+    f32vec3 mean = f32vec3(0.0f);
+    for (f32vec3 const & color : block.colors)
+    {
+        mean += color;
+    }
+    mean *= 1.0f / 16.0f;
+    f32 cov_xx = 0.0f, cov_xy = 0.0f, cov_xz = 0.0f, cov_yy = 0.0f, cov_yz = 0.0f, cov_zz = 0.0f;
+    for (f32vec3 const & color : block.colors)
+    {
+        f32vec3 const d = color - mean;
+        cov_xx += d.x * d.x;
+        cov_xy += d.x * d.y;
+        cov_xz += d.x * d.z;
+        cov_yy += d.y * d.y;
+        cov_yz += d.y * d.z;
+        cov_zz += d.z * d.z;
+    }
+    f32mat3x3 const covariance = f32mat3x3(cov_xx, cov_xy, cov_xz, cov_xy, cov_yy, cov_yz, cov_xz, cov_yz, cov_zz);
+    // Power iteration, starting from the diagonal keeps grey ramps on the luminance axis
+    f32vec3 axis = f32vec3(cov_xx, cov_yy, cov_zz);
+    for (u32 iteration = 0; iteration < 8; iteration++)
+    {
+        f32vec3 const next_axis = covariance * axis;
+        f32 const next_length = glm::length(next_axis);
+        if (next_length < 1e-6f)
+        {
+            break;
+        }
+        axis = next_axis / next_length;
+    }
+    if (glm::dot(axis, axis) < 1e-12f)
+    {
+        axis = f32vec3(1.0f);
+    }
+    f32 min_projection = std::numeric_limits<f32>::max();
+    f32 max_projection = std::numeric_limits<f32>::lowest();
+    for (f32vec3 const & color : block.colors)
+    {
+        f32 const projection = glm::dot(color - mean, axis);
+        min_projection = std::min(min_projection, projection);
+        max_projection = std::max(max_projection, projection);
+    }
+    f32 const inset = (max_projection - min_projection) / 16.0f;
+    f32 const axis_length_sq = std::max(glm::dot(axis, axis), 1e-12f);
+    endpoint_0 = mean + axis * ((max_projection - inset) / axis_length_sq);
+    endpoint_1 = mean + axis * ((min_projection + inset) / axis_length_sq);
+}
+
+/// NOTE: Solves for the endpoints minimizing the squared error of the chosen indices. Each texel is a blend
+//        color_0 * alpha + color_1 * beta with (alpha, beta) given by its palette entry.
+static auto refit_color_endpoints(BlockTexels const & block, u32 indices, f32vec3 & endpoint_0, f32vec3 & endpoint_1) -> bool
+{
+    static constexpr std::array<f32, 4> INDEX_WEIGHTS = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    f32 alpha_alpha = 0.0f, beta_beta = 0.0f, alpha_beta = 0.0f;
+    f32vec3 alpha_color = f32vec3(0.0f);
+    f32vec3 beta_color = f32vec3(0.0f);
+    for (u32 texel = 0; texel < 16; texel++)
+    {
+        f32 const alpha = INDEX_WEIGHTS[(indices >> (texel * 2)) & 3];
+        f32 const beta = 1.0f - alpha;
+        alpha_alpha += alpha * alpha;
+        beta_beta += beta * beta;
+        alpha_beta += alpha * beta;
+        alpha_color += block.colors[texel] * alpha;
+        beta_color += block.colors[texel] * beta;
+    }
+    f32 const determinant = alpha_alpha * beta_beta - alpha_beta * alpha_beta;
+    if (std::abs(determinant) < 1e-6f)
+    {
+        return false;
+    }
+    f32 const inverse_determinant = 1.0f / determinant;
+    endpoint_0 = (alpha_color * beta_beta - beta_color * alpha_beta) * inverse_determinant;
+    endpoint_1 = (beta_color * alpha_alpha - alpha_color * alpha_beta) * inverse_determinant;
+    return true;
+}
+
+// 8 byte BC1 color block, always in four color mode so that it can also be used as the color half of BC3
+static void encode_color_block(BlockTexels const & block, u8 * dst)
+{
+    f32vec3 fit_0 = {};
+    f32vec3 fit_1 = {};
+    fit_color_endpoints(block, fit_0, fit_1);
+    u16 endpoint_0 = pack_565(fit_0);
+    u16 endpoint_1 = pack_565(fit_1);
+    u32 indices = 0;
+    if (order_color_endpoints(endpoint_0, endpoint_1))
+    {
+        f32 const error = select_color_indices(block, endpoint_0, endpoint_1, indices);
+        f32vec3 refit_0 = {};
+        f32vec3 refit_1 = {};
+        if (refit_color_endpoints(block, indices, refit_0, refit_1))
+        {
+            u16 refit_endpoint_0 = pack_565(refit_0);
+            u16 refit_endpoint_1 = pack_565(refit_1);
+            u32 refit_indices = 0;
+            if (order_color_endpoints(refit_endpoint_0, refit_endpoint_1) &&
+                select_color_indices(block, refit_endpoint_0, refit_endpoint_1, refit_indices) < error)
+            {
+                endpoint_0 = refit_endpoint_0;
+                endpoint_1 = refit_endpoint_1;
+                indices = refit_indices;
+            }
+        }
+    }
+    std::memcpy(dst + 0, &endpoint_0, sizeof(u16));
+    std::memcpy(dst + 2, &endpoint_1, sizeof(u16));
+    std::memcpy(dst + 4, &indices, sizeof(u32));
+}
+
+/// NOTE: 8 byte BC4 block, the endpoints are the channel range in eight value mode (endpoint_0 > endpoint_1).
+//        Index 0 and 1 are the endpoints, index i in [2, 7] blends them as ((8 - i) * e0 + (i - 1) * e1) / 7.
+static void encode_channel_block(std::array<f32, 16> const & values, u8 * dst)
+{
+    f32 const min_value = *std::min_element(values.begin(), values.end());
+    f32 const max_value = *std::max_element(values.begin(), values.end());
+    u8 const endpoint_0 = static_cast<u8>(max_value);
+    u8 const endpoint_1 = static_cast<u8>(min_value);
+    std::array<f32, 8> palette = {static_cast<f32>(endpoint_0), static_cast<f32>(endpoint_1)};
+    for (u32 palette_index = 2; palette_index < 8; palette_index++)
+    {
+        palette[palette_index] = (static_cast<f32>(8 - palette_index) * endpoint_0 + static_cast<f32>(palette_index - 1) * endpoint_1) / 7.0f;
+    }
+    u64 indices = 0;
+    if (endpoint_0 != endpoint_1)
+    {
+#if BC_ENCODER_SSE2
+        __m128 const sign_mask = _mm_set1_ps(-0.0f);
+        for (u32 texel = 0; texel < 16; texel += 4)
+        {
+            __m128 const texel_values = _mm_loadu_ps(&values[texel]);
+            __m128 best_error = _mm_set1_ps(std::numeric_limits<f32>::max());
+            __m128i best_index = _mm_setzero_si128();
+            for (u32 palette_index = 0; palette_index < 8; palette_index++)
+            {
+                __m128 const error = _mm_andnot_ps(sign_mask, _mm_sub_ps(texel_values, _mm_set1_ps(palette[palette_index])));
+                __m128i const is_better = _mm_castps_si128(_mm_cmplt_ps(error, best_error));
+                best_error = _mm_min_ps(error, best_error);
+                best_index = _mm_or_si128(_mm_and_si128(is_better, _mm_set1_epi32(static_cast<i32>(palette_index))), _mm_andnot_si128(is_better, best_index));
+            }
+            alignas(16) std::array<u32, 4> texel_indices = {};
+            _mm_store_si128(reinterpret_cast<__m128i *>(texel_indices.data()), best_index);
+            for (u32 lane = 0; lane < 4; lane++)
+            {
+                indices |= static_cast<u64>(texel_indices[lane]) << ((texel + lane) * 3);
+            }
+        }
+#else
+        for (u32 texel = 0; texel < 16; texel++)
+        {
+            u64 best_index = 0;
+            f32 best_error = std::numeric_limits<f32>::max();
+            for (u32 palette_index = 0; palette_index < 8; palette_index++)
+            {
+                f32 const error = std::abs(values[texel] - palette[palette_index]);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best_index = palette_index;
+                }
+            }
+            indices |= best_index << (texel * 3);
+        }
+#endif
+    }
+    dst[0] = endpoint_0;
+    dst[1] = endpoint_1;
+    for (u32 byte = 0; byte < 6; byte++)
+    {
+        dst[2 + byte] = static_cast<u8>(indices >> (byte * 8));
+    }
+}
+
+auto get_block_compressed_format(VkFormat source_format, bool has_alpha) -> VkFormat
+{
+    switch (source_format)
+    {
+        case VkFormat::VK_FORMAT_B8G8R8A8_SRGB: return has_alpha ? VkFormat::VK_FORMAT_BC3_SRGB_BLOCK : VkFormat::VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        // Tangent space normal maps, the shaders reconstruct z from x and y
+        case VkFormat::VK_FORMAT_B8G8R8A8_UNORM:
+        case VkFormat::VK_FORMAT_R8G8_UNORM:    return VkFormat::VK_FORMAT_BC5_UNORM_BLOCK;
+        default:                                return VkFormat::VK_FORMAT_UNDEFINED;
+    }
+}
+
+auto is_block_compressed_format(VkFormat format) -> bool
+{
+    switch (format)
+    {
+        case VkFormat::VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VkFormat::VK_FORMAT_BC3_SRGB_BLOCK:
+        case VkFormat::VK_FORMAT_BC5_UNORM_BLOCK: return true;
+        default:                                  return false;
+    }
+}
+
+auto block_compressed_mip_byte_size(VkFormat format, u32 width, u32 height) -> usize
+{
+    usize const block_byte_size = format == VkFormat::VK_FORMAT_BC1_RGB_SRGB_BLOCK ? 8 : 16;
+    usize const block_count_x = (width + BC_BLOCK_EXTENT - 1) / BC_BLOCK_EXTENT;
+    usize const block_count_y = (height + BC_BLOCK_EXTENT - 1) / BC_BLOCK_EXTENT;
+    return block_count_x * block_count_y * block_byte_size;
+}
+
+void compress_mip(VkFormat source_format, VkFormat compressed_format, std::span<std::byte const> src, u32 width, u32 height, std::span<std::byte> dst)
+{
+    SourceLayout const layout = get_source_layout(source_format);
+    DBG_ASSERT_TRUE_M(layout.texel_byte_size != 0 && src.size() == static_cast<usize>(width) * height * layout.texel_byte_size,
+                      "[ERROR][compress_mip()] Unsupported source format or mismatched texel data size");
+    DBG_ASSERT_TRUE_M(dst.size() == block_compressed_mip_byte_size(compressed_format, width, height),
+                      "[ERROR][compress_mip()] Destination does not match the compressed mip size");
+    u32 const block_count_x = (width + BC_BLOCK_EXTENT - 1) / BC_BLOCK_EXTENT;
+    u32 const block_count_y = (height + BC_BLOCK_EXTENT - 1) / BC_BLOCK_EXTENT;
+    u8 * block_dst = reinterpret_cast<u8 *>(dst.data());
+    BlockTexels block = {};
+    for (u32 block_y = 0; block_y < block_count_y; block_y++)
+    {
+        for (u32 block_x = 0; block_x < block_count_x; block_x++)
+        {
+            gather_block(src, layout, width, height, block_x, block_y, block);
+            switch (compressed_format)
+            {
+                case VkFormat::VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    encode_color_block(block, block_dst);
+                    block_dst += 8;
+                    break;
+                case VkFormat::VK_FORMAT_BC3_SRGB_BLOCK:
+                    encode_channel_block(block.alphas, block_dst);
+                    encode_color_block(block, block_dst + 8);
+                    block_dst += 16;
+                    break;
+                case VkFormat::VK_FORMAT_BC5_UNORM_BLOCK:
+                {
+                    std::array<f32, 16> red = {};
+                    std::array<f32, 16> green = {};
+                    for (u32 texel = 0; texel < 16; texel++)
+                    {
+                        red[texel] = block.colors[texel].r;
+                        green[texel] = block.colors[texel].g;
+                    }
+                    encode_channel_block(red, block_dst);
+                    encode_channel_block(green, block_dst + 8);
+                    block_dst += 16;
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+}
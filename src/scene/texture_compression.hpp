@@ -0,0 +1,22 @@
+#pragma once
+
+#include <span>
+
+#include "../fairy_forest.hpp"
+#include "../backend/backend.hpp"
+
+using namespace ff::types;
+
+/// NOTE: CPU encoders for the BC1, BC3 and BC5 block compressed formats. Every block covers 4x4 texels, mips
+//        whose extent is not a multiple of four replicate their edge texels into the missing part of the block.
+//        Colors are fit along the principal axis of the block and refined with a least squares pass, single
+//        channel blocks use the channel range. Only touches CPU memory so it is safe to call from multiple threads.
+static constexpr u32 BC_BLOCK_EXTENT = 4;
+
+// Returns VK_FORMAT_UNDEFINED when texels of source_format are not block compressed
+auto get_block_compressed_format(VkFormat source_format, bool has_alpha) -> VkFormat;
+auto is_block_compressed_format(VkFormat format) -> bool;
+// Bytes of a width x height mip in the block compressed format
+auto block_compressed_mip_byte_size(VkFormat format, u32 width, u32 height) -> usize;
+// Encodes a single tightly packed mip of source_format texels into dst, dst must hold block_compressed_mip_byte_size()
+void compress_mip(VkFormat source_format, VkFormat compressed_format, std::span<std::byte const> src, u32 width, u32 height, std::span<std::byte> dst);
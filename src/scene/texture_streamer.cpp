@@ -0,0 +1,577 @@
+#include "texture_streamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Updates a texture waits before requesting mips again after the budget could not fit them
+static constexpr u64 BUDGET_RETRY_UPDATE_COUNT = 60;
+// Mips are placed at this alignment in the staging memory, covers the texel block size of every texture format
+static constexpr usize STAGING_MIP_ALIGNMENT = 16;
+
+static auto mip_extent(u32 extent, u32 mip_level) -> u32
+{
+    return std::max(extent >> mip_level, 1u);
+}
+
+static auto align_up(usize value, usize alignment) -> usize
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Recorded as the release on the transfer queue and again as the acquire on the main queue
+static auto get_upload_release_info(ff::ImageId image, u32 uploaded_level_count) -> ff::ImageMemoryBarrierTransitionInfo
+{
+    return ff::ImageMemoryBarrierTransitionInfo{
+        .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dst_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        .dst_access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .level_count = uploaded_level_count,
+        .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+        .image_id = image,
+        .src_queue = ff::QueueType::TRANSFER,
+        .dst_queue = ff::QueueType::MAIN,
+    };
+}
+
+TextureStreamer::TextureStreamer(std::shared_ptr<ff::Device> device, TextureStreamerInfo const & info)
+    : _device{device},
+      _info{info}
+{
+    // Leaves room in the staging ring for the material updates and the uploads of the frames in flight
+    _info.max_upload_bytes_per_update = std::min(_info.max_upload_bytes_per_update, _device->get_staging_ring_size() / 4);
+    _statistics.vram_budget = _info.vram_budget;
+    _loader_threads.reserve(_info.loader_thread_count);
+    for (u32 loader_index = 0; loader_index < _info.loader_thread_count; loader_index++)
+    {
+        _loader_threads.emplace_back([this]()
+                                     { loader_main(); });
+    }
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock{_loader_mutex};
+        _exit_loaders = true;
+    }
+    _loader_condition.notify_all();
+    for (std::thread & loader_thread : _loader_threads)
+    {
+        loader_thread.join();
+    }
+    for (PendingUpload const & pending_upload : _pending_uploads)
+    {
+        _device->destroy_image(pending_upload.image);
+    }
+}
+
+auto TextureStreamer::get_mip_tail_start(u32 width, u32 height, u32 mip_level_count) const -> u32
+{
+    u32 mip_level = 0;
+    while (mip_level + 1 < mip_level_count && std::max(mip_extent(width, mip_level), mip_extent(height, mip_level)) > _info.mip_tail_extent)
+    {
+        mip_level += 1;
+    }
+    return mip_level;
+}
+
+void TextureStreamer::add_texture(StreamedTextureInfo && info)
+{
+    u32 const streamed_texture_index = static_cast<u32>(_textures.size());
+    if (info.texture_manifest_index >= _streamed_texture_indices.size())
+    {
+        _streamed_texture_indices.resize(info.texture_manifest_index + 1);
+    }
+    _streamed_texture_indices.at(info.texture_manifest_index) = streamed_texture_index;
+
+    u32 const tail_mip = info.resident_mip;
+    u32 const mip_level_count = info.mip_level_count;
+    StreamedTexture & texture = _textures.emplace_back(StreamedTexture{
+        .info = std::move(info),
+        .tail_mip = tail_mip,
+        .resident_mip = tail_mip,
+        .target_mip = tail_mip,
+        .requested_mip = tail_mip,
+        .mip_last_used = std::vector<u64>(mip_level_count, 0),
+    });
+    // A mip that does not fit into a single update is never streamed
+    texture.min_mip = 0;
+    while (texture.min_mip < tail_mip && mip_byte_size(texture, texture.min_mip) > _info.max_upload_bytes_per_update)
+    {
+        texture.min_mip += 1;
+    }
+    _statistics.streamed_texture_count += 1;
+    _statistics.resident_bytes += texture.get_texels().size() - texture.info.mip_offsets.at(tail_mip);
+}
+
+auto TextureStreamer::mip_byte_size(StreamedTexture const & texture, u32 mip_level) const -> usize
+{
+    usize const mip_end = mip_level + 1 < texture.info.mip_level_count ? texture.info.mip_offsets.at(mip_level + 1) : texture.get_texels().size();
+    return mip_end - texture.info.mip_offsets.at(mip_level);
+}
+
+void TextureStreamer::loader_main()
+{
+    while (true)
+    {
+        LoadRequest request = {};
+        {
+            std::unique_lock<std::mutex> lock{_loader_mutex};
+            _loader_condition.wait(lock, [&]
+                                   { return _exit_loaders || !_load_requests.empty(); });
+            if (_exit_loaders)
+            {
+                return;
+            }
+            request = _load_requests.front();
+            _load_requests.pop_front();
+        }
+        /// NOTE: Reading the source is what faults the mapped scene cache in, the copy keeps that off the main thread.
+        LoadedMips loaded_mips = {
+            .request = request,
+            .texels = std::vector<std::byte>(request.src_texels.begin(), request.src_texels.end()),
+        };
+        {
+            std::lock_guard<std::mutex> lock{_loader_mutex};
+            _loaded_mips.push_back(std::move(loaded_mips));
+        }
+    }
+}
+
+void TextureStreamer::update(Scene & scene, std::span<TextureFeedback const> feedback)
+{
+    if (_textures.empty())
+    {
+        return;
+    }
+    _update_index += 1;
+#pragma region PROCESS_FEEDBACK
+    /// NOTE: The density is the most texels per uv unit any sampled pixel of the material needed, a texture of
+    //        extent E is thus sampled at mip log2(E / density). Rounding down keeps the sharper of the two mips
+    //        trilinear filtering blends between.
+    for (StreamedTexture & texture : _textures)
+    {
+        texture.requested_mip = texture.tail_mip;
+    }
+    u32 const material_count = static_cast<u32>(std::min(feedback.size(), scene._material_manifest.size()));
+    for (u32 material_index = 0; material_index < material_count; material_index++)
+    {
+        u32 const density = feedback[material_index].max_density;
+        if (density == 0)
+        {
+            continue;
+        }
+        MaterialManifestEntry const & material = scene._material_manifest.at(material_index);
+        for (std::optional<u32> const texture_index : {material.diffuse_tex_index, material.normal_tex_index})
+        {
+            if (!texture_index.has_value() ||
+                texture_index.value() >= _streamed_texture_indices.size() ||
+                !_streamed_texture_indices.at(texture_index.value()).has_value())
+            {
+                continue;
+            }
+            StreamedTexture & texture = _textures.at(_streamed_texture_indices.at(texture_index.value()).value());
+            f32 const extent = static_cast<f32>(std::max(texture.info.width, texture.info.height));
+            f32 const requested_lod = std::log2(extent / static_cast<f32>(density)) + _info.mip_bias;
+            u32 const requested_mip = requested_lod <= static_cast<f32>(texture.min_mip)
+                                          ? texture.min_mip
+                                          : std::min(static_cast<u32>(requested_lod), texture.tail_mip);
+            texture.requested_mip = std::min(texture.requested_mip, requested_mip);
+        }
+    }
+#pragma endregion
+
+#pragma region ISSUE_LOADS
+    std::vector<LoadRequest> load_requests = {};
+    for (u32 streamed_texture_index = 0; streamed_texture_index < _textures.size(); streamed_texture_index++)
+    {
+        StreamedTexture & texture = _textures.at(streamed_texture_index);
+        for (u32 mip_level = texture.requested_mip; mip_level < texture.tail_mip; mip_level++)
+        {
+            texture.mip_last_used.at(mip_level) = _update_index;
+        }
+        if (texture.loading || texture.requested_mip >= texture.resident_mip || _update_index < texture.retry_update_index)
+        {
+            continue;
+        }
+        // A single load never exceeds what one update can upload, the finer mips are requested once it lands
+        u32 first_mip = texture.resident_mip - 1;
+        usize load_byte_size = mip_byte_size(texture, first_mip);
+        while (first_mip > texture.requested_mip &&
+               load_byte_size + mip_byte_size(texture, first_mip - 1) <= _info.max_upload_bytes_per_update)
+        {
+            first_mip -= 1;
+            load_byte_size += mip_byte_size(texture, first_mip);
+        }
+        load_requests.push_back({
+            .streamed_texture_index = streamed_texture_index,
+            .first_mip = first_mip,
+            .end_mip = texture.resident_mip,
+            .src_texels = texture.get_texels().subspan(texture.info.mip_offsets.at(first_mip), load_byte_size),
+        });
+        texture.loading = true;
+    }
+    std::vector<LoadedMips> loaded_mips = {};
+    {
+        std::lock_guard<std::mutex> lock{_loader_mutex};
+        _load_requests.insert(_load_requests.end(), load_requests.begin(), load_requests.end());
+        usize loaded_byte_size = 0;
+        while (!_loaded_mips.empty() && loaded_byte_size + _loaded_mips.front().texels.size() <= _info.max_upload_bytes_per_update)
+        {
+            loaded_byte_size += _loaded_mips.front().texels.size();
+            loaded_mips.push_back(std::move(_loaded_mips.front()));
+            _loaded_mips.pop_front();
+        }
+    }
+    if (!load_requests.empty())
+    {
+        _loader_condition.notify_all();
+    }
+#pragma endregion
+
+#pragma region ENFORCE_BUDGET
+    /// NOTE: Room for the loaded mips is made by evicting the top mip of the texture that was needed the longest
+    //        time ago. Textures the current feedback needs are never evicted, if the budget can not fit the whole
+    //        load its finest mips are dropped and requested again later.
+    std::vector<std::optional<u32>> texture_loaded_mips(_textures.size());
+    for (StreamedTexture & texture : _textures)
+    {
+        texture.target_mip = texture.resident_mip;
+    }
+    for (u32 loaded_index = 0; loaded_index < loaded_mips.size(); loaded_index++)
+    {
+        LoadRequest const & request = loaded_mips.at(loaded_index).request;
+        StreamedTexture & texture = _textures.at(request.streamed_texture_index);
+        usize required_byte_size = loaded_mips.at(loaded_index).texels.size();
+        while (_statistics.resident_bytes + required_byte_size > _info.vram_budget)
+        {
+            StreamedTexture * victim = nullptr;
+            for (StreamedTexture & candidate : _textures)
+            {
+                if (&candidate == &texture || candidate.loading || candidate.target_mip >= candidate.tail_mip)
+                {
+                    continue;
+                }
+                u64 const last_used = candidate.mip_last_used.at(candidate.target_mip);
+                if (last_used < _update_index && (victim == nullptr || last_used < victim->mip_last_used.at(victim->target_mip)))
+                {
+                    victim = &candidate;
+                }
+            }
+            if (victim == nullptr)
+            {
+                break;
+            }
+            _statistics.resident_bytes -= mip_byte_size(*victim, victim->target_mip);
+            _statistics.evicted_mip_count += 1;
+            victim->target_mip += 1;
+        }
+        u32 first_mip = request.first_mip;
+        while (_statistics.resident_bytes + required_byte_size > _info.vram_budget && first_mip < request.end_mip)
+        {
+            required_byte_size -= mip_byte_size(texture, first_mip);
+            first_mip += 1;
+            texture.retry_update_index = _update_index + BUDGET_RETRY_UPDATE_COUNT;
+        }
+        _statistics.resident_bytes += required_byte_size;
+        _statistics.loaded_mip_count += request.end_mip - first_mip;
+        texture.target_mip = first_mip;
+        texture_loaded_mips.at(request.streamed_texture_index) = loaded_index;
+        // Stays loading until the main queue acquired the uploaded mips, which also keeps it from being evicted
+        texture.loading = first_mip < request.end_mip;
+    }
+#pragma endregion
+
+#pragma region UPLOAD_LOADED_MIPS
+    std::vector<u32> uploaded_texture_indices = {};
+    usize staging_byte_size = 0;
+    for (u32 streamed_texture_index = 0; streamed_texture_index < _textures.size(); streamed_texture_index++)
+    {
+        StreamedTexture const & texture = _textures.at(streamed_texture_index);
+        if (texture.target_mip >= texture.resident_mip)
+        {
+            continue;
+        }
+        uploaded_texture_indices.push_back(streamed_texture_index);
+        for (u32 mip_level = texture.target_mip; mip_level < texture.resident_mip; mip_level++)
+        {
+            staging_byte_size += align_up(mip_byte_size(texture, mip_level), STAGING_MIP_ALIGNMENT);
+        }
+    }
+    if (!uploaded_texture_indices.empty())
+    {
+        std::optional<ff::StagingAllocation> const texel_staging = _device->allocate_staging(staging_byte_size, STAGING_MIP_ALIGNMENT);
+        if (!texel_staging.has_value())
+        {
+            APP_LOG(fmt::format("[ERROR][TextureStreamer::update()] Failed to allocate {} bytes of staging memory", staging_byte_size));
+            throw std::runtime_error("[ERROR][TextureStreamer::update()] Failed to allocate staging memory");
+        }
+        /// NOTE: Only the loaded mips are written on the transfer queue. They are released to the main queue right
+        //        away, the mips the old image already holds are copied over once the main queue acquired the image.
+        ff::CommandBuffer transfer_command_buffer = ff::CommandBuffer(_device, ff::QueueType::TRANSFER);
+        transfer_command_buffer.begin();
+        usize staging_offset = 0;
+        usize const first_pending_upload = _pending_uploads.size();
+        for (u32 const streamed_texture_index : uploaded_texture_indices)
+        {
+            StreamedTexture const & texture = _textures.at(streamed_texture_index);
+            TextureManifestEntry const & texture_entry = scene._material_texture_manifest.at(texture.info.texture_manifest_index);
+            u32 const new_first_mip = texture.target_mip;
+            u32 const uploaded_level_count = texture.resident_mip - new_first_mip;
+            ff::ImageId const new_image = _device->create_image({
+                .dimensions = 2,
+                .format = texture.info.format,
+                .extent = {mip_extent(texture.info.width, new_first_mip), mip_extent(texture.info.height, new_first_mip), 1},
+                .mip_level_count = texture.info.mip_level_count - new_first_mip,
+                .array_layer_count = 1,
+                .sample_count = 1,
+                .usage = VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                         VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                         VkImageUsageFlagBits::VK_IMAGE_USAGE_SAMPLED_BIT,
+                .alloc_flags = {},
+                .aspect = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+                .name = texture_entry.name,
+            });
+            transfer_command_buffer.cmd_image_memory_transition_barrier({
+                .src_stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+                .src_access = VK_ACCESS_2_NONE,
+                .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED,
+                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .level_count = uploaded_level_count,
+                .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+                .image_id = new_image,
+            });
+            LoadedMips const & loaded = loaded_mips.at(texture_loaded_mips.at(streamed_texture_index).value());
+            for (u32 mip_level = new_first_mip; mip_level < texture.resident_mip; mip_level++)
+            {
+                usize const src_offset = texture.info.mip_offsets.at(mip_level) - texture.info.mip_offsets.at(loaded.request.first_mip);
+                usize const mip_size = mip_byte_size(texture, mip_level);
+                std::memcpy(texel_staging->host_address + staging_offset, loaded.texels.data() + src_offset, mip_size);
+                transfer_command_buffer.cmd_copy_buffer_to_image({
+                    .buffer_id = texel_staging->buffer_id,
+                    .buffer_offset = texel_staging->offset + staging_offset,
+                    .image_id = new_image,
+                    .image_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .base_mip_level = mip_level - new_first_mip,
+                    .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+                    .image_offset = {0, 0, 0},
+                    .image_extent = {mip_extent(texture.info.width, mip_level), mip_extent(texture.info.height, mip_level), 1},
+                });
+                staging_offset += align_up(mip_size, STAGING_MIP_ALIGNMENT);
+                _statistics.uploaded_bytes += mip_size;
+            }
+            transfer_command_buffer.cmd_image_memory_transition_barrier(get_upload_release_info(new_image, uploaded_level_count));
+            _pending_uploads.push_back({
+                .streamed_texture_index = streamed_texture_index,
+                .new_first_mip = new_first_mip,
+                .image = new_image,
+            });
+        }
+        transfer_command_buffer.end();
+        auto recorded_transfer_command_buffer = transfer_command_buffer.get_recorded_command_buffer();
+        _device->submit({
+            .queue = ff::QueueType::TRANSFER,
+            .command_buffers = {&recorded_transfer_command_buffer, 1},
+        });
+        u64 const transfer_timeline_value = _device->get_last_submit_timeline(ff::QueueType::TRANSFER).value;
+        for (usize pending_index = first_pending_upload; pending_index < _pending_uploads.size(); pending_index++)
+        {
+            _pending_uploads.at(pending_index).transfer_timeline_value = transfer_timeline_value;
+        }
+    }
+#pragma endregion
+
+#pragma region RECORD_RESIDENCY_CHANGES
+    /// NOTE: Uploads are only acquired once the transfer queue finished them, waiting on an unfinished transfer
+    //        here would hold back the frames submitted after this update.
+    std::vector<ResidencyChange> residency_changes = {};
+    u64 const completed_transfer_value = _device->get_completed_timeline_value(ff::QueueType::TRANSFER);
+    u64 acquired_transfer_value = 0;
+    std::erase_if(_pending_uploads, [&](PendingUpload const & pending_upload)
+    {
+        if (pending_upload.transfer_timeline_value > completed_transfer_value)
+        {
+            return false;
+        }
+        residency_changes.push_back({
+            .streamed_texture_index = pending_upload.streamed_texture_index,
+            .new_first_mip = pending_upload.new_first_mip,
+            .uploaded_image = pending_upload.image,
+        });
+        acquired_transfer_value = std::max(acquired_transfer_value, pending_upload.transfer_timeline_value);
+        return true;
+    });
+    for (u32 streamed_texture_index = 0; streamed_texture_index < _textures.size(); streamed_texture_index++)
+    {
+        StreamedTexture const & texture = _textures.at(streamed_texture_index);
+        if (texture.target_mip > texture.resident_mip)
+        {
+            residency_changes.push_back({
+                .streamed_texture_index = streamed_texture_index,
+                .new_first_mip = texture.target_mip,
+            });
+        }
+    }
+    if (residency_changes.empty())
+    {
+        return;
+    }
+
+    ff::CommandBuffer command_buffer = ff::CommandBuffer(_device);
+    command_buffer.begin();
+    std::vector<ff::ImageId> retired_images = {};
+    std::vector<u32> dirty_material_indices = {};
+    for (ResidencyChange const & residency_change : residency_changes)
+    {
+        StreamedTexture & texture = _textures.at(residency_change.streamed_texture_index);
+        TextureManifestEntry & texture_entry = scene._material_texture_manifest.at(texture.info.texture_manifest_index);
+        ff::ImageId const old_image = texture_entry.runtime.value();
+        u32 const old_first_mip = texture.resident_mip;
+        u32 const new_first_mip = residency_change.new_first_mip;
+        u32 const mip_level_count = texture.info.mip_level_count;
+        // Levels of the new image below this one were written on the transfer queue
+        u32 const copied_base_level = std::max(old_first_mip, new_first_mip) - new_first_mip;
+        ff::ImageId new_image = {};
+        if (residency_change.uploaded_image.has_value())
+        {
+            new_image = residency_change.uploaded_image.value();
+            command_buffer.cmd_image_memory_transition_barrier(get_upload_release_info(new_image, copied_base_level));
+        }
+        else
+        {
+            new_image = _device->create_image({
+                .dimensions = 2,
+                .format = texture.info.format,
+                .extent = {mip_extent(texture.info.width, new_first_mip), mip_extent(texture.info.height, new_first_mip), 1},
+                .mip_level_count = mip_level_count - new_first_mip,
+                .array_layer_count = 1,
+                .sample_count = 1,
+                .usage = VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                         VkImageUsageFlagBits::VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                         VkImageUsageFlagBits::VK_IMAGE_USAGE_SAMPLED_BIT,
+                .alloc_flags = {},
+                .aspect = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+                .name = texture_entry.name,
+            });
+        }
+        command_buffer.cmd_image_memory_transition_barrier({
+            .src_stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+            .src_access = VK_ACCESS_2_NONE,
+            .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED,
+            .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .base_mip_level = copied_base_level,
+            .level_count = mip_level_count - new_first_mip - copied_base_level,
+            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+            .image_id = new_image,
+        });
+        // Frames submitted earlier may still sample the old image
+        command_buffer.cmd_image_memory_transition_barrier({
+            .src_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            .src_access = VK_ACCESS_2_NONE,
+            .dst_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .dst_access = VK_ACCESS_2_TRANSFER_READ_BIT,
+            .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .level_count = mip_level_count - old_first_mip,
+            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+            .image_id = old_image,
+        });
+        // Mips both images hold are copied on the GPU
+        for (u32 mip_level = std::max(old_first_mip, new_first_mip); mip_level < mip_level_count; mip_level++)
+        {
+            command_buffer.cmd_copy_image_to_image({
+                .src_image = old_image,
+                .dst_image = new_image,
+                .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+                .src_mip_level = mip_level - old_first_mip,
+                .dst_mip_level = mip_level - new_first_mip,
+                .src_offset = {0, 0, 0},
+                .dst_offset = {0, 0, 0},
+                .extent = {mip_extent(texture.info.width, mip_level), mip_extent(texture.info.height, mip_level), 1},
+            });
+        }
+        command_buffer.cmd_image_memory_transition_barrier({
+            .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dst_stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            .dst_access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+            .src_layout = VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .dst_layout = VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .base_mip_level = copied_base_level,
+            .level_count = mip_level_count - new_first_mip - copied_base_level,
+            .aspect_mask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT,
+            .image_id = new_image,
+        });
+
+        texture_entry.runtime = new_image;
+        texture.resident_mip = new_first_mip;
+        texture.target_mip = new_first_mip;
+        texture.loading = false;
+        retired_images.push_back(old_image);
+        for (auto const & material_using_texture : texture_entry.material_manifest_indices)
+        {
+            if (std::find(dirty_material_indices.begin(), dirty_material_indices.end(), material_using_texture.material_manifest_index) == dirty_material_indices.end())
+            {
+                dirty_material_indices.push_back(material_using_texture.material_manifest_index);
+            }
+        }
+    }
+    if (!dirty_material_indices.empty())
+    {
+        std::optional<ff::StagingAllocation> const material_staging = _device->allocate_staging(sizeof(MaterialDescriptor) * dirty_material_indices.size());
+        if (!material_staging.has_value())
+        {
+            APP_LOG("[ERROR][TextureStreamer::update()] Failed to allocate staging memory for the material descriptors");
+            throw std::runtime_error("[ERROR][TextureStreamer::update()] Failed to allocate staging memory");
+        }
+        scene.record_material_descriptor_updates(command_buffer, material_staging.value(), dirty_material_indices);
+        command_buffer.cmd_memory_barrier({
+            .src_stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dst_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dst_access = VK_ACCESS_2_MEMORY_READ_BIT,
+        });
+    }
+    command_buffer.end();
+    auto recorded_command_buffer = command_buffer.get_recorded_command_buffer();
+    // Already signaled, the wait orders the acquire after the release as the specification requires
+    ff::TimelineSemaphoreInfo transfer_timeline = {
+        .semaphore = _device->get_last_submit_timeline(ff::QueueType::TRANSFER).semaphore,
+        .value = acquired_transfer_value,
+    };
+    bool const waits_on_transfer = acquired_transfer_value != 0 && _device->has_dedicated_queue(ff::QueueType::TRANSFER);
+    _device->submit({
+        .command_buffers = {&recorded_command_buffer, 1},
+        .wait_timeline_semaphores = {&transfer_timeline, waits_on_transfer ? 1u : 0u},
+    });
+    /// NOTE: Destroying after the submit retires the old images once the copies out of them are done.
+    for (ff::ImageId const retired_image : retired_images)
+    {
+        _device->destroy_image(retired_image);
+    }
+    APP_LOG(fmt::format("[INFO][TextureStreamer::update()] Changed residency of {} textures, {:.2f} / {:.2f} MiB resident",
+                        residency_changes.size(),
+                        static_cast<f32>(_statistics.resident_bytes) / (1024.0f * 1024.0f),
+                        static_cast<f32>(_info.vram_budget) / (1024.0f * 1024.0f)));
+#pragma endregion
+}
+
+void TextureStreamer::set_mip_bias(f32 mip_bias)
+{
+    _info.mip_bias = mip_bias;
+}
+
+auto TextureStreamer::get_statistics() const -> TextureStreamingStatistics
+{
+    return _statistics;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+
+#include "../fairy_forest.hpp"
+#include "../backend/backend.hpp"
+#include "scene.hpp"
+
+using namespace ff::types;
+
+struct TextureStreamerInfo
+{
+    // Device memory all streamed textures may take together, their always resident mip tails included
+    usize vram_budget = 512ull * 1024ull * 1024ull;
+    // Mips no larger than this in both dimensions are uploaded with the scene and are never evicted
+    u32 mip_tail_extent = 128;
+    // Bounds the staging memory and the copies recorded by a single update()
+    usize max_upload_bytes_per_update = 32ull * 1024ull * 1024ull;
+    // Added to the mip requested by the feedback, must match the lod bias of the material sampler
+    f32 mip_bias = -1.0f;
+    u32 loader_thread_count = 2;
+};
+
+// A texture that has its full mip chain in CPU memory and only the mip tail uploaded
+struct StreamedTextureInfo
+{
+    u32 texture_manifest_index = {};
+    VkFormat format = {};
+    u32 width = {};
+    u32 height = {};
+    u32 mip_level_count = {};
+    // First mip of the uploaded tail, the runtime image holds mips [resident_mip, mip_level_count)
+    u32 resident_mip = {};
+    // Tightly packed texels of all mips. Either owns them or points into memory that outlives the streamer.
+    std::vector<std::byte> texels = {};
+    std::span<std::byte const> mapped_texels = {};
+    std::vector<usize> mip_offsets = {};
+};
+
+struct TextureStreamingStatistics
+{
+    u32 streamed_texture_count = {};
+    // Bytes of the streamed textures currently resident on the GPU
+    usize resident_bytes = {};
+    usize vram_budget = {};
+    // Accumulated since the streamer was created
+    u32 loaded_mip_count = {};
+    u32 evicted_mip_count = {};
+    usize uploaded_bytes = {};
+};
+
+/// NOTE: Textures start with only their mip tail resident so that the first frame does not wait for full resolution
+//        uploads. Every update() reads the per material texel density the prepass wrote a few frames earlier and
+//        derives the mip each texture needs. Missing mips are copied out of the CPU side texels on the loader
+//        threads, which is where the page faults of the mapped scene cache are taken. Finished loads are
+//        uploaded into a reallocated texture with the new mip range on the transfer queue, so the copies run
+//        alongside the frames. A later update() acquires the texture on the main queue once the transfer
+//        finished and copies the mips the old image already had on the GPU. When a load would exceed the budget
+//        the least recently requested top mips of other textures are evicted the same way, on the main queue
+//        only. The new image ids are written into the material descriptors, the old images are destroyed once
+//        the GPU is done with them.
+struct TextureStreamer
+{
+  public:
+    TextureStreamer(std::shared_ptr<ff::Device> device, TextureStreamerInfo const & info = {});
+    TextureStreamer(TextureStreamer const &) = delete;
+    TextureStreamer & operator=(TextureStreamer const &) = delete;
+    ~TextureStreamer();
+
+    // First mip of the tail that is uploaded with the scene, returns 0 when the whole texture fits into the tail
+    auto get_mip_tail_start(u32 width, u32 height, u32 mip_level_count) const -> u32;
+    // Must be called before the first update(), the runtime image of the texture must already hold the mip tail
+    void add_texture(StreamedTextureInfo && info);
+    // Records and submits the uploads and evictions, feedback is indexed by the material manifest index
+    void update(Scene & scene, std::span<TextureFeedback const> feedback);
+    // Called whenever the lod bias of the material sampler changes, applies from the next update()
+    void set_mip_bias(f32 mip_bias);
+    auto get_statistics() const -> TextureStreamingStatistics;
+
+  private:
+    struct StreamedTexture
+    {
+        StreamedTextureInfo info = {};
+        // First mip of the tail, never evicted
+        u32 tail_mip = {};
+        // Mips [resident_mip, mip_level_count) are in the runtime image
+        u32 resident_mip = {};
+        // Mip the runtime image will start at after the current update()
+        u32 target_mip = {};
+        // Finest mip whose texels fit into a single update
+        u32 min_mip = {};
+        // Finest mip requested by the feedback in the current update()
+        u32 requested_mip = {};
+        // Update index of the last feedback that needed the mip
+        std::vector<u64> mip_last_used = {};
+        // No new loads are issued before this update index, set when the budget could not fit a load
+        u64 retry_update_index = {};
+        bool loading = {};
+
+        auto get_texels() const -> std::span<std::byte const>
+        {
+            return info.texels.empty() ? info.mapped_texels : std::span<std::byte const>(info.texels);
+        }
+    };
+
+    struct LoadRequest
+    {
+        u32 streamed_texture_index = {};
+        // Loads mips [first_mip, end_mip)
+        u32 first_mip = {};
+        u32 end_mip = {};
+        std::span<std::byte const> src_texels = {};
+    };
+
+    struct LoadedMips
+    {
+        LoadRequest request = {};
+        std::vector<std::byte> texels = {};
+    };
+
+    // New image of a texture whose loaded mips were submitted to the transfer queue
+    struct PendingUpload
+    {
+        u32 streamed_texture_index = {};
+        u32 new_first_mip = {};
+        ff::ImageId image = {};
+        u64 transfer_timeline_value = {};
+    };
+
+    struct ResidencyChange
+    {
+        u32 streamed_texture_index = {};
+        u32 new_first_mip = {};
+        // Set when the loaded mips are already in the image, the texture is evicting mips otherwise
+        std::optional<ff::ImageId> uploaded_image = {};
+    };
+
+    std::shared_ptr<ff::Device> _device = {};
+    TextureStreamerInfo _info = {};
+    std::vector<StreamedTexture> _textures = {};
+    // Streamed texture index of each texture manifest entry
+    std::vector<std::optional<u32>> _streamed_texture_indices = {};
+    std::vector<PendingUpload> _pending_uploads = {};
+    u64 _update_index = {};
+    TextureStreamingStatistics _statistics = {};
+
+    std::vector<std::thread> _loader_threads = {};
+    std::mutex _loader_mutex = {};
+    std::condition_variable _loader_condition = {};
+    std::deque<LoadRequest> _load_requests = {};
+    std::deque<LoadedMips> _loaded_mips = {};
+    bool _exit_loaders = {};
+
+    auto mip_byte_size(StreamedTexture const & texture, u32 mip_level) const -> usize;
+    void loader_main();
+};
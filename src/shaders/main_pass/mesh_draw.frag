@@ -2,6 +2,7 @@
 #extension GL_GOOGLE_include_directive : require
 #include "src/shared/shared.inl"
 #include "src/shaders/util/normals_compress.glsl"
+#include "src/shaders/util/virtual_shadows.glsl"
 
 
 layout(location = 0) in f32vec2 in_uv;
@@ -36,17 +37,8 @@ f32vec3 point_lights_contribution(f32vec3 normal, f32vec3 world_position, f32vec
     return total_contribution;
 }
 
-void main()
+f32 esm_shadow()
 {
-    f32vec4 albedo = f32vec4(1.0);
-    if (albedo_index != -1)
-    {
-        albedo = texture(sampler2D(texture2DTable[albedo_index], samplerTable[pc.sampler_id]), in_uv);
-    }
-
-    out_motion_vector = f32vec4(in_motion_vector, 0.0, 0.0);
-    const f32 depth = gl_FragCoord.z;
-
     // Get the cascade index of the current fragment
     u32 cascade_idx = 0;
     for(cascade_idx; cascade_idx < NUM_CASCADES; cascade_idx++)
@@ -104,6 +96,30 @@ void main()
         const f32 tmp1 = mix(shadow_gathered.x, shadow_gathered.y, blend_factor.x);
         shadow = mix(tmp0, tmp1, blend_factor.y);
     }
+    return shadow;
+}
+
+void main()
+{
+    f32vec4 albedo = f32vec4(1.0);
+    if (albedo_index != -1)
+    {
+        albedo = texture(sampler2D(texture2DTable[albedo_index], samplerTable[pc.sampler_id]), in_uv);
+    }
+
+    out_motion_vector = f32vec4(in_motion_vector, 0.0, 0.0);
+    const f32 depth = gl_FragCoord.z;
+
+    f32 shadow = 1.0;
+    if (pc.virtual_shadows == 1)
+    {
+        const f32vec3 camera_position = (CameraInfoBuf(pc.camera_info)[pc.fif_index]).position;
+        shadow = vsm_shadow(pc.vsm_clip_levels, pc.vsm_page_table, pc.vsm_physical_texels, world_position, camera_position);
+    }
+    else
+    {
+        shadow = esm_shadow();
+    }
 
     const u32 world_normal_compressed = texelFetch(utexture2DTable[pc.ss_normals_index], i32vec2(gl_FragCoord.xy), 0).r;
     const f32vec3 world_normal = u16_to_nrm(world_normal_compressed);
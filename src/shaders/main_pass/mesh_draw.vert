@@ -1,13 +1,12 @@
 #version 450
 #extension GL_GOOGLE_include_directive : require
 #include "src/shared/shared.inl"
+#include "src/shaders/util/vertex_fetch.glsl"
 
 layout(push_constant, scalar) uniform pc { DrawPc data; };
 
 layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Transform { f32mat4x3 trans;  };
 layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Index     { u32 idx;          };
-layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Position  { f32vec3 position; };
-layout(buffer_reference, scalar, buffer_reference_align = 4) buffer UV        { f32vec2 uv;       };
 
 layout(location = 0) out f32vec2 out_uv;
 layout(location = 1) out flat u32 albedo_index;
@@ -28,16 +27,18 @@ mat4 mat_4x3_to_4x4(mat4x3 in_mat)
 void main()
 {
     const u32 vert_index = gl_VertexIndex;
-    const u32 instance = gl_InstanceIndex;
+    // Instances of indirect draws index into the visible instances written by the culling pass
+    const VisibleInstance visible_instance = VisibleInstance(data.visible_instances)[gl_InstanceIndex];
+    const u32 mesh_index = visible_instance.mesh_index;
 
     SceneDescriptor scene_descriptor = SceneDescriptor(data.scene_descriptor);
-    MeshDescriptor mesh_descriptor = MeshDescriptor(scene_descriptor.mesh_descriptors_start)[data.mesh_index];
+    MeshDescriptor mesh_descriptor = MeshDescriptor(scene_descriptor.mesh_descriptors_start)[mesh_index];
     MaterialDescriptor material_descriptor = MaterialDescriptor(scene_descriptor.material_descriptors_start)[mesh_descriptor.material_index];
 
-    const f32mat4x3 transform = (Transform(scene_descriptor.transforms_start)[mesh_descriptor.transforms_offset + instance]).trans;
+    const f32mat4x3 transform = (Transform(scene_descriptor.transforms_start)[visible_instance.transform_index]).trans;
 
-    const f32vec3 position = (Position(scene_descriptor.positions_start)[mesh_descriptor.positions_offset + vert_index]).position;
-    const f32vec2 uv = (UV(scene_descriptor.uvs_start)[mesh_descriptor.uvs_offset + vert_index]).uv;
+    const f32vec3 position = fetch_position(scene_descriptor, mesh_descriptor, vert_index);
+    const f32vec2 uv = fetch_uv(scene_descriptor, mesh_descriptor, vert_index);
 
     albedo_index = material_descriptor.albedo_index;
     out_uv = uv;
@@ -1,21 +1,19 @@
 #version 450
 #extension GL_GOOGLE_include_directive : require
 #include "src/shared/shared.inl"
+#include "src/shaders/util/vertex_fetch.glsl"
 
 layout(push_constant, scalar) uniform pc { DrawPc data; };
 
 layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Transform { f32mat4x3 trans;  };
 layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Index     { u32 idx;          };
-layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Position  { f32vec3 position; };
-layout(buffer_reference, scalar, buffer_reference_align = 4) buffer UV        { f32vec2 uv;       };
-layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Tangent   { f32vec4 tangent;  };
-layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Normal    { f32vec3 normal;  };
 
 layout(location = 0) out f32vec2 out_uv;
 layout(location = 1) out f32vec4 out_tangent;
 layout(location = 2) out f32vec3 out_normal;
 layout(location = 3) out flat u32 albedo_index;
 layout(location = 4) out flat u32 normals_index;
+layout(location = 5) out flat u32 material_index;
 
 mat4 mat_4x3_to_4x4(mat4x3 in_mat)
 {
@@ -30,21 +28,24 @@ mat4 mat_4x3_to_4x4(mat4x3 in_mat)
 void main()
 {
     const u32 vert_index = gl_VertexIndex;
-    const u32 instance = gl_InstanceIndex;
+    // Instances of indirect draws index into the visible instances written by the culling pass
+    const VisibleInstance visible_instance = VisibleInstance(data.visible_instances)[gl_InstanceIndex];
+    const u32 mesh_index = visible_instance.mesh_index;
 
     SceneDescriptor scene_descriptor = SceneDescriptor(data.scene_descriptor);
-    MeshDescriptor mesh_descriptor = MeshDescriptor(scene_descriptor.mesh_descriptors_start)[data.mesh_index];
+    MeshDescriptor mesh_descriptor = MeshDescriptor(scene_descriptor.mesh_descriptors_start)[mesh_index];
     MaterialDescriptor material_descriptor = MaterialDescriptor(scene_descriptor.material_descriptors_start)[mesh_descriptor.material_index];
 
-    const f32mat4x3 transform = (Transform(scene_descriptor.transforms_start)[mesh_descriptor.transforms_offset + instance]).trans;
+    const f32mat4x3 transform = (Transform(scene_descriptor.transforms_start)[visible_instance.transform_index]).trans;
 
-    const f32vec3 position = (Position(scene_descriptor.positions_start)[mesh_descriptor.positions_offset + vert_index]).position;
-    const f32vec2 uv = (UV(scene_descriptor.uvs_start)[mesh_descriptor.uvs_offset + vert_index]).uv;
-    const f32vec4 tangent = (Tangent(scene_descriptor.tangents_start)[mesh_descriptor.tangents_offset + vert_index]).tangent;
-    const f32vec3 normal = (Normal(scene_descriptor.normals_start)[mesh_descriptor.normals_offset + vert_index]).normal;
+    const f32vec3 position = fetch_position(scene_descriptor, mesh_descriptor, vert_index);
+    const f32vec2 uv = fetch_uv(scene_descriptor, mesh_descriptor, vert_index);
+    const f32vec4 tangent = fetch_tangent(scene_descriptor, mesh_descriptor, vert_index);
+    const f32vec3 normal = fetch_normal(scene_descriptor, mesh_descriptor, vert_index);
 
     normals_index = material_descriptor.normal_index;
     albedo_index = material_descriptor.albedo_index;
+    material_index = mesh_descriptor.material_index;
     out_uv = uv;
     out_tangent = f32vec4(normalize((mat_4x3_to_4x4(transform) * f32vec4(tangent.xyz, 0.0)).xyz), tangent.w);
     out_normal = normalize((mat_4x3_to_4x4(transform) * f32vec4(normal.xyz, 0.0)).xyz);
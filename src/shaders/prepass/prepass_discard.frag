@@ -2,12 +2,14 @@
 #extension GL_GOOGLE_include_directive : require
 #include "src/shared/shared.inl"
 #include "src/shaders/util/normals_compress.glsl"
+#include "src/shaders/util/texture_feedback.glsl"
 
 layout(location = 0) in f32vec2 in_uv;
 layout(location = 1) in f32vec4 in_tangent;
 layout(location = 2) in f32vec3 in_normal;
 layout(location = 3) in flat u32 albedo_index;
 layout(location = 4) in flat u32 normals_index;
+layout(location = 5) in flat u32 material_index;
 
 layout(location = 0) out u32vec4 compressed_normal;
 
@@ -15,6 +17,7 @@ layout(push_constant, scalar) uniform push { DrawPc pc; };
 
 void main()
 {
+    write_texture_feedback(pc.texture_feedback, material_index, in_uv);
     f32vec4 albedo = f32vec4(1.0);
     if (albedo_index != -1)
     {
@@ -24,8 +27,9 @@ void main()
     {
         discard;
     }
-    const f32vec3 normal = texture(sampler2D(texture2DTable[normals_index], samplerTable[pc.sampler_id]), in_uv).rgb;
-    const f32vec3 rescaled_normal = normal * 2.0 - 1.0;
+    // BC5 normal maps only store x and y, z of a tangent space normal is always positive
+    const f32vec2 normal_xy = texture(sampler2D(texture2DTable[normals_index], samplerTable[pc.sampler_id]), in_uv).rg * 2.0 - 1.0;
+    const f32vec3 rescaled_normal = f32vec3(normal_xy, sqrt(max(1.0 - dot(normal_xy, normal_xy), 0.0)));
                 
     const f32vec3 norm_in_tangent = normalize(in_tangent.xyz);
     const f32vec3 norm_in_normal = normalize(in_normal.xyz);
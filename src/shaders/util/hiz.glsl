@@ -0,0 +1,27 @@
+// Hi-Z pyramid addressing, see HizTexel in shared.inl for the layout
+u32vec2 hiz_level_size(u32vec2 depth_dimensions, u32 level)
+{
+    const u32vec2 level_texel_footprint = u32vec2(2u << level);
+    return max((depth_dimensions + level_texel_footprint - 1) / level_texel_footprint, u32vec2(1));
+}
+
+u32 hiz_level_offset(u32vec2 depth_dimensions, u32 level)
+{
+    u32 offset = 0;
+    for (u32 prev_level = 0; prev_level < level; prev_level++)
+    {
+        const u32vec2 prev_level_size = hiz_level_size(depth_dimensions, prev_level);
+        offset += prev_level_size.x * prev_level_size.y;
+    }
+    return offset;
+}
+
+u32 hiz_level_count(u32vec2 depth_dimensions)
+{
+    u32 level = 0;
+    while (any(greaterThan(hiz_level_size(depth_dimensions, level), u32vec2(1))))
+    {
+        level++;
+    }
+    return level + 1;
+}
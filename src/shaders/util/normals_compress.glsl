@@ -17,6 +17,19 @@ uint octahedral_16(in vec3 nor) {
     nor.xy = (nor.z >= 0.0) ? nor.xy : (1.0 - abs(nor.yx)) * msign(nor.xy);
     return packSnorm2x8(nor.xy);
 }
+uint octahedral_32(in vec3 nor) {
+    nor /= (abs(nor.x) + abs(nor.y) + abs(nor.z));
+    nor.xy = (nor.z >= 0.0) ? nor.xy : (1.0 - abs(nor.yx)) * msign(nor.xy);
+    return packSnorm2x16(nor.xy);
+}
+vec3 i_octahedral_32(uint data) {
+    vec2 v = unpackSnorm2x16(data);
+    vec3 nor = vec3(v, 1.0 - abs(v.x) - abs(v.y));
+    float t = max(-nor.z, 0.0);
+    nor.x += (nor.x > 0.0) ? -t : t;
+    nor.y += (nor.y > 0.0) ? -t : t;
+    return nor;
+}
 vec3 i_octahedral_16(uint data) {
     vec2 v = unpackSnorm2x8(data);
     vec3 nor = vec3(v, 1.0 - abs(v.x) - abs(v.y));
@@ -0,0 +1,19 @@
+// True when the [rect_min, rect_max) texels of the cascade overlap any of its dirty rects grown by growth texels.
+// The esm passes read ESM_BLUR_RADIUS texels past the ones they write, every pass before the last one has to
+// cover the dirty rects grown by the radius of all the passes after it.
+bool shadow_cache_is_dirty(ShadowCascadeCache cache, i32vec2 rect_min, i32vec2 rect_max, i32 growth)
+{
+    for (u32 rect_index = 0; rect_index < SHADOW_CACHE_DIRTY_RECT_COUNT; rect_index++)
+    {
+        const i32vec4 dirty_rect = cache.dirty_rects[rect_index];
+        if (any(greaterThanEqual(dirty_rect.xy, dirty_rect.zw)))
+        {
+            continue;
+        }
+        if (all(lessThan(rect_min, dirty_rect.zw + growth)) && all(greaterThan(rect_max, dirty_rect.xy - growth)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
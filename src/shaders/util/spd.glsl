@@ -0,0 +1,113 @@
+// Single pass downsampler, reduces up to 2 * SPD_TILE_LEVEL_COUNT levels in one dispatch of SPD_WORKGROUP_SIZE
+// threads per workgroup. The includer defines SPD_VALUE and the following before including this file:
+//     u32vec2 spd_level_size(u32 level)
+//     SPD_VALUE spd_load(u32 level, u32vec2 texel)                    texel is always inside of the level
+//     void spd_store(u32 level, u32vec2 texel, SPD_VALUE value)
+//     SPD_VALUE spd_reduce(SPD_VALUE v0, SPD_VALUE v1, SPD_VALUE v2, SPD_VALUE v3)
+// The last workgroup reads levels other workgroups stored, loads and stores of them have to be coherent.
+
+shared SPD_VALUE spd_shared_values[2][(SPD_TILE_SIZE / 4) * (SPD_TILE_SIZE / 4)];
+shared bool spd_is_last_workgroup;
+
+// Texels of the finer level that the texel of the coarser one covers. Clamping to the edge of the finer level
+// duplicates its last row and column, which drops the odd texel of levels that halve with rounding down and
+// ignores the missing texel of levels that halve with rounding up.
+u32vec2 spd_child_texel(u32vec2 texel, u32 child, u32 child_level)
+{
+    return min(texel * 2 + u32vec2(child % 2, child / 2), spd_level_size(child_level) - 1);
+}
+
+// Every thread first reduces a 2x2 block of level base_level + 1 straight from memory, then the block itself.
+// The remaining levels of the tile are reduced in shared memory by fewer and fewer threads.
+void spd_downsample_tile(u32 base_level, u32 level_count, u32vec2 tile)
+{
+    const u32 thread_index = gl_LocalInvocationIndex;
+    u32 level_tile_size = SPD_TILE_SIZE / 4;
+    const u32vec2 local_texel = u32vec2(thread_index % level_tile_size, thread_index / level_tile_size);
+    const u32vec2 block_texel = tile * level_tile_size + local_texel;
+
+    const u32vec2 first_level_size = spd_level_size(base_level + 1);
+    SPD_VALUE block[4];
+    for (u32 block_index = 0; block_index < 4; block_index++)
+    {
+        const u32vec2 texel = block_texel * 2 + u32vec2(block_index % 2, block_index / 2);
+        block[block_index] = spd_reduce(
+            spd_load(base_level, spd_child_texel(texel, 0, base_level)),
+            spd_load(base_level, spd_child_texel(texel, 1, base_level)),
+            spd_load(base_level, spd_child_texel(texel, 2, base_level)),
+            spd_load(base_level, spd_child_texel(texel, 3, base_level)));
+        if (all(lessThan(texel, first_level_size)))
+        {
+            spd_store(base_level + 1, texel, block[block_index]);
+        }
+    }
+    if (level_count == 1)
+    {
+        return;
+    }
+
+    const bool block_texel_valid = all(lessThan(block_texel, spd_level_size(base_level + 2)));
+    // Clamped children of a valid texel stay inside of its block
+    const u32vec2 last_child = block_texel_valid ? min(block_texel * 2 + 1, first_level_size - 1) - block_texel * 2 : u32vec2(1);
+    SPD_VALUE value = spd_reduce(block[0], block[last_child.x], block[last_child.y * 2], block[last_child.y * 2 + last_child.x]);
+    if (block_texel_valid)
+    {
+        spd_store(base_level + 2, block_texel, value);
+    }
+    spd_shared_values[0][thread_index] = value;
+
+    u32 src_values = 0;
+    for (u32 level = base_level + 3; level <= base_level + level_count; level++)
+    {
+        barrier();
+        level_tile_size /= 2;
+        if (thread_index < level_tile_size * level_tile_size)
+        {
+            const u32vec2 local = u32vec2(thread_index % level_tile_size, thread_index / level_tile_size);
+            const u32vec2 texel = tile * level_tile_size + local;
+            if (all(lessThan(texel, spd_level_size(level))))
+            {
+                const u32vec2 child_tile_origin = tile * level_tile_size * 2;
+                SPD_VALUE children[4];
+                for (u32 child = 0; child < 4; child++)
+                {
+                    const u32vec2 child_local = spd_child_texel(texel, child, level - 1) - child_tile_origin;
+                    children[child] = spd_shared_values[src_values][child_local.y * level_tile_size * 2 + child_local.x];
+                }
+                value = spd_reduce(children[0], children[1], children[2], children[3]);
+                spd_store(level, texel, value);
+                spd_shared_values[1 - src_values][local.y * level_tile_size + local.x] = value;
+            }
+        }
+        src_values = 1 - src_values;
+    }
+}
+
+// Produces levels [base_level + 1, base_level + level_count], the workgroup id selects the tile of base_level.
+// More than SPD_TILE_LEVEL_COUNT levels require base_level to fit into SPD_TILE_SIZE tiles along both axes.
+void spd_downsample(u32 base_level, u32 level_count, u32vec2 tile, u32 tile_count, SpdCounter counter)
+{
+    spd_downsample_tile(base_level, min(level_count, SPD_TILE_LEVEL_COUNT), tile);
+    if (level_count <= SPD_TILE_LEVEL_COUNT)
+    {
+        return;
+    }
+
+    memoryBarrierBuffer();
+    barrier();
+    if (gl_LocalInvocationIndex == 0)
+    {
+        spd_is_last_workgroup = atomicAdd(counter.finished_workgroups, 1) == tile_count - 1;
+        if (spd_is_last_workgroup)
+        {
+            counter.finished_workgroups = 0;
+        }
+    }
+    barrier();
+    if (!spd_is_last_workgroup)
+    {
+        return;
+    }
+    // All tiles ended on a single texel each, together they are a single tile of the next level
+    spd_downsample_tile(base_level + SPD_TILE_LEVEL_COUNT, level_count - SPD_TILE_LEVEL_COUNT, u32vec2(0));
+}
@@ -0,0 +1,21 @@
+// Texture streaming feedback, see TextureFeedback in shared.inl
+// Must be called from uniform control flow as it takes the derivatives of uv
+void write_texture_feedback(VkDeviceAddress texture_feedback, u32 material_index, f32vec2 uv)
+{
+    const f32 dx_length = length(dFdx(uv));
+    const f32 dy_length = length(dFdy(uv));
+    const u32vec2 pixel = u32vec2(gl_FragCoord.xy);
+    if (any(notEqual(pixel % TEXTURE_FEEDBACK_PIXEL_STRIDE, u32vec2(0))))
+    {
+        return;
+    }
+    // Anisotropic filtering takes the mip from the minor axis of the footprint, up to the max anisotropy
+    const f32 footprint = max(min(dx_length, dy_length), max(dx_length, dy_length) / TEXTURE_FEEDBACK_MAX_ANISOTROPY);
+    const u32 density = u32(min(1.0 / max(footprint, 1.0 / f32(TEXTURE_FEEDBACK_MAX_DENSITY)), f32(TEXTURE_FEEDBACK_MAX_DENSITY)));
+    TextureFeedback feedback = TextureFeedback(texture_feedback)[material_index];
+    // Most pixels of a material request the same density, skip the atomic once it was reached
+    if (density > feedback.max_density)
+    {
+        atomicMax(feedback.max_density, density);
+    }
+}
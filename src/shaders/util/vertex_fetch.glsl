@@ -0,0 +1,55 @@
+#include "src/shaders/util/normals_compress.glsl"
+
+// Uncompressed streams, VERTEX_FORMAT_FULL
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Position { f32vec3 position; };
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer UV       { f32vec2 uv;       };
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Tangent  { f32vec4 tangent;  };
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Normal   { f32vec3 normal;   };
+
+// Compressed streams, VERTEX_FORMAT_COMPRESSED
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer CompressedPosition { u32vec2 position; };
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer CompressedAttribute { u32 attribute; };
+
+f32vec3 fetch_position(SceneDescriptor scene_descriptor, MeshDescriptor mesh_descriptor, u32 vert_index)
+{
+    const u32 index = mesh_descriptor.positions_offset + vert_index;
+    if (scene_descriptor.vertex_format == VERTEX_FORMAT_COMPRESSED)
+    {
+        const u32vec2 packed = CompressedPosition(scene_descriptor.positions_start)[index].position;
+        const f32vec3 normalized = f32vec3(unpackUnorm2x16(packed.x), unpackUnorm2x16(packed.y).x);
+        return mesh_descriptor.position_min + normalized * mesh_descriptor.position_extent;
+    }
+    return Position(scene_descriptor.positions_start)[index].position;
+}
+
+f32vec2 fetch_uv(SceneDescriptor scene_descriptor, MeshDescriptor mesh_descriptor, u32 vert_index)
+{
+    const u32 index = mesh_descriptor.uvs_offset + vert_index;
+    if (scene_descriptor.vertex_format == VERTEX_FORMAT_COMPRESSED)
+    {
+        return unpackHalf2x16(CompressedAttribute(scene_descriptor.uvs_start)[index].attribute);
+    }
+    return UV(scene_descriptor.uvs_start)[index].uv;
+}
+
+f32vec3 fetch_normal(SceneDescriptor scene_descriptor, MeshDescriptor mesh_descriptor, u32 vert_index)
+{
+    const u32 index = mesh_descriptor.normals_offset + vert_index;
+    if (scene_descriptor.vertex_format == VERTEX_FORMAT_COMPRESSED)
+    {
+        return normalize(i_octahedral_32(CompressedAttribute(scene_descriptor.normals_start)[index].attribute));
+    }
+    return Normal(scene_descriptor.normals_start)[index].normal;
+}
+
+// The w component is the sign of the bitangent
+f32vec4 fetch_tangent(SceneDescriptor scene_descriptor, MeshDescriptor mesh_descriptor, u32 vert_index)
+{
+    const u32 index = mesh_descriptor.tangents_offset + vert_index;
+    if (scene_descriptor.vertex_format == VERTEX_FORMAT_COMPRESSED)
+    {
+        const u32 packed = CompressedAttribute(scene_descriptor.tangents_start)[index].attribute;
+        return f32vec4(normalize(i_octahedral_32(packed)), (packed & 1u) != 0 ? -1.0 : 1.0);
+    }
+    return Tangent(scene_descriptor.tangents_start)[index].tangent;
+}
@@ -0,0 +1,85 @@
+// Virtual shadow map addressing, see VsmClipLevel in shared.inl
+
+// Finest clip level which covers the world position, VSM_CLIP_LEVEL_COUNT when it is outside of all of them
+u32 vsm_clip_level(f32vec3 world_position, f32vec3 camera_position)
+{
+    const f32 distance = max(length(world_position - camera_position), 1e-4);
+    return u32(clamp(ceil(log2(distance / VSM_FIRST_LEVEL_RADIUS)), 0.0, f32(VSM_CLIP_LEVEL_COUNT)));
+}
+
+// Virtual texel of the clip level in xy and the depth in z
+f32vec3 vsm_virtual_position(VsmClipLevel clip_level, f32vec3 world_position)
+{
+    const f32vec4 ndc_position = clip_level.projection * clip_level.view * f32vec4(world_position, 1.0);
+    return f32vec3((ndc_position.xy * 0.5 + 0.5) * f32(VSM_VIRTUAL_RESOLUTION), ndc_position.z);
+}
+
+// Slot of the page in the page table, the page coordinates wrap around the level so that a page keeps its slot
+// while the level scrolls
+u32 vsm_page_entry_index(u32 clip_level, i32vec2 origin_page, u32vec2 level_page)
+{
+    const i32vec2 wrapped_page = (origin_page + i32vec2(level_page)) & (VSM_PAGE_TABLE_RESOLUTION - 1);
+    return (clip_level * VSM_PAGE_TABLE_RESOLUTION + wrapped_page.y) * VSM_PAGE_TABLE_RESOLUTION + wrapped_page.x;
+}
+
+// Page of the level which the slot holds
+i32vec2 vsm_slot_page(i32vec2 origin_page, u32vec2 slot)
+{
+    return origin_page + ((i32vec2(slot) - origin_page) & (VSM_PAGE_TABLE_RESOLUTION - 1));
+}
+
+u32 vsm_physical_texel_index(u32 entry, u32vec2 virtual_texel)
+{
+    const u32 physical_page = entry & VSM_PAGE_PHYSICAL_MASK;
+    const u32vec2 page_texel = virtual_texel % VSM_PAGE_SIZE;
+    return (physical_page * VSM_PAGE_SIZE + page_texel.y) * VSM_PAGE_SIZE + page_texel.x;
+}
+
+/// NOTE: The virtual shadow pass has no attachments, fragments write their depth straight into the physical page of
+//        their virtual texel. Only dirty pages are written, cached pages already hold the depth of all casters.
+void vsm_store_depth(VkDeviceAddress clip_levels, VkDeviceAddress page_table, VkDeviceAddress physical_texels, u32 clip_level_index, f32vec3 frag_coord)
+{
+    const u32vec2 virtual_texel = u32vec2(frag_coord.xy);
+    const i32vec2 origin_page = (VsmClipLevel(clip_levels)[clip_level_index]).origin_page;
+    const u32 entry = (VsmPageTableEntry(page_table)[vsm_page_entry_index(clip_level_index, origin_page, virtual_texel / VSM_PAGE_SIZE)]).entry;
+    if ((entry & VSM_PAGE_DIRTY) == 0)
+    {
+        return;
+    }
+    const u32 depth = floatBitsToUint(clamp(frag_coord.z, 0.0, 1.0));
+    atomicMin((VsmPhysicalTexel(physical_texels)[vsm_physical_texel_index(entry, virtual_texel)]).depth, depth);
+}
+
+/// NOTE: 2x2 percentage closer filtering, every tap looks up its own page. The depth bias is a fixed number of texels
+//        of the level so that it grows with the texels.
+f32 vsm_shadow(VkDeviceAddress clip_levels, VkDeviceAddress page_table, VkDeviceAddress physical_texels, f32vec3 world_position, f32vec3 camera_position)
+{
+    const u32 clip_level_index = vsm_clip_level(world_position, camera_position);
+    if (clip_level_index >= VSM_CLIP_LEVEL_COUNT)
+    {
+        return 1.0;
+    }
+    VsmClipLevel clip_level = VsmClipLevel(clip_levels)[clip_level_index];
+    const f32vec3 virtual_position = vsm_virtual_position(clip_level, world_position);
+    const f32 texel_size = 2.0 / (clip_level.projection[0][0] * f32(VSM_VIRTUAL_RESOLUTION));
+    const f32 depth_bias = VSM_DEPTH_BIAS_TEXELS * texel_size * clip_level.projection[2][2];
+
+    const f32vec2 footprint = virtual_position.xy - 0.5;
+    const i32vec2 footprint_min = i32vec2(floor(footprint));
+    const f32vec2 blend_factor = footprint - f32vec2(footprint_min);
+    f32 lit[4];
+    for (u32 tap = 0; tap < 4; tap++)
+    {
+        const u32vec2 texel = u32vec2(clamp(footprint_min + i32vec2(tap % 2, tap / 2), 0, VSM_VIRTUAL_RESOLUTION - 1));
+        const u32 entry = (VsmPageTableEntry(page_table)[vsm_page_entry_index(clip_level_index, clip_level.origin_page, texel / VSM_PAGE_SIZE)]).entry;
+        // Only when the physical pool ran out
+        if ((entry & VSM_PAGE_ALLOCATED) == 0)
+        {
+            lit[tap] = 1.0;
+            continue;
+        }
+        const f32 occluder_depth = uintBitsToFloat((VsmPhysicalTexel(physical_texels)[vsm_physical_texel_index(entry, texel)]).depth);
+        lit[tap] = virtual_position.z - depth_bias <= occluder_depth ? 1.0 : 0.0;
+    }
+    return mix(mix(lit[0], lit[1], blend_factor.x), mix(lit[2], lit[3], blend_factor.x), blend_factor.y);
+}
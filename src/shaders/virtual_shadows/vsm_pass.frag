@@ -0,0 +1,13 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#include "src/shared/shared.inl"
+#include "src/shaders/util/virtual_shadows.glsl"
+layout(location = 0) in f32vec2 in_uv;
+layout(location = 1) in flat u32 albedo_index;
+
+layout(push_constant, scalar) uniform push { VsmPassPC pc; };
+
+void main()
+{
+    vsm_store_depth(pc.clip_levels, pc.page_table, pc.physical_texels, pc.clip_level, gl_FragCoord.xyz);
+}
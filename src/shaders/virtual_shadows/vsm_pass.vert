@@ -0,0 +1,45 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#include "src/shared/shared.inl"
+#include "src/shaders/util/vertex_fetch.glsl"
+
+layout(push_constant, scalar) uniform push { VsmPassPC pc; };
+
+layout(buffer_reference, scalar, buffer_reference_align = 4) buffer Transform { f32mat4x3 trans;  };
+
+layout(location = 0) out f32vec2 out_uv;
+layout(location = 1) out flat u32 albedo_index;
+
+mat4 mat_4x3_to_4x4(mat4x3 in_mat)
+{
+    return mat4(
+        vec4(in_mat[0], 0.0),
+        vec4(in_mat[1], 0.0),
+        vec4(in_mat[2], 0.0),
+        vec4(in_mat[3], 1.0)
+    );
+}
+
+void main()
+{
+    const u32 vert_index = gl_VertexIndex;
+    // Instances of indirect draws index into the visible instances written by the culling pass
+    const VisibleInstance visible_instance = VisibleInstance(pc.visible_instances)[gl_InstanceIndex];
+    const u32 mesh_index = visible_instance.mesh_index;
+
+    SceneDescriptor scene_descriptor = SceneDescriptor(pc.scene_descriptor);
+    MeshDescriptor mesh_descriptor = MeshDescriptor(scene_descriptor.mesh_descriptors_start)[mesh_index];
+    MaterialDescriptor material_descriptor = MaterialDescriptor(scene_descriptor.material_descriptors_start)[mesh_descriptor.material_index];
+
+    const f32mat4x3 transform = (Transform(scene_descriptor.transforms_start)[visible_instance.transform_index]).trans;
+
+    const f32vec3 position = fetch_position(scene_descriptor, mesh_descriptor, vert_index);
+    const f32vec2 uv = fetch_uv(scene_descriptor, mesh_descriptor, vert_index);
+
+    albedo_index = material_descriptor.albedo_index;
+    out_uv = uv;
+
+    VsmClipLevel clip_level = VsmClipLevel(pc.clip_levels)[pc.clip_level];
+    const f32mat4x4 model = mat_4x3_to_4x4(transform);
+    gl_Position = clip_level.projection * clip_level.view * model * f32vec4(position, 1.0);
+}
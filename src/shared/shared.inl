@@ -6,6 +6,14 @@
 #define SKY_COLOR f32vec3(0.0015 * 0.1, 0.0015 * 0.1, 0.0075 * 0.1)
 #define SUN_COLOR f32vec3(0.82, 0.910, 0.976)
 
+// Vertex streams hold f32vec3 positions, f32vec2 uvs, f32vec4 tangents and f32vec3 normals
+#define VERTEX_FORMAT_FULL 0
+/// NOTE: Vertex streams hold u32vec2 positions, u32 uvs, u32 tangents and u32 normals. Positions are three 16 bit
+//        unorms relative to the position_min and position_extent of their mesh, uvs are two halfs. Normals and
+//        tangents are octahedral encoded into two 16 bit snorms, the lowest bit of the tangent holds the sign of
+//        the bitangent (set means negative). See src/shaders/util/vertex_fetch.glsl.
+#define VERTEX_FORMAT_COMPRESSED 1
+
 BUFFER_REF(4)
 SceneDescriptor
 {
@@ -17,6 +25,9 @@ SceneDescriptor
     VkDeviceAddress normals_start;
     VkDeviceAddress tangents_start;
     VkDeviceAddress indices_start;
+    VkDeviceAddress indices_16_start;
+    VkDeviceAddress meshlets_start;
+    u32 vertex_format;
 };
 
 BUFFER_REF(4)
@@ -37,6 +48,9 @@ MeshDescriptor
     u32 normals_offset;
     u32 indices_offset;
     u32 material_index;
+    // Dequantization of VERTEX_FORMAT_COMPRESSED positions
+    f32vec3 position_min;
+    f32vec3 position_extent;
 };
 
 BUFFER_REF(4)
@@ -67,17 +81,257 @@ ShadowmapCascadeData
     f32 far_plane;
 };
 
+// Level of detail
+#define MAX_MESH_LODS 4
+// A coarser lod is selected once its simplification error projects to less than this many pixels
+#define LOD_ERROR_THRESHOLD_PIXELS 1.0
+struct MeshLod
+{
+    u32 index_count;
+    u32 first_index;
+    // Object space distance between the lod and the original mesh surface
+    f32 error;
+    // The indices of the lod are ordered by meshlet, the meshlets cover the full index range
+    u32 first_meshlet;
+    u32 meshlet_count;
+};
+
+// Meshlets
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+/// NOTE: Cluster of up to MESHLET_MAX_TRIANGLES triangles referencing at most MESHLET_MAX_VERTICES vertices. The
+//        triangles of all meshlets of a mesh are covered by its bounding sphere, all of their normals lie inside of
+//        the cone around cone_axis. A cone_cutoff of 1.0 means the cone is degenerate and never culls.
+BUFFER_REF(4)
+Meshlet
+{
+    f32vec3 center;
+    f32 radius;
+    f32vec3 cone_axis;
+    f32 cone_cutoff;
+    u32 first_index;
+    u32 triangle_count;
+};
+
+// Index pools
+/// NOTE: Meshes with at most MESH_INDEX_16_MAX_VERTEX_COUNT vertices keep their indices in the 16 bit pool, all
+//        others in the 32 bit pool. The first indices of the lods and meshlets of a mesh count indices of its pool.
+#define MESH_INDEX_FORMAT_U32 0
+#define MESH_INDEX_FORMAT_U16 1
+#define MESH_INDEX_FORMAT_COUNT 2
+#define MESH_INDEX_16_MAX_VERTEX_COUNT (1u << 16)
+
+// GPU driven drawing
+#define GENERATE_DRAWS_WORKGROUP_SIZE 64
+#define DRAW_LIST_OPAQUE 0
+#define DRAW_LIST_ALPHA_DISCARD 1
+#define DRAW_LIST_COUNT 2
+// Commands drawn from the scene index pools are split by list and index format, slot = format * DRAW_LIST_COUNT + list
+#define DRAW_LIST_SLOT_COUNT (DRAW_LIST_COUNT * MESH_INDEX_FORMAT_COUNT)
+/// NOTE: The draw list buffer starts with the DrawListHeader, padded to DRAW_LIST_COMMANDS_OFFSET bytes. After that
+//        the commands drawn from the scene index pools follow, split into DRAW_LIST_SLOT_COUNT slots, slot i starts
+//        at command index i * command_capacity. Every mesh can emit one command per lod and every cluster culling
+//        work item one fallback command. The cluster culled commands follow, they always use 32 bit indices and
+//        list i starts at i * cluster_work_capacity. The commands are followed by the visible instances, a draw
+//        reads its instances starting at its first_instance. The next section holds the number of occlusion culled
+//        instances of each mesh, see GENERATE_DRAWS_OCCLUSION_FIRST_PHASE. Draw lists with cluster culling end with
+//        cluster_work_capacity ClusterCullWork items followed by culled_index_capacity indices of the clusters
+//        which passed culling.
+#define DRAW_LIST_COMMANDS_OFFSET 64
+/// NOTE: Upper bound of the culled indices of a draw list, the renderer sizes them by the indices of the most
+//        detailed lod of every instance. Batches which do not fit into the culled indices anymore are drawn with
+//        all of their clusters from the scene index buffer.
+#define CLUSTER_CULLED_INDEX_CAPACITY (1u << 24)
+// Meshlets of a lod are culled in batches, each workgroup of the cluster pass culls one batch of one instance
+#define CLUSTER_CULL_BATCH_SIZE GENERATE_DRAWS_WORKGROUP_SIZE
+// Smallest maxComputeWorkGroupCount[0] guaranteed by Vulkan, the cluster pass loops over the remaining work items
+#define CLUSTER_CULL_MAX_WORKGROUPS 65535
+
+// Draw list without cluster culling
+#define GENERATE_DRAWS_NO_CLUSTER_CULLING 0
+/// NOTE: Instances entirely inside of the frustum are still drawn instanced, one command per lod. Instances crossing
+//        a frustum plane, and in the second occlusion phase all instances, are split into one ClusterCullWork item
+//        per batch of meshlets instead.
+#define GENERATE_DRAWS_CLUSTER_CULLING_INSTANCES 1
+// Dispatched indirectly by the instance pass, one workgroup per work item culls its clusters and emits a command
+#define GENERATE_DRAWS_CLUSTER_CULLING_CLUSTERS 2
+
+// Instances are tested against the side planes of the camera frustum
+#define GENERATE_DRAWS_FRUSTUM_CAMERA 0
+/// NOTE: Instances are tested against the side and far planes of the shadow cascade, the near plane is skipped as
+//        the shadow pass clamps depth. Only instances touching the dirty rects of the cached cascade are kept.
+#define GENERATE_DRAWS_FRUSTUM_SHADOW_CASCADE 1
+// Instances are tested against the side and far planes of the virtual shadow map clip level and are only kept when
+// they touch the pages allocated this frame
+#define GENERATE_DRAWS_FRUSTUM_VIRTUAL_SHADOW 2
+
+// Only the frustum is tested
+#define GENERATE_DRAWS_NO_OCCLUSION 0
+/// NOTE: Instances are also tested against the Hi-Z pyramid of the previous frame. Occluded instances are written
+//        from the end of the instance range of their mesh towards its start and counted in the occluded counts.
+#define GENERATE_DRAWS_OCCLUSION_FIRST_PHASE 1
+// Instances occluded in the first phase are tested against the Hi-Z pyramid built from the first phase depth
+#define GENERATE_DRAWS_OCCLUSION_SECOND_PHASE 2
+
+BUFFER_REF(4)
+MeshDrawInfo
+{
+    f32vec3 aabb_min;
+    f32vec3 aabb_max;
+    u32 lod_count;
+    MeshLod lods[MAX_MESH_LODS];
+    u32 instance_count;
+    u32 instance_offset;
+    u32 transforms_offset;
+    u32 mesh_index;
+    u32 draw_list_index;
+    u32 index_format;
+};
+
+BUFFER_REF(4)
+VisibleInstance
+{
+    u32 mesh_index;
+    u32 transform_index;
+};
+
+// Matches VkDrawIndexedIndirectCommand
+BUFFER_REF(4)
+DrawIndexedIndirectCommand
+{
+    u32 index_count;
+    u32 instance_count;
+    u32 first_index;
+    i32 vertex_offset;
+    u32 first_instance;
+};
+
+BUFFER_REF(4)
+DrawListHeader
+{
+    // Commands drawn from the scene index pools, one count per slot
+    u32 draw_counts[DRAW_LIST_SLOT_COUNT];
+    // Commands drawn from the culled indices
+    u32 cluster_draw_counts[DRAW_LIST_COUNT];
+    u32 culled_index_count;
+    u32 cluster_work_count;
+    // Matches VkDispatchIndirectCommand, workgroups of the cluster pass
+    u32 cluster_cull_dispatch[3];
+};
+
+// Batch of CLUSTER_CULL_BATCH_SIZE meshlets of the lod of a visible instance
+BUFFER_REF(4)
+ClusterCullWork
+{
+    u32 mesh_draw_index;
+    // Index into the visible instances of the draw list
+    u32 visible_slot;
+    u32 lod;
+    // Relative to the first meshlet of the lod
+    u32 first_meshlet;
+};
+
+BUFFER_REF(4)
+OccludedInstanceCount
+{
+    u32 count;
+};
+
+struct GenerateDrawsPC
+{
+    VkDeviceAddress scene_descriptor;
+    VkDeviceAddress mesh_draw_infos;
+    VkDeviceAddress draw_list;
+    VkDeviceAddress visible_instances;
+    VkDeviceAddress camera_info;
+    // Cascade data and cache of the shadow cascades or clip levels and state of the virtual shadow map
+    VkDeviceAddress shadow_data;
+    VkDeviceAddress shadow_state;
+    VkDeviceAddress hiz;
+    // Visible instances and occluded counts of the first phase draw list
+    VkDeviceAddress occluded_instances;
+    VkDeviceAddress occluded_counts;
+    u32vec2 depth_dimensions;
+    u32 fif_index;
+    u32 command_capacity;
+    // Offsets of the work items and culled indices in the draw list, see DRAW_LIST_COMMANDS_OFFSET
+    u32 cluster_work_offset;
+    u32 cluster_work_capacity;
+    u32 culled_indices_offset;
+    u32 culled_index_capacity;
+    u32 frustum;
+    // Shadow cascade or virtual shadow map clip level
+    u32 cascade_index;
+    u32 occlusion_phase;
+    u32 cluster_culling;
+};
+
+// Single pass downsampling, see src/shaders/util/spd.glsl
+#define SPD_WORKGROUP_SIZE 256
+/// NOTE: Every workgroup reduces a SPD_TILE_SIZE x SPD_TILE_SIZE tile of the base level by SPD_TILE_LEVEL_COUNT
+//        levels. When the base level fits into SPD_TILE_SIZE tiles along both axes the last workgroup to finish
+//        continues with the next SPD_TILE_LEVEL_COUNT levels, so a single dispatch produces up to twice as many.
+#define SPD_TILE_SIZE 64
+#define SPD_TILE_LEVEL_COUNT 6
+BUFFER_REF(4)
+SpdCounter
+{
+    // Workgroups that finished their tile, reset to zero by the last one
+    u32 finished_workgroups;
+};
+
+// Hi-Z
+/// NOTE: Level 0 of the Hi-Z pyramid has half the depth resolution, every following level halves the previous one
+//        down to 1x1. Each texel stores the farthest (smallest, as depth is reversed) depth of the texels it covers.
+//        All levels are tightly packed one after another in a single buffer.
+BUFFER_REF(4)
+HizTexel
+{
+    f32 depth;
+};
+
+struct HizGeneratePC
+{
+    VkDeviceAddress hiz;
+    VkDeviceAddress counter;
+    u32vec2 depth_dimensions;
+    u32 depth_index;
+    u32 sampler_id;
+    // Downsampling levels, the depth is level 0 and Hi-Z level N is level N + 1
+    u32 base_level;
+    u32 level_count;
+};
+
+// Texture streaming
+/// NOTE: The prepass writes the highest density every material was sampled with into the texture feedback, one
+//        TextureFeedback per material. The density is in pixels per uv unit along the axis the sampler selects the
+//        mip from, a texture with extent E then needs mip log2(E / density). Zero means the material was not sampled.
+//        Only one pixel in every TEXTURE_FEEDBACK_PIXEL_STRIDE x TEXTURE_FEEDBACK_PIXEL_STRIDE block writes feedback.
+#define TEXTURE_FEEDBACK_PIXEL_STRIDE 4
+// Matches the max anisotropy of the sampler the materials are sampled with
+#define TEXTURE_FEEDBACK_MAX_ANISOTROPY 16.0
+#define TEXTURE_FEEDBACK_MAX_DENSITY (1u << 24)
+BUFFER_REF(4)
+TextureFeedback
+{
+    u32 max_density;
+};
+
 struct DrawPc
 {
     VkDeviceAddress scene_descriptor;
     VkDeviceAddress camera_info;
     VkDeviceAddress cascade_data;
     VkDeviceAddress lights_info;
+    VkDeviceAddress visible_instances;
+    VkDeviceAddress texture_feedback;
+    VkDeviceAddress vsm_clip_levels;
+    VkDeviceAddress vsm_page_table;
+    VkDeviceAddress vsm_physical_texels;
     u32 ss_normals_index;
     u32 ssao_index;
     u32 esm_shadowmap_index;
     u32 fif_index;
-    u32 mesh_index;
     u32 sampler_id;
     u32 shadow_sampler_id;
     f32vec3 sun_direction;
@@ -87,6 +341,7 @@ struct DrawPc
     u32 no_shadows;
     u32 no_normal_maps;
     u32 curr_num_lights;
+    u32 virtual_shadows;
 };
 
 // SSAO 
@@ -124,8 +379,33 @@ struct SSAOPC
 #define DEPTH_PASS_WG_READS_PER_AXIS (DEPTH_PASS_WG_SIZE * DEPTH_PASS_THREAD_READ_COUNT)
 
 #define ESM_BLUR_WORKGROUP_SIZE 64
+// Texels the 5 wide blur of the esm passes reads on either side of the filtered texel
+#define ESM_BLUR_RADIUS 2
+#define ESM_SCROLL_WORKGROUP_SIZE 16
 #define ESM_FACTOR 100.0
 
+/// NOTE: Cascades are fitted to a texel grid fixed in light space, with their extent quantized to steps of
+//        2^(1 / SHADOW_CACHE_EXTENT_STEPS) and their depth range padded by SHADOW_CACHE_DEPTH_PADDING of the
+//        fitted depth on both sides. Both only change once the frustum slice no longer fits into them or shrinks
+//        to a fraction of them, until then the cached cascade stays valid and only scrolls with the camera.
+#define SHADOW_CACHE_EXTENT_STEPS 4
+#define SHADOW_CACHE_DEPTH_PADDING 0.25
+#define SHADOW_CACHE_DIRTY_RECT_COUNT 2
+BUFFER_REF(4)
+ShadowCascadeCache
+{
+    // Light space texel grid the cached cascade was rendered with
+    i32vec2 origin_texel;
+    f32 texel_size;
+    f32vec2 depth_range;
+    f32vec3 sun_direction;
+    // Texels the cached cascade moved by this frame, the texel x of the last frame is the texel x - scroll now
+    i32vec2 scroll;
+    // [xy, zw) texel rects re-filtered this frame, the newly exposed strips grown by ESM_BLUR_RADIUS
+    i32vec4 dirty_rects[SHADOW_CACHE_DIRTY_RECT_COUNT];
+    u32 valid;
+};
+
 #define LAMBDA 0.70
 BUFFER_REF(4)
 DepthLimits
@@ -148,20 +428,24 @@ struct WriteShadowMatricesPC
     u32 fif_index;
     VkDeviceAddress depth_limits;
     VkDeviceAddress cascade_data;
+    VkDeviceAddress cascade_cache;
     f32vec3 sun_direction;
+    // Shadow casters moved, every cascade is rendered again
+    u32 invalidate_cache;
 };
 
 struct ShadowPC
 {
     VkDeviceAddress scene_descriptor;
     VkDeviceAddress cascade_data;
-    u32 mesh_index;
+    VkDeviceAddress visible_instances;
     u32 sampler_id;
     u32 cascade_index;
 };
 
 struct ESMShadowPC
 {
+    VkDeviceAddress cascade_cache;
     u32 tmp_esm_index;
     u32 esm_index;
     u32 shadowmap_index;
@@ -169,6 +453,113 @@ struct ESMShadowPC
     u32vec2 offset;
 };
 
+struct ESMScrollPC
+{
+    VkDeviceAddress cascade_cache;
+    u32 src_index;
+    u32 dst_index;
+    u32 cascade_index;
+    // Reads the source at the texel of the last frame, the texels stay in place otherwise
+    u32 apply_scroll;
+};
+
+// Virtual shadow maps
+/// NOTE: The sun is covered by VSM_CLIP_LEVEL_COUNT clip levels centered on the camera, each one twice the extent of
+//        the previous one. Every level has VSM_VIRTUAL_RESOLUTION^2 virtual texels split into pages of
+//        VSM_PAGE_SIZE^2 texels, only the pages the receivers visible in the depth buffer fall into are backed by
+//        one of the VSM_PHYSICAL_PAGE_COUNT physical pages. Levels scroll with the camera in whole pages, a page
+//        keeps its entry of the page table by addressing the table with page coordinates wrapped around the level.
+//        Allocated pages stay cached until they leave their level or were not requested for VSM_PAGE_MAX_AGE
+//        frames, only newly allocated pages are rendered.
+#define VSM_CLIP_LEVEL_COUNT 7
+#define VSM_VIRTUAL_RESOLUTION 4096
+#define VSM_PAGE_SIZE 64
+#define VSM_PAGE_TABLE_RESOLUTION (VSM_VIRTUAL_RESOLUTION / VSM_PAGE_SIZE)
+#define VSM_PHYSICAL_PAGE_COUNT 4096
+#define VSM_PAGE_MAX_AGE 60
+// World extent of the first clip level, receivers closer to the camera than VSM_FIRST_LEVEL_RADIUS use it
+#define VSM_FIRST_LEVEL_EXTENT 32.0
+#define VSM_FIRST_LEVEL_RADIUS 15.0
+// Light space depth the levels cover in front of and behind their center. The center follows the camera in steps of
+// half of it and discards all cached pages whenever it moves.
+#define VSM_DEPTH_EXTENT 512.0
+#define VSM_DEPTH_BIAS_TEXELS 2.0
+#define VSM_WORKGROUP_SIZE 16
+#define VSM_CLEAR_WORKGROUP_SIZE 256
+
+#define VSM_PAGE_ALLOCATED 0x80000000u
+#define VSM_PAGE_REQUESTED 0x40000000u
+// Allocated this frame, the page is cleared and rendered
+#define VSM_PAGE_DIRTY 0x20000000u
+// Frames since the page was last requested
+#define VSM_PAGE_AGE_MASK 0x00ff0000u
+#define VSM_PAGE_AGE_SHIFT 16
+#define VSM_PAGE_PHYSICAL_MASK 0x0000ffffu
+BUFFER_REF(4)
+VsmPageTableEntry
+{
+    u32 entry;
+};
+
+BUFFER_REF(4)
+VsmPhysicalPage
+{
+    u32 dirty;
+};
+
+// Depth as the bits of a positive float, which order the same as the floats themselves
+BUFFER_REF(4)
+VsmPhysicalTexel
+{
+    u32 depth;
+};
+
+BUFFER_REF(4)
+VsmClipLevel
+{
+    f32mat4x4 view;
+    f32mat4x4 projection;
+    // First page of the level in the light space page grid, this frame and the last one
+    i32vec2 origin_page;
+    i32vec2 prev_origin_page;
+    // The depth range moved, every page of the level is discarded
+    u32 invalidate;
+};
+
+BUFFER_REF(4)
+VsmState
+{
+    // Free physical pages are a stack
+    i32 free_page_count;
+    // [xy, zw] pages of each clip level allocated this frame relative to its origin page
+    i32vec4 dirty_page_rects[VSM_CLIP_LEVEL_COUNT];
+    u32 free_pages[VSM_PHYSICAL_PAGE_COUNT];
+};
+
+struct VsmPagesPC
+{
+    VkDeviceAddress camera_info;
+    VkDeviceAddress clip_levels;
+    VkDeviceAddress page_table;
+    VkDeviceAddress physical_pages;
+    VkDeviceAddress physical_texels;
+    VkDeviceAddress state;
+    u32vec2 depth_dimensions;
+    u32 depth_index;
+    u32 fif_index;
+};
+
+struct VsmPassPC
+{
+    VkDeviceAddress scene_descriptor;
+    VkDeviceAddress clip_levels;
+    VkDeviceAddress page_table;
+    VkDeviceAddress physical_texels;
+    VkDeviceAddress visible_instances;
+    u32 sampler_id;
+    u32 clip_level;
+};
+
 // Fog
 #define FOG_PASS_X_TILE_SIZE 16
 #define FOG_PASS_Y_TILE_SIZE 16
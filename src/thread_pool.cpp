@@ -0,0 +1,126 @@
+#include "thread_pool.hpp"
+
+namespace ff
+{
+    ThreadPool::ThreadPool(u32 thread_count)
+    {
+        if (thread_count == 0)
+        {
+            thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        // The calling thread is counted as one of the threads
+        workers.reserve(thread_count - 1);
+        for (u32 worker_index = 1; worker_index < thread_count; worker_index++)
+        {
+            workers.emplace_back([this, worker_index]()
+                                 { worker_main(worker_index); });
+        }
+    }
+
+    auto ThreadPool::get_thread_count() const -> u32
+    {
+        return static_cast<u32>(workers.size()) + 1;
+    }
+
+    void ThreadPool::run_tasks(u32 thread_index)
+    {
+        while (true)
+        {
+            u32 const task_index = next_task_index.fetch_add(1, std::memory_order_relaxed);
+            if (task_index >= current_task_count)
+            {
+                break;
+            }
+            try
+            {
+                (*current_task)(task_index, thread_index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (!first_exception)
+                {
+                    first_exception = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void ThreadPool::worker_main(u32 thread_index)
+    {
+        u64 seen_generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                work_available.wait(lock, [&]
+                                    { return should_exit || job_generation != seen_generation; });
+                if (should_exit)
+                {
+                    return;
+                }
+                seen_generation = job_generation;
+            }
+            run_tasks(thread_index);
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                active_worker_count -= 1;
+            }
+            work_done.notify_one();
+        }
+    }
+
+    void ThreadPool::parallel_for(u32 task_count, TaskFunction const & task)
+    {
+        if (task_count == 0)
+        {
+            return;
+        }
+        if (workers.empty())
+        {
+            for (u32 task_index = 0; task_index < task_count; task_index++)
+            {
+                task(task_index, 0);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            current_task = &task;
+            current_task_count = task_count;
+            next_task_index.store(0, std::memory_order_relaxed);
+            active_worker_count = static_cast<u32>(workers.size());
+            first_exception = nullptr;
+            job_generation += 1;
+        }
+        work_available.notify_all();
+        run_tasks(0);
+        std::exception_ptr exception = {};
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            work_done.wait(lock, [&]
+                           { return active_worker_count == 0; });
+            current_task = nullptr;
+            current_task_count = 0;
+            exception = first_exception;
+            first_exception = nullptr;
+        }
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            should_exit = true;
+        }
+        work_available.notify_all();
+        for (auto & worker : workers)
+        {
+            worker.join();
+        }
+    }
+} // namespace ff
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+#include "fairy_forest.hpp"
+
+namespace ff
+{
+    /// NOTE: Minimal fork-join worker pool. The calling thread takes part in executing the tasks, so a pool
+    //        created with thread count 1 spawns no workers and runs everything serially on the caller.
+    struct ThreadPool
+    {
+      public:
+        using TaskFunction = std::function<void(u32 task_index, u32 thread_index)>;
+
+        // thread_count == 0 means use std::thread::hardware_concurrency()
+        ThreadPool(u32 thread_count = 0);
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool & operator=(ThreadPool const &) = delete;
+        ~ThreadPool();
+
+        auto get_thread_count() const -> u32;
+        /// NOTE: Blocks until every task in [0, task_count) has finished. Tasks are picked up in increasing index order,
+        //        thread_index is in [0, get_thread_count()) and can be used to index per thread scratch data.
+        //        If any task throws, the first exception is rethrown on the calling thread after all workers are done.
+        void parallel_for(u32 task_count, TaskFunction const & task);
+
+      private:
+        std::vector<std::thread> workers = {};
+        std::mutex mutex = {};
+        std::condition_variable work_available = {};
+        std::condition_variable work_done = {};
+
+        TaskFunction const * current_task = {};
+        u32 current_task_count = {};
+        std::atomic<u32> next_task_index = {};
+        u32 active_worker_count = {};
+        u64 job_generation = {};
+        bool should_exit = {};
+        std::exception_ptr first_exception = {};
+
+        void run_tasks(u32 thread_index);
+        void worker_main(u32 thread_index);
+    };
+} // namespace ff